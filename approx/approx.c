@@ -0,0 +1,123 @@
+//  approx.c : partie implantation d'un module de recherche approchée, dans un
+//    résumé de taille fixe, des lignes les plus fréquentes des fichiers d'une
+//    session du module lnid.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "approx.h"
+#include "spacesaving.h"
+
+//  Les étiquettes du résumé codent la position d'un fichier dans l'ordre de
+//    traitement sur les APPROX__FILE_BITS bits de poids fort et la position
+//    d'une ligne dans son fichier sur les autres.
+#define APPROX__FILE_BITS 16
+#define APPROX__OFF_BITS (64 - APPROX__FILE_BITS)
+#define APPROX__OFF_MASK (((uint64_t) 1 << APPROX__OFF_BITS) - 1)
+
+//  Le champ ss est le résumé.
+struct approx {
+  spacesaving *ss;
+};
+
+size_t approx_counters(size_t mb) {
+  return mb > SIZE_MAX >> 20 ? 0 : spacesaving_counters(mb << 20);
+}
+
+approx *approx_empty(size_t m) {
+  approx *a = malloc(sizeof *a);
+  if (a == NULL) {
+    return NULL;
+  }
+  a->ss = spacesaving_empty(m);
+  if (a->ss == NULL) {
+    free(a);
+    return NULL;
+  }
+  return a;
+}
+
+void approx_dispose(approx **aptr) {
+  if (*aptr == NULL) {
+    return;
+  }
+  spacesaving_dispose(&(*aptr)->ss);
+  free(*aptr);
+  *aptr = NULL;
+}
+
+int approx_line(approx *a, size_t p, const char *t, size_t len,
+    int nbline, off_t off) {
+  (void) nbline;
+  uint64_t fp[2] = {
+    lnid_hash64(t, len, 0), lnid_hash64(t, len, LNID_SEED)
+  };
+  spacesaving_add(a->ss, fp, ((uint64_t) p << APPROX__OFF_BITS)
+      | ((uint64_t) off & APPROX__OFF_MASK));
+  return 0;
+}
+
+lnidret approx_report(approx *a, lnid *s, const char * const *names,
+    size_t top, size_t mincount, FILE *stream, size_t *p) {
+  spacesaving *ss = a->ss;
+  spacesaving_sort(ss);
+  size_t n = spacesaving_length(ss);
+  size_t shown = 0;
+  size_t q = SIZE_MAX;
+  int fd = -1;
+  lnidret e = LNID_OK;
+  for (size_t i = 0; i < n && (top == 0 || shown < top); ++i) {
+    uint64_t count;
+    uint64_t error;
+    uint64_t tag = spacesaving_get(ss, i, &count, &error);
+    if (count < mincount) {
+      break;
+    }
+    //  Les lignes sont relues dans leur fichier, qui n'est rouvert que s'il
+    //    diffère de celui de la ligne précédente.
+    if ((size_t) (tag >> APPROX__OFF_BITS) != q) {
+      if (fd >= 0) {
+        close(fd);
+      }
+      q = (size_t) (tag >> APPROX__OFF_BITS);
+      if ((fd = open(names[q], O_RDONLY)) < 0) {
+        *p = q;
+        return LNID_EFILE;
+      }
+    }
+    const char *t;
+    size_t len;
+    if ((e = lnid_reread(s, fd, (off_t) (tag & APPROX__OFF_MASK), &t, &len))
+        != LNID_OK) {
+      break;
+    }
+    if (fprintf(stream, "%" PRIu64 "\t%" PRIu64 "\t%s\n", count,
+        count - error, t) < 0) {
+      e = LNID_EWRITE;
+      break;
+    }
+    ++shown;
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+  return e;
+}
+
+int approx_fprint_error(approx *a, FILE *stream) {
+  //  Tant que le résumé n'est pas plein, les compteurs sont exacts. Ensuite,
+  //    l'erreur d'un compteur ne dépasse pas le plus petit des compteurs.
+  spacesaving *ss = a->ss;
+  size_t n = spacesaving_length(ss);
+  uint64_t bound = 0;
+  if (n == spacesaving_capacity(ss)) {
+    uint64_t error;
+    spacesaving_get(ss, n - 1, &bound, &error);
+  }
+  return fprintf(stream, "Approximation: %" PRIu64 " lines, %zu counters, "
+      "counts overestimated by at most %" PRIu64 "\n", spacesaving_total(ss),
+      spacesaving_capacity(ss), bound) < 0;
+}
@@ -0,0 +1,78 @@
+//  approx.h : partie interface d'un module de recherche approchée, dans un
+//    résumé de taille fixe, des lignes les plus fréquentes des fichiers d'une
+//    session du module lnid.
+
+#ifndef APPROX__H
+#define APPROX__H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include "lnid.h"
+
+//  Fonctionnement général :
+//  - le résumé, du module spacesaving, remplace la table de la session : les
+//      lignes lui sont passées par approx_line, confiée à la session à l'aide
+//      de lnid_lines. Il ne mémorise pour chaque ligne surveillée que son
+//      empreinte, ses compteurs et la position de son fichier dans l'ordre de
+//      traitement et de la ligne dans ce fichier, au plus APPROX_FILES_MAX
+//      fichiers ;
+//  - les lignes retenues sont relues dans leur fichier lors de l'écriture du
+//      résultat par approx_report ;
+//  - les fonctions qui possèdent un paramètre de type « approx * » ont un
+//      comportement indéterminé lorsque ce paramètre n'est pas l'adresse d'un
+//      contrôleur préalablement renvoyé par approx_empty et non encore libéré.
+
+//  APPROX_DEFAULT_MB : taille par défaut, en Mio, d'un résumé.
+#define APPROX_DEFAULT_MB 64
+
+//  APPROX_FILES_MAX : nombre maximal de fichiers d'une session dont les lignes
+//    sont passées à un résumé.
+#define APPROX_FILES_MAX ((size_t) 1 << 16)
+
+//  struct approx, approx : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer un résumé.
+typedef struct approx approx;
+
+//  approx_counters : renvoie le nombre de lignes surveillées par un résumé de
+//    mb Mio, zéro si cette taille ne permet d'en surveiller aucune.
+extern size_t approx_counters(size_t mb);
+
+//  approx_empty : tente d'allouer les ressources nécessaires pour gérer un
+//    nouveau résumé, vide, qui surveille au plus m lignes, m valant au plus
+//    approx_counters(mb) pour une taille mb. Renvoie NULL en cas de
+//    dépassement de capacité. Renvoie sinon un pointeur vers le contrôleur
+//    associé au résumé.
+extern approx *approx_empty(size_t m);
+
+//  approx_dispose : sans effet si *aptr vaut NULL. Libère sinon les ressources
+//    allouées à la gestion du résumé associé à *aptr puis affecte NULL à
+//    *aptr.
+extern void approx_dispose(approx **aptr);
+
+//  approx_line : ajoute au résumé associé à a la ligne t de longueur len, de
+//    position off dans le fichier de position p dans l'ordre de traitement.
+//    Fonction à passer à lnid_lines. Renvoie zéro.
+extern int approx_line(approx *a, size_t p, const char *t, size_t len,
+    int nbline, off_t off);
+
+//  approx_report : écrit sur le flot stream, par majorations décroissantes, les
+//    lignes surveillées par le résumé associé à a, ou celles retenues par top
+//    et mincount comme par lnid_results, appliqués aux majorations : pour
+//    chacune, sa majoration, sa minoration et son contenu, séparés par une
+//    tabulation. Les lignes sont relues à l'aide de lnid_reread de la session
+//    associée à s dans les fichiers de noms ceux de names, dans l'ordre de
+//    traitement. Renvoie LNID_OK en cas de succès, LNID_ECAP en cas de
+//    dépassement de capacité, LNID_EFILE si un fichier ne peut être rouvert,
+//    sa position étant alors affectée à *p, LNID_EREAD en cas d'erreur de
+//    lecture et LNID_EWRITE en cas d'erreur d'écriture.
+extern lnidret approx_report(approx *a, lnid *s, const char * const *names,
+    size_t top, size_t mincount, FILE *stream, size_t *p);
+
+//  approx_fprint_error : écrit sur le flot stream, après approx_report, le
+//    nombre de lignes passées au résumé associé à a, le nombre de lignes qu'il
+//    surveille et l'erreur maximale de ses majorations. Renvoie zéro en cas de
+//    succès, une valeur non nulle en cas d'erreur d'écriture.
+extern int approx_fprint_error(approx *a, FILE *stream);
+
+#endif
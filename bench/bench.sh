@@ -0,0 +1,101 @@
+#!/bin/sh
+#  bench.sh : campagne de mesures de bout en bout de lnid.
+#
+#  Pour chaque type de corpus (KINDS), taille totale (SIZES) et nombre de
+#    fichiers (FILES), génère le corpus s'il n'existe pas déjà dans DATA puis
+#    mesure lnid et, comme point de référence, un traitement par sort de même
+#    résultat : « sort | uniq -d » pour un seul fichier et, pour plusieurs,
+#    « sort -u » de chaque fichier puis le décompte par « uniq -c » des lignes
+#    présentes dans tous. Chaque mesure ajoute une ligne à RESULTS (valeurs
+#    séparées par des tabulations) :
+#
+#      case  tool  bytes  seconds  mbps  maxrss_kb  allocs  status
+#
+#  Si le fichier BASELINE existe, chaque mesure de lnid y est comparée à la
+#    mesure de même cas et un ratio de débit et de mémoire est affiché. Une
+#    perte de débit de plus de 10 % est signalée par REGRESSION.
+#
+#  Si COLD vaut 1, les fichiers du corpus sont retirés du cache de pages avant
+#    chaque mesure, de façon à reproduire la lecture de fichiers froids, par
+#    exemple situés sur un stockage réseau.
+
+set -u
+
+LNID=${LNID:-../nbline/lnid}
+SIZES=${SIZES:-10M}
+FILES=${FILES:-1 2 10 100}
+KINDS=${KINDS:-zipf long unique}
+DATA=${DATA:-data}
+RESULTS=${RESULTS:-results.tsv}
+BASELINE=${BASELINE:-baseline.tsv}
+COLD=${COLD:-0}
+
+here=$(cd "$(dirname "$0")" && pwd)
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+mkdir -p "$DATA"
+printf 'case\ttool\tbytes\tseconds\tmbps\tmaxrss_kb\tallocs\tstatus\n' \
+  > "$RESULTS"
+
+#  measure cas outil octets commande... : exécute la commande sous rusage et
+#    mallocount puis ajoute la mesure à RESULTS. mallocount n'est préchargée
+#    que dans la commande, par env, et non dans rusage.
+measure() {
+  case=$1 tool=$2 bytes=$3
+  shift 3
+  rm -f "$tmp/allocs"
+  "$here/rusage" -o "$tmp/rusage" env MALLOCOUNT_OUT="$tmp/allocs" \
+    LD_PRELOAD="$here/mallocount.so" "$@" > /dev/null
+  allocs=$(awk '{ s += $1 } END { print s + 0 }' "$tmp/allocs" 2> /dev/null)
+  awk -v c="$case" -v t="$tool" -v b="$bytes" -v a="${allocs:-0}" '
+    { printf "%s\t%s\t%d\t%s\t%.2f\t%s\t%s\t%s\n",
+        c, t, b, $1, ($1 > 0 ? b / 1048576 / $1 : 0), $2, a, $3 }
+  ' "$tmp/rusage" | tee -a "$RESULTS"
+}
+
+#  evict fichiers... : si COLD vaut 1, retire les fichiers du cache de pages.
+evict() {
+  if [ "$COLD" = 1 ]; then
+    for f in "$@"; do
+      dd if="$f" iflag=nocache count=0 status=none
+    done
+  fi
+}
+
+for kind in $KINDS; do
+  for size in $SIZES; do
+    for n in $FILES; do
+      case="$kind-$size-$n"
+      prefix="$DATA/$case"
+      if [ ! -f "$prefix-001.txt" ]; then
+        "$here/gen" -t "$kind" -s "$size" -n "$n" "$prefix" || exit 1
+      fi
+      files=$(ls "$prefix"-*.txt)
+      bytes=$(cat $files | wc -c)
+      evict $files
+      measure "$case" lnid "$bytes" "$LNID" $files
+      evict $files
+      if [ "$n" = 1 ]; then
+        measure "$case" sort-uniq "$bytes" sh -c \
+          "LC_ALL=C sort $(echo $files) | uniq -d"
+      else
+        measure "$case" sort-uniq "$bytes" sh -c \
+          "for f in $(echo $files); do LC_ALL=C sort -u \"\$f\"; done \
+            | LC_ALL=C sort | uniq -c | awk '\$1 == $n'"
+      fi
+    done
+  done
+done
+
+if [ -f "$BASELINE" ]; then
+  echo "--- Comparison with $BASELINE (lnid)"
+  awk -F '\t' '
+    NR == FNR { if ($2 == "lnid") { mbps[$1] = $5; rss[$1] = $6 }; next }
+    $2 == "lnid" && ($1 in mbps) && mbps[$1] > 0 && rss[$1] > 0 {
+      r = $5 / mbps[$1]
+      printf "%-24s throughput x%.2f  maxrss x%.2f%s\n", $1, r, $6 / rss[$1],
+        (r < 0.9 ? "  REGRESSION" : "")
+    }
+  ' "$BASELINE" "$RESULTS"
+fi
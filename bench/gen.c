@@ -0,0 +1,254 @@
+//  gen.c : générateur déterministe de corpus de test pour lnid.
+//
+//  Produit un ou plusieurs fichiers texte dont la taille totale, la forme des
+//    lignes et la distribution des doublons sont fixées par les arguments.
+//    Deux appels avec les mêmes arguments produisent des fichiers identiques
+//    octet pour octet.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+//--- MACRO --------------------------------------------------------------------
+
+#define USAGE                                                                  \
+  "Syntaxe : %s -t zipf|long|unique -s taille[K|M|G] [-n nbfichiers] "         \
+  "[-S graine] prefixe\n"                                                      \
+  "  zipf   : lignes courtes, doublons selon une loi de Zipf (s = 1)\n"        \
+  "  long   : lignes de 2 Kio à 64 Kio, doublons uniformes\n"                  \
+  "  unique : lignes presque toutes distinctes (1 %% de doublons)\n"           \
+  "Les fichiers produits se nomment prefixe-001.txt, prefixe-002.txt, ...\n"
+
+//  Taille du vocabulaire de la distribution de Zipf et nombre de lignes
+//    longues distinctes.
+#define ZIPF_VOCAB 200000
+#define LONG_VOCAB 512
+
+//  Longueurs extrémales des lignes générées pour chaque type de corpus.
+#define SHORT_LEN_MIN 24
+#define SHORT_LEN_MAX 120
+#define LONG_LEN_MIN 2048
+#define LONG_LEN_MAX 65536
+
+//  Proportion, en pour cent, de lignes tirées dans un fond commun à tous les
+//    fichiers pour le corpus « unique ».
+#define UNIQUE_SHARED_PERCENT 1
+#define UNIQUE_SHARED_VOCAB 10000
+
+#define NFILES_MAX 10000
+
+//--- Générateur pseudo-aléatoire ----------------------------------------------
+
+//  splitmix64 : renvoie l'image de x par la fonction de mélange splitmix64.
+static uint64_t splitmix64(uint64_t x) {
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+//  rng_next : fait avancer l'état pointé par state et renvoie un nouvel entier
+//    pseudo-aléatoire.
+static uint64_t rng_next(uint64_t *state) {
+  *state += 1;
+  return splitmix64(*state);
+}
+
+//--- Lignes -------------------------------------------------------------------
+
+typedef enum {
+  ZIPF,
+  LONG,
+  UNIQUE,
+} kind;
+
+//  line_write : écrit sur le flot f la ligne d'identifiant id, de longueur
+//    comprise entre lmin et lmax, suivie d'une fin de ligne. Le contenu de la
+//    ligne ne dépend que de id, lmin et lmax.
+//  Renvoie le nombre d'octets écrits ou zéro en cas d'erreur.
+static size_t line_write(FILE *f, uint64_t id, size_t lmin, size_t lmax) {
+  static const char alpha[] = "abcdefghijklmnopqrstuvwxyz      ";
+  uint64_t state = splitmix64(id);
+  size_t len = lmin + (size_t) (rng_next(&state) % (lmax - lmin + 1));
+  int n = fprintf(f, "%016llx ", (unsigned long long) id);
+  if (n < 0) {
+    return 0;
+  }
+  size_t k = (size_t) n;
+  uint64_t r = 0;
+  for (size_t i = 0; k < len; ++k, ++i) {
+    if (i % 10 == 0) {
+      r = rng_next(&state);
+    }
+    if (fputc(alpha[r & 0x1F], f) == EOF) {
+      return 0;
+    }
+    r >>= 5;
+  }
+  if (fputc('\n', f) == EOF) {
+    return 0;
+  }
+  return k + 1;
+}
+
+//  zipf_cdf : renvoie un tableau alloué dynamiquement de n valeurs contenant la
+//    fonction de répartition de la loi de Zipf de paramètre 1 sur n rangs, ou
+//    NULL en cas de dépassement de capacité.
+static double *zipf_cdf(size_t n) {
+  double *cdf = malloc(n * sizeof *cdf);
+  if (cdf == NULL) {
+    return NULL;
+  }
+  double s = 0.0;
+  for (size_t k = 0; k < n; ++k) {
+    s += 1.0 / (double) (k + 1);
+    cdf[k] = s;
+  }
+  for (size_t k = 0; k < n; ++k) {
+    cdf[k] /= s;
+  }
+  return cdf;
+}
+
+//  zipf_draw : renvoie un rang tiré selon la fonction de répartition cdf de
+//    longueur n.
+static size_t zipf_draw(const double *cdf, size_t n, uint64_t *state) {
+  double u = (double) (rng_next(state) >> 11) * 0x1.0p-53;
+  size_t lo = 0;
+  size_t hi = n - 1;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (cdf[mid] < u) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+//  parse_size : renvoie la taille décrite par s (suffixes K, M ou G acceptés),
+//    zéro si s n'est pas une taille valide.
+static size_t parse_size(const char *s) {
+  char *end;
+  unsigned long long v = strtoull(s, &end, 10);
+  switch (*end) {
+    case 'G':
+      v *= 1024;
+      // fall through
+    case 'M':
+      v *= 1024;
+      // fall through
+    case 'K':
+      v *= 1024;
+      ++end;
+      break;
+    default:
+      break;
+  }
+  if (*end != '\0' || v > SIZE_MAX) {
+    return 0;
+  }
+  return (size_t) v;
+}
+
+//--- Main ---------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+  kind t = ZIPF;
+  size_t size = 0;
+  unsigned long nfiles = 1;
+  uint64_t seed = 1;
+  int c;
+  while ((c = getopt(argc, argv, "t:s:n:S:")) != -1) {
+    switch (c) {
+      case 't':
+        if (strcmp(optarg, "zipf") == 0) {
+          t = ZIPF;
+        } else if (strcmp(optarg, "long") == 0) {
+          t = LONG;
+        } else if (strcmp(optarg, "unique") == 0) {
+          t = UNIQUE;
+        } else {
+          goto error_usage;
+        }
+        break;
+      case 's':
+        size = parse_size(optarg);
+        break;
+      case 'n':
+        nfiles = strtoul(optarg, NULL, 10);
+        break;
+      case 'S':
+        seed = strtoull(optarg, NULL, 10);
+        break;
+      default:
+        goto error_usage;
+    }
+  }
+  if (optind != argc - 1 || size == 0 || nfiles == 0 || nfiles > NFILES_MAX) {
+    goto error_usage;
+  }
+  const char *prefix = argv[optind];
+  double *cdf = NULL;
+  if (t == ZIPF && (cdf = zipf_cdf(ZIPF_VOCAB)) == NULL) {
+    fprintf(stderr, "*** Error: Not enough memory\n");
+    return EXIT_FAILURE;
+  }
+  int r = EXIT_SUCCESS;
+  size_t fsize = size / nfiles;
+  uint64_t uid = 0;
+  for (unsigned long k = 0; k < nfiles; ++k) {
+    char name[strlen(prefix) + sizeof "-00000.txt"];
+    sprintf(name, "%s-%03lu.txt", prefix, k + 1);
+    FILE *f = fopen(name, "wb");
+    if (f == NULL) {
+      fprintf(stderr, "*** Error: Cannot create %s\n", name);
+      r = EXIT_FAILURE;
+      break;
+    }
+    uint64_t state = splitmix64(seed ^ splitmix64(k));
+    size_t written = 0;
+    while (written < fsize) {
+      size_t n;
+      uint64_t x = rng_next(&state);
+      switch (t) {
+        case ZIPF:
+          n = line_write(f, zipf_draw(cdf, ZIPF_VOCAB, &state),
+              SHORT_LEN_MIN, SHORT_LEN_MAX);
+          break;
+        case LONG:
+          n = line_write(f, x % LONG_VOCAB, LONG_LEN_MIN, LONG_LEN_MAX);
+          break;
+        default:
+          if (x % 100 < UNIQUE_SHARED_PERCENT) {
+            n = line_write(f, (x >> 8) % UNIQUE_SHARED_VOCAB,
+                SHORT_LEN_MIN, SHORT_LEN_MAX);
+          } else {
+            n = line_write(f, ((uint64_t) (k + 1) << 40) + uid++,
+                SHORT_LEN_MIN, SHORT_LEN_MAX);
+          }
+          break;
+      }
+      if (n == 0) {
+        break;
+      }
+      written += n;
+    }
+    int e = written < fsize;
+    if (fclose(f) != 0 || e) {
+      fprintf(stderr, "*** Error: A write error occurs on %s\n", name);
+      r = EXIT_FAILURE;
+      break;
+    }
+  }
+  free(cdf);
+  return r;
+error_usage:
+  fprintf(stderr, USAGE, argv[0]);
+  return EXIT_FAILURE;
+}
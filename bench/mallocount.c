@@ -0,0 +1,114 @@
+//  mallocount.c : bibliothèque à précharger (LD_PRELOAD) qui compte les appels
+//    aux fonctions d'allocation de la bibliothèque C d'un processus.
+//
+//  À la terminaison du processus, une ligne au format « nombre d'allocations
+//    <tab> nombre d'octets demandés » est ajoutée au fichier dont le nom est
+//    la valeur de la variable d'environnement MALLOCOUNT_OUT, si celle-ci est
+//    définie. Les appels à realloc qui déplacent ou créent un bloc comptent
+//    pour une allocation, de même que ceux à aligned_alloc, posix_memalign et
+//    memalign et, pour la taille projetée, ceux à mmap, anonymes ou non. Les
+//    fonctions de la glibc __libc_* servent de fonctions d'allocation
+//    sous-jacentes et mmap est réalisée par l'appel système, ce qui évite le
+//    recours à dlsym. Les allocations faites par la bibliothèque elle-même,
+//    lors de l'écriture de la mesure, ne sont pas comptées.
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+
+static atomic_ulong nallocs;
+static atomic_ulong nbytes;
+
+//  reporting : vrai pendant l'écriture de la mesure, dont les allocations ne
+//    sont pas comptées.
+static _Thread_local bool reporting;
+
+//  count : compte une allocation de size octets.
+static void count(size_t size) {
+  if (reporting) {
+    return;
+  }
+  atomic_fetch_add_explicit(&nallocs, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&nbytes, size, memory_order_relaxed);
+}
+
+void *malloc(size_t size) {
+  count(size);
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size) {
+  count(nmemb * size);
+  return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  void *p = __libc_realloc(ptr, size);
+  if (p != ptr) {
+    count(size);
+  }
+  return p;
+}
+
+void *memalign(size_t alignment, size_t size) {
+  count(size);
+  return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+  count(size);
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **memptr, size_t alignment, size_t size) {
+  if (alignment % sizeof(void *) != 0
+      || (alignment & (alignment - 1)) != 0) {
+    return EINVAL;
+  }
+  count(size);
+  void *p = __libc_memalign(alignment, size);
+  if (p == NULL && size != 0) {
+    return ENOMEM;
+  }
+  *memptr = p;
+  return 0;
+}
+
+void *mmap(void *addr, size_t length, int prot, int flags, int fd,
+    off_t offset) {
+  count(length);
+  return (void *) syscall(SYS_mmap, addr, length, prot, flags, fd, offset);
+}
+
+__attribute__((destructor))
+static void mallocount_report(void) {
+  reporting = true;
+  const char *name = getenv("MALLOCOUNT_OUT");
+  if (name == NULL) {
+    return;
+  }
+  int fd = open(name, O_WRONLY | O_APPEND | O_CREAT, 0644);
+  if (fd < 0) {
+    return;
+  }
+  char buf[64];
+  int n = snprintf(buf, sizeof buf, "%lu\t%lu\n",
+      atomic_load(&nallocs), atomic_load(&nbytes));
+  if (n > 0 && write(fd, buf, (size_t) n) < 0) {
+    n = 0;
+  }
+  close(fd);
+}
@@ -0,0 +1,364 @@
+//  micro.c : microbancs d'essai des modules da, ds, hashtable et holdall.
+//
+//  Chaque opération est mesurée isolément sur des tailles croissantes. Une
+//    mesure consiste en un certain nombre de tours de chauffe suivis d'un
+//    certain nombre de répétitions chronométrées ; chaque répétition exécute
+//    l'opération n fois. Le résultat est écrit sur la sortie standard au
+//    format « opération <tab> n <tab> ns/op moyen <tab> écart type <tab>
+//    minimum » après une ligne d'en-tête.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "da.h"
+#include "ds.h"
+#include "hashtable.h"
+#include "holdall.h"
+
+#define USAGE                                                                  \
+  "Syntaxe : %s [-w tours de chauffe] [-r répétitions] [-n taille max]\n"
+
+#define WARMUP_DEFAULT 2
+#define REPEAT_DEFAULT 10
+#define NMAX_DEFAULT 1000000
+#define NMIN 1000
+#define REPEAT_MAX 1000
+
+//--- État partagé par les mesures ---------------------------------------------
+
+//  Clés présentes (keys) et absentes (misses) des tables, sous forme de chaînes
+//    de longueur fixe stockées de manière contiguë.
+#define KEY_LEN 24
+
+static char *keys;
+static char *misses;
+static size_t *order;
+
+static hashtable *ht;
+static da *d;
+static ds *s;
+static holdall *ha;
+
+static volatile size_t sink;
+
+#define KEY(k) (keys + (k) * KEY_LEN)
+#define MISS(k) (misses + (k) * KEY_LEN)
+
+static int zero(void *ref) {
+  sink += (ref != NULL);
+  return 0;
+}
+
+//  keys_init : initialise les clés et un ordre de parcours aléatoire de n
+//    éléments. Renvoie une valeur non nulle en cas de dépassement de capacité.
+static int keys_init(size_t n) {
+  keys = malloc(n * KEY_LEN);
+  misses = malloc(n * KEY_LEN);
+  order = malloc(n * sizeof *order);
+  if (keys == NULL || misses == NULL || order == NULL) {
+    return -1;
+  }
+  uint64_t x = 88172645463325252ULL;
+  for (size_t k = 0; k < n; ++k) {
+    snprintf(KEY(k), KEY_LEN, "key%012zu", k);
+    snprintf(MISS(k), KEY_LEN, "mis%012zu", k);
+    order[k] = k;
+  }
+  for (size_t k = n - 1; k > 0; --k) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    size_t j = (size_t) (x % (k + 1));
+    size_t t = order[k];
+    order[k] = order[j];
+    order[j] = t;
+  }
+  return 0;
+}
+
+//  table_fill : crée la table ht et y ajoute les n premières clés. Renvoie une
+//    valeur non nulle en cas de dépassement de capacité, zéro sinon.
+static int table_fill(size_t n) {
+  ht = hashtable_empty((int (*)(const void *, const void *))strcmp,
+      hashtable_str_hashfun);
+  for (size_t k = 0; ht != NULL && k < n; ++k) {
+    if (hashtable_add(ht, KEY(k), KEY(k)) == NULL) {
+      hashtable_dispose(&ht);
+    }
+  }
+  return ht == NULL;
+}
+
+//--- Opérations ---------------------------------------------------------------
+
+static void ht_dispose(void) {
+  hashtable_dispose(&ht);
+}
+
+static int ht_setup_empty(size_t n) {
+  (void) n;
+  return table_fill(0);
+}
+
+static void ht_add(size_t n) {
+  for (size_t k = 0; k < n; ++k) {
+    sink += (hashtable_add(ht, KEY(k), KEY(k)) != NULL);
+  }
+}
+
+static void ht_search_hit(size_t n) {
+  for (size_t k = 0; k < n; ++k) {
+    sink += (hashtable_search(ht, KEY(order[k])) != NULL);
+  }
+}
+
+static void ht_search_miss(size_t n) {
+  for (size_t k = 0; k < n; ++k) {
+    sink += (hashtable_search(ht, MISS(order[k])) != NULL);
+  }
+}
+
+//  Les recherches groupées sont menées par lots de BATCH clés.
+#define BATCH 32
+
+static void ht_search_batch_hit(size_t n) {
+  const void *k[BATCH];
+  void *v[BATCH];
+  for (size_t j = 0; j < n; j += BATCH) {
+    size_t m = (n - j < BATCH ? n - j : BATCH);
+    for (size_t i = 0; i < m; ++i) {
+      k[i] = KEY(order[j + i]);
+    }
+    hashtable_search_batch(ht, k, m, v);
+    for (size_t i = 0; i < m; ++i) {
+      sink += (v[i] != NULL);
+    }
+  }
+}
+
+static void ht_remove_hit(size_t n) {
+  for (size_t k = 0; k < n; ++k) {
+    sink += (hashtable_remove(ht, KEY(order[k])) != NULL);
+  }
+}
+
+static void ht_remove_miss(size_t n) {
+  for (size_t k = 0; k < n; ++k) {
+    sink += (hashtable_remove(ht, MISS(order[k])) != NULL);
+  }
+}
+
+//  Le tableau de hachage est doublé dès que le nombre de clés dépasse le nombre
+//    de compartiments, qui est une puissance de 2 supérieure ou égale à 64. La
+//    table remplie avec n clés où n est une puissance de 2 est donc à la
+//    veille d'un agrandissement : l'ajout suivant le déclenche.
+
+static int ht_setup_full(size_t n) {
+  return table_fill(n);
+}
+
+static void ht_add_resize(size_t n) {
+  sink += (hashtable_add(ht, MISS(0), MISS(0)) != NULL);
+  (void) n;
+}
+
+static int da_setup(size_t n) {
+  d = da_empty();
+  (void) n;
+  return d == NULL;
+}
+
+static void da_teardown(void) {
+  da_dispose(&d);
+}
+
+static void da_add_n(size_t n) {
+  for (size_t k = 0; k < n; ++k) {
+    sink += (da_add(d, KEY(k)) != NULL);
+  }
+}
+
+static int ds_setup(size_t n) {
+  s = ds_empty();
+  (void) n;
+  return s == NULL;
+}
+
+static void ds_teardown(void) {
+  ds_dispose(&s);
+}
+
+static void ds_add_n(size_t n) {
+  for (size_t k = 0; k < n; ++k) {
+    sink += (size_t) ds_add(s, (char) ('a' + k % 26));
+  }
+}
+
+static int ha_setup_empty(size_t n) {
+  ha = holdall_empty();
+  (void) n;
+  return ha == NULL;
+}
+
+static int ha_setup_full(size_t n) {
+  ha = holdall_empty();
+  for (size_t k = 0; ha != NULL && k < n; ++k) {
+    if (holdall_put(ha, KEY(k)) != 0) {
+      holdall_dispose(&ha);
+    }
+  }
+  return ha == NULL;
+}
+
+static void ha_teardown(void) {
+  holdall_dispose(&ha);
+}
+
+static void ha_put(size_t n) {
+  for (size_t k = 0; k < n; ++k) {
+    sink += (size_t) holdall_put(ha, KEY(k));
+  }
+}
+
+static void ha_apply(size_t n) {
+  sink += (size_t) holdall_apply(ha, zero);
+  (void) n;
+}
+
+//--- Mesure -------------------------------------------------------------------
+
+//  struct bench : une opération mesurée. setup prépare l'état hors chronomètre
+//    et renvoie une valeur non nulle en cas de dépassement de capacité, run
+//    exécute l'opération, teardown libère l'état. Le champ nops donne le
+//    nombre d'opérations effectuées par run(n) : n si nops vaut zéro, nops
+//    sinon.
+typedef struct {
+  const char *name;
+  int (*setup)(size_t n);
+  void (*run)(size_t n);
+  void (*teardown)(void);
+  size_t nops;
+} bench;
+
+static const bench benches[] = {
+  { "hashtable_add", ht_setup_empty, ht_add, ht_dispose, 0 },
+  { "hashtable_add_resize", ht_setup_full, ht_add_resize, ht_dispose, 1 },
+  { "hashtable_search_hit", ht_setup_full, ht_search_hit, ht_dispose, 0 },
+  { "hashtable_search_miss", ht_setup_full, ht_search_miss, ht_dispose, 0 },
+  { "hashtable_search_batch_hit", ht_setup_full, ht_search_batch_hit,
+    ht_dispose, 0 },
+  { "hashtable_remove_hit", ht_setup_full, ht_remove_hit, ht_dispose, 0 },
+  { "hashtable_remove_miss", ht_setup_full, ht_remove_miss, ht_dispose, 0 },
+  { "da_add", da_setup, da_add_n, da_teardown, 0 },
+  { "ds_add", ds_setup, ds_add_n, ds_teardown, 0 },
+  { "holdall_put", ha_setup_empty, ha_put, ha_teardown, 0 },
+  { "holdall_apply", ha_setup_full, ha_apply, ha_teardown, 0 },
+};
+
+#define NBENCHES (sizeof benches / sizeof *benches)
+
+static double now(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double) t.tv_sec * 1e9 + (double) t.tv_nsec;
+}
+
+//  bench_measure : effectue warmup tours de chauffe puis repeat répétitions de
+//    la mesure b sur la taille n et écrit le résultat sur la sortie standard.
+//    Renvoie une valeur non nulle en cas de dépassement de capacité, zéro
+//    sinon.
+static int bench_measure(const bench *b, size_t n, int warmup, int repeat) {
+  double t[REPEAT_MAX];
+  size_t nops = (b->nops == 0 ? n : b->nops);
+  for (int k = -warmup; k < repeat; ++k) {
+    if (b->setup(n) != 0) {
+      b->teardown();
+      return -1;
+    }
+    double t0 = now();
+    b->run(n);
+    double t1 = now();
+    b->teardown();
+    if (k >= 0) {
+      t[k] = (t1 - t0) / (double) nops;
+    }
+  }
+  double mean = 0.0;
+  double min = t[0];
+  for (int k = 0; k < repeat; ++k) {
+    mean += t[k];
+    min = (t[k] < min ? t[k] : min);
+  }
+  mean /= repeat;
+  double var = 0.0;
+  for (int k = 0; k < repeat; ++k) {
+    var += (t[k] - mean) * (t[k] - mean);
+  }
+  var = (repeat > 1 ? var / (repeat - 1) : 0.0);
+  printf("%s\t%zu\t%.2f\t%.2f\t%.2f\n", b->name, n, mean, sqrt(var), min);
+  return 0;
+}
+
+//--- Main ---------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+  int warmup = WARMUP_DEFAULT;
+  int repeat = REPEAT_DEFAULT;
+  size_t nmax = NMAX_DEFAULT;
+  int c;
+  while ((c = getopt(argc, argv, "w:r:n:")) != -1) {
+    switch (c) {
+      case 'w':
+        warmup = atoi(optarg);
+        break;
+      case 'r':
+        repeat = atoi(optarg);
+        break;
+      case 'n':
+        nmax = (size_t) strtoull(optarg, NULL, 10);
+        break;
+      default:
+        fprintf(stderr, USAGE, argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  if (warmup < 0 || repeat < 1 || repeat > REPEAT_MAX || nmax < NMIN) {
+    fprintf(stderr, USAGE, argv[0]);
+    return EXIT_FAILURE;
+  }
+  //  Les tailles mesurées sont les puissances de 2 comprises entre NMIN et
+  //    nmax, de façon à ce que hashtable_add_resize mesure bien l'ajout qui
+  //    déclenche un agrandissement.
+  size_t nfirst = 1;
+  while (nfirst < NMIN) {
+    nfirst *= 2;
+  }
+  size_t nlast = nfirst;
+  while (nlast * 2 <= nmax) {
+    nlast *= 2;
+  }
+  if (keys_init(nlast) != 0) {
+    fprintf(stderr, "*** Error: Not enough memory\n");
+    return EXIT_FAILURE;
+  }
+  int r = EXIT_SUCCESS;
+  printf("op\tn\tns_per_op\tstddev\tmin\n");
+  for (size_t i = 0; r == EXIT_SUCCESS && i < NBENCHES; ++i) {
+    for (size_t n = nfirst; r == EXIT_SUCCESS && n <= nlast; n *= 8) {
+      if (bench_measure(&benches[i], n, warmup, repeat) != 0) {
+        fprintf(stderr, "*** Error: Not enough memory\n");
+        r = EXIT_FAILURE;
+      }
+    }
+  }
+  free(keys);
+  free(misses);
+  free(order);
+  return r;
+}
@@ -0,0 +1,70 @@
+//  rusage.c : exécute une commande et mesure sa durée ainsi que le pic de
+//    mémoire résidente de ses processus.
+//
+//  Le résultat est écrit sur une ligne, au format « durée (s) <tab> pic de
+//    mémoire résidente (Kio) <tab> statut de sortie », dans le fichier dont
+//    le nom suit l'option -o, ou sur la sortie erreur à défaut. La sortie
+//    standard de la commande n'est pas redirigée.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#define USAGE "Syntaxe : %s [-o fichier] commande [argument ...]\n"
+
+int main(int argc, char *argv[]) {
+  const char *out = NULL;
+  int k = 1;
+  if (argc > 2 && strcmp(argv[1], "-o") == 0) {
+    out = argv[2];
+    k = 3;
+  }
+  if (k >= argc) {
+    fprintf(stderr, USAGE, argv[0]);
+    return EXIT_FAILURE;
+  }
+  struct timespec t0;
+  struct timespec t1;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    return EXIT_FAILURE;
+  }
+  if (pid == 0) {
+    execvp(argv[k], argv + k);
+    perror(argv[k]);
+    _exit(127);
+  }
+  int status;
+  if (waitpid(pid, &status, 0) < 0) {
+    perror("waitpid");
+    return EXIT_FAILURE;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  struct rusage ru;
+  if (getrusage(RUSAGE_CHILDREN, &ru) != 0) {
+    perror("getrusage");
+    return EXIT_FAILURE;
+  }
+  double secs = (double) (t1.tv_sec - t0.tv_sec)
+    + (double) (t1.tv_nsec - t0.tv_nsec) / 1e9;
+  int code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+  FILE *f = (out == NULL ? stderr : fopen(out, "w"));
+  if (f == NULL) {
+    perror(out);
+    return EXIT_FAILURE;
+  }
+  fprintf(f, "%.6f\t%ld\t%d\n", secs, ru.ru_maxrss, code);
+  if (f != stderr && fclose(f) != 0) {
+    return EXIT_FAILURE;
+  }
+  return code;
+}
@@ -0,0 +1,88 @@
+//  bloom.c : partie implantation d'un module pour la spécification d'un filtre
+//    de Bloom par blocs sur des valeurs de hachage de 64 bits.
+
+#include <string.h>
+#include "bloom.h"
+
+//  Le filtre est un tableau de blocs de BLOOM__WORDS mots de 64 bits, soit une
+//    ligne de cache de 64 octets. Une valeur de hachage h sélectionne un bloc
+//    avec ses 32 bits de poids fort, puis positionne un bit dans chacun des
+//    mots du bloc, choisi par multiplication de ses 32 bits de poids faible par
+//    un sel propre au mot. Le nombre de blocs est calculé pour offrir
+//    BLOOM__BITS_PER_KEY bits par valeur attendue, ce qui donne un taux de faux
+//    positifs de l'ordre de 0,1 %.
+
+#define BLOOM__WORDS        8
+#define BLOOM__BLOCK_BITS   (BLOOM__WORDS * 64)
+#define BLOOM__BITS_PER_KEY 16
+#define BLOOM__ALIGN        64
+
+typedef struct {
+  uint64_t w[BLOOM__WORDS];
+} block;
+
+struct bloom {
+  block *blocks;
+  uint64_t nblocks;
+};
+
+static const uint64_t salt[BLOOM__WORDS] = {
+  0x47b6137b44974d91ULL, 0x8824ad5ba2b7289dULL,
+  0x705495c72df1424bULL, 0x9efc49475c6bfb31ULL,
+  0x2df1424b47b6137bULL, 0x5c6bfb31a2b7289dULL,
+  0x44974d918824ad5bULL, 0x9efc4947705495c7ULL,
+};
+
+//  BLOCK : bloc associé à la valeur de hachage h ; le produit de ses 32 bits
+//    de poids fort par le nombre de blocs est ramené dans [0, nblocks[ sans
+//    division.
+#define BLOCK(b, h) (&(b)->blocks[(((h) >> 32) * (b)->nblocks) >> 32])
+
+//  BIT : masque du bit positionné dans le mot d'indice i pour h.
+#define BIT(h, i) \
+  ((uint64_t) 1 << ((((h) & 0xFFFFFFFFULL) * salt[i]) >> 58))
+
+bloom *bloom_empty(size_t n) {
+  bloom *b = malloc(sizeof *b);
+  if (b == NULL) {
+    return NULL;
+  }
+  uint64_t nblocks = (n / BLOOM__BLOCK_BITS + 1) * BLOOM__BITS_PER_KEY;
+  if (nblocks > UINT32_MAX || nblocks > SIZE_MAX / sizeof *b->blocks) {
+    free(b);
+    return NULL;
+  }
+  b->blocks = aligned_alloc(BLOOM__ALIGN, nblocks * sizeof *b->blocks);
+  if (b->blocks == NULL) {
+    free(b);
+    return NULL;
+  }
+  memset(b->blocks, 0, nblocks * sizeof *b->blocks);
+  b->nblocks = nblocks;
+  return b;
+}
+
+void bloom_dispose(bloom **bptr) {
+  if (*bptr == NULL) {
+    return;
+  }
+  free((*bptr)->blocks);
+  free(*bptr);
+  *bptr = NULL;
+}
+
+void bloom_add(bloom *b, uint64_t h) {
+  block *p = BLOCK(b, h);
+  for (size_t i = 0; i < BLOOM__WORDS; ++i) {
+    p->w[i] |= BIT(h, i);
+  }
+}
+
+bool bloom_contains(const bloom *b, uint64_t h) {
+  const block *p = BLOCK(b, h);
+  uint64_t r = 0;
+  for (size_t i = 0; i < BLOOM__WORDS; ++i) {
+    r |= BIT(h, i) & ~p->w[i];
+  }
+  return r == 0;
+}
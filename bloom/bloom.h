@@ -0,0 +1,48 @@
+//  bloom.h : partie interface d'un module pour la spécification d'un filtre de
+//    Bloom par blocs sur des valeurs de hachage de 64 bits.
+
+#ifndef BLOOM__H
+#define BLOOM__H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+//  Fonctionnement général :
+//  - la structure de données ne stocke ni objets ni références, mais des
+//      empreintes de valeurs de hachage de 64 bits fournies par l'utilisateur ;
+//  - un filtre répond à la question « la valeur h a-t-elle été ajoutée ? » sans
+//      jamais donner de faux négatif, mais avec une faible probabilité de faux
+//      positif. Cette probabilité dépend de la qualité des valeurs de hachage,
+//      dont tous les bits doivent être bien distribués ;
+//  - les empreintes d'une même valeur tiennent dans un seul bloc de 64 octets,
+//      de sorte qu'un test négatif ne coûte qu'un accès à une ligne de cache ;
+//  - les fonctions qui possèdent un paramètre de type « bloom * » ou
+//      « bloom ** » ont un comportement indéterminé lorsque ce paramètre ou sa
+//      déréférence n'est pas l'adresse d'un contrôleur préalablement renvoyée
+//      avec succès par la fonction bloom_empty et non révoquée depuis par la
+//      fonction bloom_dispose.
+
+//  struct bloom, bloom : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer un filtre de Bloom par blocs.
+typedef struct bloom bloom;
+
+//  bloom_empty : tente d'allouer les ressources nécessaires pour gérer un
+//    nouveau filtre initialement vide, dimensionné pour n valeurs. Renvoie NULL
+//    en cas de dépassement de capacité. Renvoie sinon un pointeur vers le
+//    contrôleur associé au filtre.
+extern bloom *bloom_empty(size_t n);
+
+//  bloom_dispose : sans effet si *bptr vaut NULL. Libère sinon les ressources
+//    allouées à la gestion du filtre associé à *bptr puis affecte NULL à *bptr.
+extern void bloom_dispose(bloom **bptr);
+
+//  bloom_add : ajoute la valeur de hachage h au filtre associé à b.
+extern void bloom_add(bloom *b, uint64_t h);
+
+//  bloom_contains : renvoie false si la valeur de hachage h n'a jamais été
+//    ajoutée au filtre associé à b. Renvoie true si elle l'a été, ou, avec une
+//    faible probabilité, si elle ne l'a pas été.
+extern bool bloom_contains(const bloom *b, uint64_t h);
+
+#endif
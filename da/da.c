@@ -1,23 +1,54 @@
 //  da.c : partie implantation d'un module polymorphe pour la spécification
 //    de tableau dynamique
 
+#include <string.h>
 #include "da.h"
 
-#define DA__CAPACITY_MIN 4
+#define DA__CAPACITY_MIN DA_INLINE
 #define DA__CAPACITY_MUL 2
 
 //--- Définition da ------------------------------------------------------------
 
+//  Le champ aref pointe sur le tableau inl tant que la longueur ne dépasse pas
+//    DA_INLINE, sur un tableau alloué ensuite.
 struct da {
   const void **aref;
   size_t length;
   size_t capacity;
+  const void *inl[DA_INLINE];
 };
 
 //--- Raccourcis da ------------------------------------------------------------
 #define IS_EMPTY(p)    ((p)->length == 0)
 #define LENGTH(p)      ((p)->length)
 #define CAPACITY(p)    ((p)->capacity)
+#define IS_INLINE(p)   ((p)->aref == (p)->inl)
+
+//--- Fonction interne ---------------------------------------------------------
+
+//  da__resize : Tente de porter la capacité du tableau pointé par p à n, qui
+//    est supérieur à DA_INLINE et au moins égal à sa longueur. Renvoie une
+//    valeur non nulle en cas de dépassement de capacité, zéro sinon.
+static int da__resize(da *p, size_t n) {
+  if (n > SIZE_MAX / sizeof *(p->aref)) {
+    return -1;
+  }
+  const void **t;
+  if (IS_INLINE(p)) {
+    t = malloc(n * sizeof *(p->aref));
+    if (t != NULL) {
+      memcpy(t, p->inl, LENGTH(p) * sizeof *(p->aref));
+    }
+  } else {
+    t = realloc(p->aref, n * sizeof *(p->aref));
+  }
+  if (t == NULL) {
+    return -1;
+  }
+  p->aref = t;
+  p->capacity = n;
+  return 0;
+}
 
 //--- Fonctions da -------------------------------------------------------------
 
@@ -26,12 +57,7 @@ da *da_empty() {
   if (p == NULL) {
     return NULL;
   }
-  const void **tab = malloc(DA__CAPACITY_MIN * sizeof *(p->aref));
-  if (tab == NULL) {
-    free(p);
-    return NULL;
-  }
-  p->aref = tab;
+  p->aref = p->inl;
   p->capacity = DA__CAPACITY_MIN;
   p->length = 0;
   return p;
@@ -41,7 +67,9 @@ void da_dispose(da **aptr) {
   if (*aptr == NULL) {
     return;
   }
-  free((*aptr)->aref);
+  if (!IS_INLINE(*aptr)) {
+    free((*aptr)->aref);
+  }
   free(*aptr);
   *aptr = NULL;
   return;
@@ -59,28 +87,69 @@ void *da_add(da *p, const void *ref) {
     return NULL;
   }
   if (LENGTH(p) == CAPACITY(p)) {
-    if (((sizeof *(p->aref) * p->capacity)) > SIZE_MAX / DA__CAPACITY_MUL) {
-      return NULL;
-    }
-    const void **t
-      = realloc(p->aref,
-        (sizeof *(p->aref) * p->capacity * DA__CAPACITY_MUL));
-    if (t == NULL) {
+    if (CAPACITY(p) > SIZE_MAX / DA__CAPACITY_MUL
+        || da__resize(p, CAPACITY(p) * DA__CAPACITY_MUL) != 0) {
       return NULL;
     }
-    p->aref = t;
-    p->capacity *= DA__CAPACITY_MUL;
   }
   p->aref[LENGTH(p)] = ref;
   LENGTH(p) += 1;
   return (void *) ref;
 }
 
+int da_append(da *p, const void * const *refs, size_t n) {
+  for (size_t k = 0; k < n; ++k) {
+    if (refs[k] == NULL) {
+      return -1;
+    }
+  }
+  if (n > SIZE_MAX - LENGTH(p)) {
+    return -1;
+  }
+  if (LENGTH(p) + n > CAPACITY(p)) {
+    //  Croissance géométrique, comme pour des ajouts successifs, sauf si
+    //    l'ajout demande davantage.
+    size_t c = CAPACITY(p);
+    c = (c > SIZE_MAX / DA__CAPACITY_MUL ? SIZE_MAX : c * DA__CAPACITY_MUL);
+    if (da__resize(p, (c < LENGTH(p) + n ? LENGTH(p) + n : c)) != 0) {
+      return -1;
+    }
+  }
+  memcpy(p->aref + LENGTH(p), refs, n * sizeof *(p->aref));
+  LENGTH(p) += n;
+  return 0;
+}
+
+int da_reserve(da *p, size_t n) {
+  if (n <= CAPACITY(p)) {
+    return 0;
+  }
+  return da__resize(p, n);
+}
+
+void da_shrink_to_fit(da *p) {
+  if (IS_INLINE(p) || LENGTH(p) == CAPACITY(p)) {
+    return;
+  }
+  if (LENGTH(p) <= DA_INLINE) {
+    memcpy(p->inl, p->aref, LENGTH(p) * sizeof *(p->aref));
+    free(p->aref);
+    p->aref = p->inl;
+    p->capacity = DA_INLINE;
+    return;
+  }
+  const void **t = realloc(p->aref, LENGTH(p) * sizeof *(p->aref));
+  if (t != NULL) {
+    p->aref = t;
+    p->capacity = LENGTH(p);
+  }
+}
+
 void *da_ref(da *p, size_t i) {
   if (p == NULL) {
     return NULL;
   }
-  if (i > LENGTH(p)) {
+  if (i >= LENGTH(p)) {
     return NULL;
   }
   return (void *) p->aref[i];
@@ -25,7 +25,13 @@
 //      auparavant stockée par la structure de données ;
 //  - l'implantation des fonctions dont la spécification ne précise pas qu'elles
 //      doivent gérer les cas de dépassement de capacité, ne doivent avoir
-//      affaire avec aucun problème de la sorte.
+//      affaire avec aucun problème de la sorte ;
+//  - les premières références sont stockées dans le contrôleur lui-même : un
+//      tableau de longueur au plus DA_INLINE ne demande aucune autre
+//      allocation que celle de son contrôleur.
+
+//  DA_INLINE : nombre de références stockées dans le contrôleur.
+#define DA_INLINE 4
 
 //  struct da, da : Type et nom de type d'un contrôleur regroupant les
 //    informations nécessaires pour gérer un tableau dynamique d'objets
@@ -53,9 +59,26 @@ extern int da_dispose_element(da *p);
 //    dépassement de capacité, renvoie sinon ref.
 extern void *da_add(da *p, const void *ref);
 
+//  da_append : Tente d'ajouter en bout de tableau les n références du tableau
+//    refs, dans l'ordre. Renvoie une valeur non nulle si l'une d'elles vaut
+//    NULL ou en cas de dépassement de capacité, sans rien ajouter. Renvoie
+//    zéro sinon.
+extern int da_append(da *p, const void * const *refs, size_t n);
+
+//  da_reserve : Tente de porter la capacité du tableau pointé par p à au moins
+//    n. Renvoie une valeur non nulle en cas de dépassement de capacité, zéro
+//    sinon.
+extern int da_reserve(da *p, size_t n);
+
+//  da_shrink_to_fit : Ramène la capacité du tableau pointé par p à sa
+//    longueur, ou à DA_INLINE si sa longueur est inférieure, en rapatriant ses
+//    références dans le contrôleur si elles y tiennent. Sans effet en cas
+//    d'échec de la réallocation.
+extern void da_shrink_to_fit(da *p);
+
 //  da_ref : Renvoie la référence d'indice i du tableau pointé par p.
-//    Renvoie NULL si p est vide ou si i est supérieur à la longueur de p
-//    sinon renvoie la référence.
+//    Renvoie NULL si p est vide ou si i est supérieur ou égal à la longueur
+//    de p sinon renvoie la référence.
 extern void *da_ref(da *p, size_t i);
 
 //  da_length : Renvoie la longueur du tableau associés à p.
@@ -5,6 +5,116 @@
 
 #define TRACK fprintf(stderr, "*** %s:%d\n", __func__, __LINE__);
 
+//  CHECK : signale sur la sortie erreur l'échec de la condition cond et
+//    abandonne la fonction en cours en renvoyant -1.
+#define CHECK(cond)                                                            \
+  if (!(cond)) {                                                               \
+    fprintf(stderr, "*** Check failed: %s:%d: %s\n", __func__, __LINE__,      \
+        #cond);                                                                \
+    return -1;                                                                 \
+  }
+
+//  NREFS : nombre de références utilisées par les vérifications.
+#define NREFS (4 * DA_INLINE)
+
+//  check_contents : vérifie que le tableau pointé par p est formé des n
+//    premières références de refs et que da_ref renvoie NULL au-delà.
+static int check_contents(da *p, char **refs, size_t n) {
+  CHECK(da_length(p) == n);
+  for (size_t k = 0; k < n; ++k) {
+    CHECK(da_ref(p, k) == refs[k]);
+  }
+  CHECK(da_ref(p, da_length(p)) == NULL);
+  CHECK(da_ref(p, da_length(p) + 1) == NULL);
+  return 0;
+}
+
+//  check_inline : vérifie le passage des références du contrôleur à un tableau
+//    alloué au-delà de DA_INLINE par da_add, puis leur retour dans le
+//    contrôleur par da_shrink_to_fit.
+static int check_inline(char **refs) {
+  da *p = da_empty();
+  CHECK(p != NULL);
+  CHECK(da_ref(p, 0) == NULL);
+  CHECK(da_add(p, NULL) == NULL);
+  for (size_t k = 0; k < DA_INLINE; ++k) {
+    CHECK(da_add(p, refs[k]) == refs[k]);
+    CHECK(da_capacity(p) == DA_INLINE);
+  }
+  CHECK(check_contents(p, refs, DA_INLINE) == 0);
+  CHECK(da_add(p, refs[DA_INLINE]) == refs[DA_INLINE]);
+  CHECK(da_capacity(p) > DA_INLINE);
+  CHECK(check_contents(p, refs, DA_INLINE + 1) == 0);
+  for (size_t k = DA_INLINE + 1; k < NREFS; ++k) {
+    CHECK(da_add(p, refs[k]) == refs[k]);
+  }
+  CHECK(check_contents(p, refs, NREFS) == 0);
+  //  Réserve au-delà de la longueur, puis retour à la longueur.
+  CHECK(da_reserve(p, NREFS + 1) == 0);
+  CHECK(da_capacity(p) == NREFS + 1);
+  da_shrink_to_fit(p);
+  CHECK(da_capacity(p) == NREFS);
+  CHECK(check_contents(p, refs, NREFS) == 0);
+  da_dispose(&p);
+  CHECK(p == NULL);
+  //  Retour dans le contrôleur d'un tableau devenu assez court.
+  p = da_empty();
+  CHECK(p != NULL);
+  CHECK(da_reserve(p, 2 * DA_INLINE) == 0);
+  for (size_t k = 0; k < DA_INLINE - 1; ++k) {
+    CHECK(da_add(p, refs[k]) != NULL);
+  }
+  CHECK(da_capacity(p) == 2 * DA_INLINE);
+  da_shrink_to_fit(p);
+  CHECK(da_capacity(p) == DA_INLINE);
+  CHECK(check_contents(p, refs, DA_INLINE - 1) == 0);
+  CHECK(da_add(p, refs[DA_INLINE - 1]) != NULL);
+  CHECK(da_add(p, refs[DA_INLINE]) != NULL);
+  CHECK(check_contents(p, refs, DA_INLINE + 1) == 0);
+  da_dispose(&p);
+  da_dispose(&p);
+  return 0;
+}
+
+//  check_append : vérifie da_append, d'un seul tenant ou à cheval sur
+//    DA_INLINE, ainsi que son refus d'une référence NULL.
+static int check_append(char **refs) {
+  da *p = da_empty();
+  CHECK(p != NULL);
+  CHECK(da_append(p, (const void * const *) refs, 0) == 0);
+  CHECK(da_length(p) == 0);
+  CHECK(da_append(p, (const void * const *) refs, DA_INLINE - 1) == 0);
+  CHECK(da_capacity(p) == DA_INLINE);
+  CHECK(da_append(p, (const void * const *) refs + DA_INLINE - 1, 2) == 0);
+  CHECK(da_capacity(p) >= DA_INLINE + 1);
+  CHECK(check_contents(p, refs, DA_INLINE + 1) == 0);
+  CHECK(da_append(p, (const void * const *) refs + DA_INLINE + 1,
+      NREFS - DA_INLINE - 1) == 0);
+  CHECK(check_contents(p, refs, NREFS) == 0);
+  const void *withnull[] = { refs[0], NULL };
+  CHECK(da_append(p, withnull, 2) != 0);
+  CHECK(check_contents(p, refs, NREFS) == 0);
+  da_dispose(&p);
+  p = da_empty();
+  CHECK(p != NULL);
+  CHECK(da_append(p, (const void * const *) refs, NREFS) == 0);
+  CHECK(da_capacity(p) >= NREFS);
+  CHECK(check_contents(p, refs, NREFS) == 0);
+  da_dispose(&p);
+  return 0;
+}
+
+//  check : lance les vérifications du module da. Renvoie zéro en cas de
+//    succès, une valeur non nulle sinon.
+static int check(void) {
+  char s[NREFS];
+  char *refs[NREFS];
+  for (size_t k = 0; k < NREFS; ++k) {
+    refs[k] = s + k;
+  }
+  return check_inline(refs) != 0 || check_append(refs) != 0;
+}
+
 int addline(da *p, FILE *filename) {
   int c;
   while ((c = fgetc(filename)) != EOF && c != '\n') {
@@ -37,9 +147,12 @@ int addline(da *p, FILE *filename) {
 }
 
 int main(int argc, char *argv[]) {
-  if (argc < 2){
+  if (check() != 0) {
     return EXIT_FAILURE;
   }
+  if (argc < 2){
+    return EXIT_SUCCESS;
+  }
   int r = EXIT_SUCCESS;
   da *p = da_empty();
   if (p == NULL) {
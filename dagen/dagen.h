@@ -0,0 +1,117 @@
+//  dagen.h : générateur, par macro, de modules spécialisés pour la
+//    spécification d'un tableau dynamique d'éléments d'un type donné.
+
+#ifndef DAGEN__H
+#define DAGEN__H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+//  Fonctionnement général :
+//  - contrairement au module polymorphe da, qui stocke des références de type
+//      « void * », un tableau produit par DAGEN stocke directement des valeurs
+//      du type T. Toutes ses fonctions sont statiques et en ligne : le
+//      compilateur peut les intégrer à l'appelant, puis optimiser ou vectoriser
+//      les boucles qui les utilisent ;
+//  - les ninline premières valeurs sont stockées dans le contrôleur lui-même :
+//      un tableau de longueur au plus ninline ne demande aucune allocation.
+//      Le contrôleur, qui pointe alors sur lui-même, ne doit pas être déplacé
+//      en mémoire entre son initialisation et sa libération ;
+//  - les fonctions qui possèdent un paramètre de type « name * » ont un
+//      comportement indéterminé lorsque ce paramètre n'est pas l'adresse d'un
+//      contrôleur préalablement initialisé par la fonction name_init ;
+//  - les indices passés aux fonctions ne sont pas vérifiés.
+
+//  DAGEN : définit le type name d'un contrôleur de tableau dynamique de
+//    valeurs de type T, dont ninline, strictement positif, sont stockées dans
+//    le contrôleur, ainsi que les fonctions suivantes :
+//
+//    void name_init(name *p) : initialise le tableau associé à p, vide.
+//
+//    void name_dispose(name *p) : libère les ressources allouées à la gestion
+//      du tableau associé à p, qui redevient vide.
+//
+//    int name_add(name *p, T x) : tente d'ajouter x en bout de tableau.
+//      Renvoie une valeur non nulle en cas de dépassement de capacité, zéro
+//      sinon.
+//
+//    int name_reserve(name *p, size_t n) : tente de porter la capacité du
+//      tableau à au moins n. Renvoie une valeur non nulle en cas de
+//      dépassement de capacité, zéro sinon.
+//
+//    size_t name_length(const name *p) : renvoie la longueur du tableau.
+//
+//    T name_get(const name *p, size_t i) : renvoie la valeur d'indice i.
+//
+//    T *name_ref(name *p, size_t i) : renvoie l'adresse de la valeur d'indice
+//      i, valide jusqu'au prochain ajout.
+#define DAGEN(name, T, ninline)                                                \
+                                                                               \
+  typedef struct {                                                             \
+    T *a;                                                                      \
+    size_t length;                                                             \
+    size_t capacity;                                                           \
+    T inl[ninline];                                                            \
+  } name;                                                                      \
+                                                                               \
+  static inline void name##_init(name *p) {                                    \
+    p->a = p->inl;                                                             \
+    p->length = 0;                                                             \
+    p->capacity = (ninline);                                                   \
+  }                                                                            \
+                                                                               \
+  static inline void name##_dispose(name *p) {                                 \
+    if (p->a != p->inl) {                                                      \
+      free(p->a);                                                              \
+    }                                                                          \
+    name##_init(p);                                                            \
+  }                                                                            \
+                                                                               \
+  static inline int name##_reserve(name *p, size_t n) {                        \
+    if (n <= p->capacity) {                                                    \
+      return 0;                                                                \
+    }                                                                          \
+    if (n > SIZE_MAX / sizeof *p->a) {                                         \
+      return -1;                                                               \
+    }                                                                          \
+    T *t;                                                                      \
+    if (p->a == p->inl) {                                                      \
+      if ((t = malloc(n * sizeof *t)) != NULL) {                               \
+        memcpy(t, p->inl, p->length * sizeof *t);                              \
+      }                                                                        \
+    } else {                                                                   \
+      t = realloc(p->a, n * sizeof *t);                                        \
+    }                                                                          \
+    if (t == NULL) {                                                           \
+      return -1;                                                               \
+    }                                                                          \
+    p->a = t;                                                                  \
+    p->capacity = n;                                                           \
+    return 0;                                                                  \
+  }                                                                            \
+                                                                               \
+  static inline int name##_add(name *p, T x) {                                 \
+    if (p->length == p->capacity                                               \
+        && (p->capacity > SIZE_MAX / 2                                         \
+        || name##_reserve(p, 2 * p->capacity) != 0)) {                         \
+      return -1;                                                               \
+    }                                                                          \
+    p->a[p->length] = x;                                                       \
+    p->length += 1;                                                            \
+    return 0;                                                                  \
+  }                                                                            \
+                                                                               \
+  static inline size_t name##_length(const name *p) {                          \
+    return p->length;                                                          \
+  }                                                                            \
+                                                                               \
+  static inline T name##_get(const name *p, size_t i) {                        \
+    return p->a[i];                                                            \
+  }                                                                            \
+                                                                               \
+  static inline T *name##_ref(name *p, size_t i) {                             \
+    return &p->a[i];                                                           \
+  }
+
+#endif
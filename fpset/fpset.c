@@ -0,0 +1,106 @@
+//  fpset.c : partie implantation d'un module pour la spécification d'un
+//    ensemble d'empreintes de 64 bits.
+
+#include <string.h>
+#include "fpset.h"
+
+//  L'ensemble est une table à adressage ouvert et sondage linéaire dont le
+//    nombre d'emplacements est une puissance de 2. L'emplacement initial d'une
+//    empreinte est donné par ses bits de poids faible. La valeur 0 marque un
+//    emplacement libre : l'empreinte 0 est donc stockée comme l'empreinte 1.
+//    La table est doublée dès que son taux de remplissage dépasserait
+//    FPSET__LDFACT_MAX.
+
+#define FPSET__NSLOTS_MIN 1024
+#define FPSET__LDFACT_MAX 0.5
+
+struct fpset {
+  uint64_t *slots;
+  size_t nslots;
+  size_t count;
+};
+
+fpset *fpset_empty(void) {
+  fpset *s = malloc(sizeof *s);
+  if (s == NULL) {
+    return NULL;
+  }
+  s->slots = calloc(FPSET__NSLOTS_MIN, sizeof *s->slots);
+  if (s->slots == NULL) {
+    free(s);
+    return NULL;
+  }
+  s->nslots = FPSET__NSLOTS_MIN;
+  s->count = 0;
+  return s;
+}
+
+void fpset_dispose(fpset **sptr) {
+  if (*sptr == NULL) {
+    return;
+  }
+  free((*sptr)->slots);
+  free(*sptr);
+  *sptr = NULL;
+}
+
+//  fpset__place : renvoie l'adresse de l'emplacement de l'empreinte non nulle
+//    h dans le tableau slots de nslots emplacements, ou celle de l'emplacement
+//    libre où l'ajouter si elle n'y figure pas.
+static uint64_t *fpset__place(uint64_t *slots, size_t nslots, uint64_t h) {
+  size_t i = (size_t) h & (nslots - 1);
+  while (slots[i] != 0 && slots[i] != h) {
+    i = (i + 1) & (nslots - 1);
+  }
+  return &slots[i];
+}
+
+//  fpset__grow : tente de doubler le nombre d'emplacements de s. Renvoie zéro
+//    en cas de succès, une valeur non nulle en cas de dépassement de capacité.
+static int fpset__grow(fpset *s) {
+  if (s->nslots > SIZE_MAX / 2 / sizeof *s->slots) {
+    return -1;
+  }
+  size_t nslots = s->nslots * 2;
+  uint64_t *slots = calloc(nslots, sizeof *slots);
+  if (slots == NULL) {
+    return -1;
+  }
+  for (size_t i = 0; i < s->nslots; ++i) {
+    if (s->slots[i] != 0) {
+      *fpset__place(slots, nslots, s->slots[i]) = s->slots[i];
+    }
+  }
+  free(s->slots);
+  s->slots = slots;
+  s->nslots = nslots;
+  return 0;
+}
+
+int fpset_add(fpset *s, uint64_t h) {
+  h += (h == 0);
+  uint64_t *q = fpset__place(s->slots, s->nslots, h);
+  if (*q != 0) {
+    return 0;
+  }
+  if ((double) (s->count + 1) > FPSET__LDFACT_MAX * (double) s->nslots) {
+    if (fpset__grow(s) != 0) {
+      return -1;
+    }
+    q = fpset__place(s->slots, s->nslots, h);
+  }
+  *q = h;
+  ++s->count;
+  return 1;
+}
+
+size_t fpset_count(const fpset *s) {
+  return s->count;
+}
+
+void fpset_clear(fpset *s) {
+  if (s->count != 0) {
+    memset(s->slots, 0, s->nslots * sizeof *s->slots);
+    s->count = 0;
+  }
+}
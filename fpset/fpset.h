@@ -0,0 +1,51 @@
+//  fpset.h : partie interface d'un module pour la spécification d'un ensemble
+//    d'empreintes de 64 bits.
+
+#ifndef FPSET__H
+#define FPSET__H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+//  Fonctionnement général :
+//  - la structure de données ne stocke ni objets ni références, mais des
+//      empreintes de 64 bits fournies par l'utilisateur, dans des
+//      emplacements de 8 octets dont au plus la moitié sont occupés ;
+//  - deux objets distincts de même empreinte sont confondus : l'utilisateur
+//      choisit des empreintes assez longues et bien distribuées pour que ce
+//      cas soit improbable ;
+//  - les fonctions qui possèdent un paramètre de type « fpset * » ou
+//      « fpset ** » ont un comportement indéterminé lorsque ce paramètre ou sa
+//      déréférence n'est pas l'adresse d'un contrôleur préalablement renvoyée
+//      avec succès par la fonction fpset_empty et non révoquée depuis par la
+//      fonction fpset_dispose.
+
+//  struct fpset, fpset : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer un ensemble d'empreintes.
+typedef struct fpset fpset;
+
+//  fpset_empty : tente d'allouer les ressources nécessaires pour gérer un
+//    nouvel ensemble initialement vide. Renvoie NULL en cas de dépassement de
+//    capacité. Renvoie sinon un pointeur vers le contrôleur associé à
+//    l'ensemble.
+extern fpset *fpset_empty(void);
+
+//  fpset_dispose : sans effet si *sptr vaut NULL. Libère sinon les ressources
+//    allouées à la gestion de l'ensemble associé à *sptr puis affecte NULL à
+//    *sptr.
+extern void fpset_dispose(fpset **sptr);
+
+//  fpset_add : ajoute l'empreinte h à l'ensemble associé à s si elle n'y
+//    figure pas déjà. Renvoie une valeur strictement positive si elle a été
+//    ajoutée, zéro si elle y figurait déjà, une valeur strictement négative en
+//    cas de dépassement de capacité.
+extern int fpset_add(fpset *s, uint64_t h);
+
+//  fpset_count : renvoie le nombre d'empreintes de l'ensemble associé à s.
+extern size_t fpset_count(const fpset *s);
+
+//  fpset_clear : vide l'ensemble associé à s. Les emplacements alloués sont
+//    conservés pour les ajouts suivants.
+extern void fpset_clear(fpset *s);
+
+#endif
@@ -5,20 +5,46 @@
 #include <stdint.h>
 #include "hashtable.h"
 
+#if defined __GLIBC__
+#include <malloc.h>
+#endif
+
+//  HT__REALLOC, HT__FREE : fonctions d'allocation du tableau de hachage. Si la
+//    macroconstante HASHTABLE_HUGEMEM est définie et non nulle, ce tableau,
+//    seule grande zone de la table, est alloué par le module hugemem et peut
+//    ainsi être servi par des pages énormes.
+#if defined HASHTABLE_HUGEMEM && HASHTABLE_HUGEMEM != 0
+#include "hugemem.h"
+#define HT__REALLOC hugemem_realloc
+#define HT__FREE    hugemem_free
+#else
+#define HT__REALLOC realloc
+#define HT__FREE    free
+#endif
+
 //  Le nombre de compartiments du tableau de hachage est une puissance de 2. Il
 //    vaut initialement « 2 ^ HT__LBNSLOTS_MIN ». Dès que le taux de remplissage
 //    de la table de hachage est strictement supérieur à
 //    « (double) HT__LDFACT_MAX_NUMER / (double) HT__LDFACT_MAX_DENOM », le
-//    nombre de compartiments est multiplié par 2.
+//    nombre de compartiments est multiplié par 2. Dès qu'un retrait fait
+//    passer le taux de remplissage strictement au-dessous de
+//    « (double) HT__LDFACT_MIN_NUMER / (double) HT__LDFACT_MIN_DENOM », le
+//    nombre de compartiments, s'il est supérieur à « 2 ^ HT__LBNSLOTS_MIN »,
+//    est divisé par 2. Le seuil minimum est au plus le quart du seuil
+//    maximum : après une division, le taux de remplissage reste éloigné des
+//    deux seuils, ce qui évite d'alterner agrandissements et réductions.
 
 #define HT__LBNSLOTS_MIN      6
 #define HT__LDFACT_MAX_NUMER  1
 #define HT__LDFACT_MAX_DENOM  1
+#define HT__LDFACT_MIN_NUMER  1
+#define HT__LDFACT_MIN_DENOM  8
 
 //  Les définitions précédentes vont pour un nombre de compartiments initial de
-//    64 et un seuil maximum de 1.0 ; ces définitions peuvent être modifiées.
-//    Les directives qui suivent s'assurent de leur cohérence ; ces directives
-//    ne doivent pas être modifiées.
+//    64, un seuil maximum de 1.0 et un seuil minimum de 0.125 ; ces
+//    définitions peuvent être modifiées. Un seuil minimum nul désactive la
+//    réduction. Les directives qui suivent s'assurent de leur cohérence ; ces
+//    directives ne doivent pas être modifiées.
 
 #define HT__NSLOTS_MIN \
   (1ULL << HT__LBNSLOTS_MIN)
@@ -30,13 +56,29 @@
   || HT__LDFACT_MAX_DENOM < 1                                                  \
   || HT__NSLOTS_MIN == 0                                                       \
   || HT__NSLOTS_MIN > SIZE_MAX                                                 \
-  || HT__NENTRIESMAX_MIN == 0
+  || HT__NENTRIESMAX_MIN == 0                                                  \
+  || HT__LDFACT_MIN_NUMER < 0                                                  \
+  || HT__LDFACT_MIN_DENOM < 1                                                  \
+  || 4 * HT__LDFACT_MIN_NUMER * HT__LDFACT_MAX_DENOM                           \
+    > HT__LDFACT_MAX_NUMER * HT__LDFACT_MIN_DENOM
 #error Bad choice of HT__ constants.
 #endif
 
 #undef HT__NSLOTS_MIN
 #undef HT__NENTRIESMAX_MIN
 
+//  HT__BATCH : nombre maximal de recherches menées de front par
+//    hashtable_search_batch. HT__PREFETCH(p) : demande, si le compilateur le
+//    permet, le chargement anticipé en cache de l'objet d'adresse p.
+
+#define HT__BATCH 16
+
+#if defined __GNUC__
+#define HT__PREFETCH(p) __builtin_prefetch(p)
+#else
+#define HT__PREFETCH(p) ((void) (p))
+#endif
+
 //  struct hashtable, hashtable : gestion du chainage séparé par liste dynamique
 //    simplement chainée. Le composant compar mémorise la fonction de
 //    comparaison des clés, hashfun, leur fonction de pré-hachage. Le tableau de
@@ -55,12 +97,20 @@
 //  L'ajout d'une nouvelle entrée a lieu en queue de liste. L'ordre induit est
 //    respecté lors de tout agrandissement du tableau de hachage.
 
+//  Les cellules forment en outre une liste doublement chainée dans l'ordre de
+//    leur ajout, par leurs composants older et newer, dont les extrémités sont
+//    mémorisées par les composants oldest et newest de la table : elle permet
+//    le parcours des couples de la table sans consulter le tableau de hachage
+//    et le retrait d'une cellule en temps constant.
+
 typedef struct cell cell;
 
 struct cell {
   const void *keyref;
   const void *valref;
   cell *next;
+  cell *older;
+  cell *newer;
 };
 
 struct hashtable {
@@ -70,6 +120,8 @@ struct hashtable {
   cell *null;
   size_t lbnslots;
   size_t nfreeentries;
+  cell *oldest;
+  cell *newest;
 };
 
 #define HT__MAKE_BLANK(ht)  ((ht)->hasharray = &(ht)->null)
@@ -81,6 +133,21 @@ struct hashtable {
 #define HASHVAL(__hashfun, __lbnslots, __keyref)                               \
   (__hashfun(__keyref) % POW2(__lbnslots))
 
+//  NENTRIESMAX, NENTRIESMIN : nombres d'entrées associés aux seuils maximum et
+//    minimum pour un tableau de hachage de 2 ^ __lbnslots compartiments.
+#define NENTRIESMAX(__lbnslots)                                                \
+  (POW2(__lbnslots) / HT__LDFACT_MAX_DENOM * HT__LDFACT_MAX_NUMER)
+#define NENTRIESMIN(__lbnslots)                                                \
+  (POW2(__lbnslots) / HT__LDFACT_MIN_DENOM * HT__LDFACT_MIN_NUMER)
+
+//  HT__TRIM : rend au système, si la bibliothèque standard le permet, la
+//    mémoire libérée qui peut l'être.
+#if defined __GLIBC__
+#define HT__TRIM() ((void) malloc_trim(0))
+#else
+#define HT__TRIM() ((void) 0)
+#endif
+
 //  hashtable__search : recherche dans la table de hachage associé à ht une clé
 //    égale à keyref au sens de compar. Renvoie l'adresse du pointeur qui repère
 //    la cellule qui contient cette occurrence si elle existe. Renvoie sinon
@@ -118,7 +185,7 @@ static int hashtable__add_enlarge(hashtable *ht) {
       || (HT__LDFACT_MAX_NUMER > sizeof *a
       && HT__LDFACT_MAX_NUMER > HT__LDFACT_MAX_DENOM
       && m > SIZE_MAX / HT__LDFACT_MAX_NUMER * HT__LDFACT_MAX_DENOM)
-      || (a = realloc(ht->hasharray, m * sizeof *a)) == NULL) {
+      || (a = HT__REALLOC(ht->hasharray, m * sizeof *a)) == NULL) {
     if (b) {
       HT__MAKE_BLANK(ht);
     }
@@ -152,6 +219,31 @@ static int hashtable__add_enlarge(hashtable *ht) {
   return 0;
 }
 
+//  hashtable__shrink : réduit le tableau de hachage de la table de hachage
+//    associée à ht, qui ne doit pas être vierge, à 2 ^ lbm compartiments, où
+//    lbm est strictement inférieur à lbnslots et le nombre d'entrées au plus
+//    NENTRIESMAX(lbm). Les listes sont reconstruites à partir de la liste des
+//    cellules dans l'ordre de leur ajout, ce qui respecte l'ordre induit par
+//    l'ajout en queue de liste. La réduction se fait sur place et ne peut
+//    échouer.
+static void hashtable__shrink(hashtable *ht, size_t lbm) {
+  size_t n = hashtable_count(ht);
+  size_t m = POW2(lbm);
+  cell **a = ht->hasharray;
+  for (size_t k = 0; k < m; ++k) {
+    a[k] = NULL;
+  }
+  for (cell *p = ht->newest; p != NULL; p = p->older) {
+    size_t k = HASHVAL(ht->hashfun, lbm, p->keyref);
+    p->next = a[k];
+    a[k] = p;
+  }
+  cell **b = HT__REALLOC(a, m * sizeof *a);
+  ht->hasharray = (b == NULL ? a : b);
+  ht->lbnslots = lbm;
+  ht->nfreeentries = NENTRIESMAX(lbm) - n;
+}
+
 hashtable *hashtable_empty(int (*compar)(const void *, const void *),
     size_t (*hashfun)(const void *)) {
   hashtable *ht = malloc(sizeof *ht);
@@ -164,6 +256,8 @@ hashtable *hashtable_empty(int (*compar)(const void *, const void *),
   ht->null = NULL;
   ht->lbnslots = 0;
   ht->nfreeentries = 0;
+  ht->oldest = NULL;
+  ht->newest = NULL;
   return ht;
 }
 
@@ -172,16 +266,13 @@ void hashtable_dispose(hashtable **htptr) {
     return;
   }
   if (!HT__IS_BLANK(*htptr)) {
-    size_t m = POW2((*htptr)->lbnslots);
-    for (size_t k = 0; k < m; ++k) {
-      cell *p = (*htptr)->hasharray[k];
-      while (p != NULL) {
-        cell *t = p;
-        p = p->next;
-        free(t);
-      }
+    cell *p = (*htptr)->oldest;
+    while (p != NULL) {
+      cell *t = p;
+      p = p->newer;
+      free(t);
     }
-    free((*htptr)->hasharray);
+    HT__FREE((*htptr)->hasharray);
   }
   free(*htptr);
   *htptr = NULL;
@@ -211,6 +302,10 @@ void *hashtable_add(hashtable *ht, const void *keyref, const void *valref) {
   p->valref = valref;
   p->next = *pp;
   *pp = p;
+  p->older = ht->newest;
+  p->newer = NULL;
+  *(ht->newest == NULL ? &ht->oldest : &ht->newest->newer) = p;
+  ht->newest = p;
   ht->nfreeentries -= 1;
   return (void *) valref;
 }
@@ -223,8 +318,14 @@ void *hashtable_remove(hashtable *ht, const void *keyref) {
   cell *p = *pp;
   const void *r = p->valref;
   *pp = p->next;
+  *(p->older == NULL ? &ht->oldest : &p->older->newer) = p->newer;
+  *(p->newer == NULL ? &ht->newest : &p->newer->older) = p->older;
   free(p);
   ht->nfreeentries += 1;
+  if (ht->lbnslots > HT__LBNSLOTS_MIN
+      && hashtable_count(ht) < NENTRIESMIN(ht->lbnslots)) {
+    hashtable__shrink(ht, ht->lbnslots - 1);
+  }
   return (void *) r;
 }
 
@@ -233,6 +334,94 @@ void *hashtable_search(hashtable *ht, const void *keyref) {
   return p == NULL ? NULL : (void *) p->valref;
 }
 
+void hashtable_search_batch(hashtable *ht, const void * const *keyrefs,
+    size_t n, void **valrefs) {
+  cell * const *pp[HT__BATCH];
+  for (size_t j = 0; j < n; j += HT__BATCH) {
+    size_t m = (n - j < HT__BATCH ? n - j : HT__BATCH);
+    for (size_t k = 0; k < m; ++k) {
+      size_t h = HASHVAL(ht->hashfun, ht->lbnslots, keyrefs[j + k]);
+      pp[k] = &ht->hasharray[h];
+      HT__PREFETCH(pp[k]);
+    }
+    for (size_t k = 0; k < m; ++k) {
+      if (*pp[k] != NULL) {
+        HT__PREFETCH(*pp[k]);
+      }
+    }
+    for (size_t k = 0; k < m; ++k) {
+      if (*pp[k] != NULL) {
+        HT__PREFETCH((*pp[k])->keyref);
+      }
+    }
+    for (size_t k = 0; k < m; ++k) {
+      cell * const *q = pp[k];
+      while (*q != NULL && ht->compar(keyrefs[j + k], (*q)->keyref) != 0) {
+        q = &(*q)->next;
+      }
+      valrefs[j + k] = (*q == NULL ? NULL : (void *) (*q)->valref);
+    }
+  }
+}
+
+size_t hashtable_count(hashtable *ht) {
+  if (HT__IS_BLANK(ht)) {
+    return 0;
+  }
+  return NENTRIESMAX(ht->lbnslots) - ht->nfreeentries;
+}
+
+void hashtable_compact(hashtable *ht) {
+  if (!HT__IS_BLANK(ht)) {
+    size_t n = hashtable_count(ht);
+    if (n == 0) {
+      HT__FREE(ht->hasharray);
+      HT__MAKE_BLANK(ht);
+      ht->lbnslots = 0;
+      ht->nfreeentries = 0;
+    } else {
+      size_t lbm = HT__LBNSLOTS_MIN;
+      while (NENTRIESMAX(lbm) < n) {
+        ++lbm;
+      }
+      if (lbm < ht->lbnslots) {
+        hashtable__shrink(ht, lbm);
+      }
+    }
+  }
+  HT__TRIM();
+}
+
+int hashtable_apply(hashtable *ht, void *context,
+    int (*fun)(void *context, const void *keyref, void *valref)) {
+  for (const cell *p = ht->oldest; p != NULL; p = p->newer) {
+    int r = fun(context, p->keyref, (void *) p->valref);
+    if (r != 0) {
+      return r;
+    }
+  }
+  return 0;
+}
+
+int hashtable_apply_reverse(hashtable *ht, void *context,
+    int (*fun)(void *context, const void *keyref, void *valref)) {
+  for (const cell *p = ht->newest; p != NULL; p = p->older) {
+    int r = fun(context, p->keyref, (void *) p->valref);
+    if (r != 0) {
+      return r;
+    }
+  }
+  return 0;
+}
+
+size_t hashtable_str_hashfun(const void *s) {
+  size_t h = 0;
+  for (const unsigned char *p = s; *p != '\0'; ++p) {
+    h = 37 * h + *p;
+  }
+  return h;
+}
+
 #if defined HASHTABLE_STATS && HASHTABLE_STATS != 0
 
 void hashtable_get_stats(hashtable *ht,
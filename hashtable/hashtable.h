@@ -74,6 +74,45 @@ extern void *hashtable_remove(hashtable *ht, const void *keyref);
 //    référence de la valeur correspondante sinon.
 extern void *hashtable_search(hashtable *ht, const void *keyref);
 
+//  hashtable_search_batch : affecte à valrefs[i], pour tout i < n, la valeur
+//    que renverrait hashtable_search(ht, keyrefs[i]). Les n recherches sont
+//    menées de front : les têtes de listes des compartiments puis les
+//    premières cellules et leurs clés sont préchargées pour toutes les clés
+//    avant d'être consultées, de sorte que les défauts de cache des différentes
+//    recherches se recouvrent au lieu de s'additionner.
+extern void hashtable_search_batch(hashtable *ht, const void * const *keyrefs,
+    size_t n, void **valrefs);
+
+//  hashtable_count : renvoie le nombre de clés de la table de hachage associée
+//    à ht.
+extern size_t hashtable_count(hashtable *ht);
+
+//  hashtable_compact : réduit les ressources allouées à la gestion de la table
+//    de hachage associée à ht au minimum compatible avec son nombre de clés,
+//    puis rend au système, si la bibliothèque standard le permet, la mémoire
+//    libérée qui peut l'être. Les retraits réduisent déjà la table lorsque son
+//    taux de remplissage devient trop faible ; cette fonction est destinée à
+//    être appelée à l'issue d'une série de retraits.
+extern void hashtable_compact(hashtable *ht);
+
+//  hashtable_apply, hashtable_apply_reverse : parcourt la table de hachage
+//    associée à ht en appelant fun(context, keyref, valref) pour chacun de ses
+//    couples (keyref, valref), dans l'ordre de leur ajout ou dans l'ordre
+//    inverse. Le remplacement d'une valeur par hashtable_add ne modifie pas la
+//    place du couple. Si, lors du parcours, la valeur de l'appel n'est pas
+//    nulle, l'exécution de la fonction prend fin et la fonction renvoie cette
+//    valeur. Sinon, la fonction renvoie zéro. La table ne doit pas être
+//    modifiée par fun.
+extern int hashtable_apply(hashtable *ht, void *context,
+    int (*fun)(void *context, const void *keyref, void *valref));
+extern int hashtable_apply_reverse(hashtable *ht, void *context,
+    int (*fun)(void *context, const void *keyref, void *valref));
+
+//  hashtable_str_hashfun : fonction de pré-hachage des chaînes de caractères,
+//    l'une de celles conseillées par Kernighan et Pike, à passer à
+//    hashtable_empty lorsque les clés sont des chaînes de caractères.
+extern size_t hashtable_str_hashfun(const void *s);
+
 #if defined HASHTABLE_STATS && HASHTABLE_STATS != 0
 
 #include <stdio.h>
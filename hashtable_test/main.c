@@ -0,0 +1,256 @@
+//  Vérifications du module hashtable : ajouts, retraits, réduction du tableau
+//    de hachage et son hystérésis, compactage, ordre des parcours.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "hashtable.h"
+
+//  CHECK : signale sur la sortie erreur l'échec de la condition cond et
+//    abandonne la fonction en cours en renvoyant -1.
+#define CHECK(cond)                                                            \
+  if (!(cond)) {                                                               \
+    fprintf(stderr, "*** Check failed: %s:%d: %s\n", __func__, __LINE__,      \
+        #cond);                                                                \
+    return -1;                                                                 \
+  }
+
+//  NKEYS : nombre de clés utilisées par les vérifications.
+#define NKEYS 1000
+
+//  NSLOTS_MIN : nombre de compartiments initial d'une table de hachage.
+#define NSLOTS_MIN 64
+
+static int int_compar(const void *a, const void *b) {
+  int x = *(const int *) a;
+  int y = *(const int *) b;
+  return (x > y) - (x < y);
+}
+
+static size_t int_hashfun(const void *a) {
+  return (size_t) *(const int *) a;
+}
+
+//  nslots : renvoie le nombre de compartiments de la table de hachage associée
+//    à ht, nul si son tableau de hachage n'est pas alloué.
+static size_t nslots(hashtable *ht) {
+  struct hashtable_stats hts;
+  hashtable_get_stats(ht, &hts);
+  return hts.nslots;
+}
+
+//  struct trace : suite des clés rencontrées lors d'un parcours, arrêté à la
+//    clé stop si stop ne vaut pas NULL.
+struct trace {
+  const int *keys[NKEYS];
+  size_t n;
+  const int *stop;
+};
+
+static int trace_record(void *context, const void *keyref, void *valref) {
+  struct trace *t = context;
+  if (valref != keyref) {
+    return -1;
+  }
+  t->keys[t->n] = keyref;
+  t->n += 1;
+  return keyref == t->stop ? 1 : 0;
+}
+
+//  check_order : vérifie que les parcours de la table de hachage associée à ht
+//    rencontrent les clés de keys d'indices multiples de step, dans l'ordre
+//    puis dans l'ordre inverse.
+static int check_order(hashtable *ht, int *keys, size_t step) {
+  struct trace t = {
+    .n = 0, .stop = NULL,
+  };
+  CHECK(hashtable_apply(ht, &t, trace_record) == 0);
+  CHECK(t.n == hashtable_count(ht));
+  for (size_t k = 0; k < t.n; ++k) {
+    CHECK(t.keys[k] == &keys[k * step]);
+  }
+  t.n = 0;
+  CHECK(hashtable_apply_reverse(ht, &t, trace_record) == 0);
+  CHECK(t.n == hashtable_count(ht));
+  for (size_t k = 0; k < t.n; ++k) {
+    CHECK(t.keys[t.n - 1 - k] == &keys[k * step]);
+  }
+  return 0;
+}
+
+//  check_add : vérifie les ajouts, les remplacements, les recherches et l'ordre
+//    des parcours.
+static int check_add(int *keys) {
+  hashtable *ht = hashtable_empty(int_compar, int_hashfun);
+  CHECK(ht != NULL);
+  CHECK(hashtable_count(ht) == 0);
+  CHECK(hashtable_search(ht, &keys[0]) == NULL);
+  CHECK(hashtable_remove(ht, &keys[0]) == NULL);
+  CHECK(hashtable_add(ht, &keys[0], NULL) == NULL);
+  CHECK(hashtable_count(ht) == 0);
+  for (size_t k = 0; k < NKEYS; ++k) {
+    CHECK(hashtable_add(ht, &keys[k], &keys[1]) == &keys[1]);
+  }
+  CHECK(hashtable_count(ht) == NKEYS);
+  //  Un remplacement renvoie l'ancienne valeur et laisse le couple en place.
+  for (size_t k = 0; k < NKEYS; ++k) {
+    int x = keys[k];
+    CHECK(hashtable_add(ht, &x, &keys[k]) == &keys[1]);
+    CHECK(hashtable_search(ht, &x) == &keys[k]);
+  }
+  CHECK(hashtable_count(ht) == NKEYS);
+  CHECK(check_order(ht, keys, 1) == 0);
+  const void *batch[NKEYS];
+  void *found[NKEYS];
+  for (size_t k = 0; k < NKEYS; ++k) {
+    batch[k] = &keys[NKEYS - 1 - k];
+  }
+  hashtable_search_batch(ht, batch, NKEYS, found);
+  for (size_t k = 0; k < NKEYS; ++k) {
+    CHECK(found[k] == batch[k]);
+  }
+  //  Arrêt d'un parcours sur une valeur non nulle.
+  struct trace t = {
+    .n = 0, .stop = &keys[9],
+  };
+  CHECK(hashtable_apply(ht, &t, trace_record) == 1);
+  CHECK(t.n == 10);
+  t.n = 0;
+  CHECK(hashtable_apply_reverse(ht, &t, trace_record) == 1);
+  CHECK(t.n == NKEYS - 9);
+  hashtable_dispose(&ht);
+  CHECK(ht == NULL);
+  hashtable_dispose(&ht);
+  return 0;
+}
+
+//  check_remove : vérifie les retraits, la réduction du tableau de hachage
+//    au-dessous du seuil minimum mais pas avant, et l'ordre des parcours après
+//    retraits et réductions.
+static int check_remove(int *keys) {
+  hashtable *ht = hashtable_empty(int_compar, int_hashfun);
+  CHECK(ht != NULL);
+  for (size_t k = 0; k < NKEYS; ++k) {
+    CHECK(hashtable_add(ht, &keys[k], &keys[k]) != NULL);
+  }
+  CHECK(nslots(ht) == 1024);
+  //  Retrait des clés d'indices impairs, puis des clés d'indices non multiples
+  //    de 4.
+  for (size_t k = 1; k < NKEYS; k += 2) {
+    CHECK(hashtable_remove(ht, &keys[k]) == &keys[k]);
+    CHECK(hashtable_remove(ht, &keys[k]) == NULL);
+  }
+  CHECK(hashtable_count(ht) == NKEYS / 2);
+  CHECK(nslots(ht) == 1024);
+  CHECK(check_order(ht, keys, 2) == 0);
+  for (size_t k = 2; k < NKEYS; k += 4) {
+    CHECK(hashtable_remove(ht, &keys[k]) == &keys[k]);
+  }
+  CHECK(hashtable_count(ht) == NKEYS / 4);
+  CHECK(check_order(ht, keys, 4) == 0);
+  //  Réduction dès que le nombre de clés passe au-dessous du huitième du
+  //    nombre de compartiments.
+  size_t n = NKEYS / 4;
+  while (n > 1024 / 8) {
+    --n;
+    CHECK(hashtable_remove(ht, &keys[4 * n]) == &keys[4 * n]);
+    CHECK(nslots(ht) == 1024);
+  }
+  --n;
+  CHECK(hashtable_remove(ht, &keys[4 * n]) == &keys[4 * n]);
+  CHECK(hashtable_count(ht) == 1024 / 8 - 1);
+  CHECK(nslots(ht) == 512);
+  CHECK(check_order(ht, keys, 4) == 0);
+  for (size_t k = 0; k < n; ++k) {
+    CHECK(hashtable_search(ht, &keys[4 * k]) == &keys[4 * k]);
+  }
+  //  Hystérésis : ni les ajouts jusqu'au seuil maximum, ni les retraits
+  //    jusqu'au seuil minimum ne modifient plus le nombre de compartiments.
+  size_t j = 1;
+  for (; n < 512; ++n, j += 2) {
+    CHECK(hashtable_add(ht, &keys[j], &keys[j]) != NULL);
+    CHECK(nslots(ht) == 512);
+  }
+  CHECK(hashtable_add(ht, &keys[j], &keys[j]) != NULL);
+  CHECK(nslots(ht) == 1024);
+  hashtable_dispose(&ht);
+  ht = hashtable_empty(int_compar, int_hashfun);
+  CHECK(ht != NULL);
+  for (size_t k = 0; k < 512; ++k) {
+    CHECK(hashtable_add(ht, &keys[k], &keys[k]) != NULL);
+  }
+  CHECK(nslots(ht) == 512);
+  for (size_t k = 512; k > 512 / 8; --k) {
+    CHECK(hashtable_remove(ht, &keys[k - 1]) != NULL);
+    CHECK(nslots(ht) == 512);
+  }
+  CHECK(hashtable_remove(ht, &keys[512 / 8 - 1]) != NULL);
+  CHECK(nslots(ht) == 256);
+  //  Jamais au-dessous du nombre de compartiments initial.
+  for (size_t k = 512 / 8 - 1; k > 0; --k) {
+    CHECK(hashtable_remove(ht, &keys[k - 1]) != NULL);
+    CHECK(nslots(ht) >= NSLOTS_MIN);
+  }
+  CHECK(hashtable_count(ht) == 0);
+  CHECK(nslots(ht) == NSLOTS_MIN);
+  hashtable_dispose(&ht);
+  return 0;
+}
+
+//  check_compact : vérifie le compactage d'une table réduite par des retraits,
+//    puis d'une table vidée, et les ajouts qui suivent.
+static int check_compact(int *keys) {
+  hashtable *ht = hashtable_empty(int_compar, int_hashfun);
+  CHECK(ht != NULL);
+  hashtable_compact(ht);
+  CHECK(nslots(ht) == 0);
+  for (size_t k = 0; k < NKEYS; ++k) {
+    CHECK(hashtable_add(ht, &keys[k], &keys[k]) != NULL);
+  }
+  for (size_t k = 200; k < NKEYS; ++k) {
+    CHECK(hashtable_remove(ht, &keys[k]) != NULL);
+  }
+  CHECK(nslots(ht) == 1024);
+  hashtable_compact(ht);
+  CHECK(nslots(ht) == 256);
+  CHECK(hashtable_count(ht) == 200);
+  CHECK(check_order(ht, keys, 1) == 0);
+  for (size_t k = 0; k < 200; ++k) {
+    CHECK(hashtable_remove(ht, &keys[k]) != NULL);
+  }
+  hashtable_compact(ht);
+  CHECK(hashtable_count(ht) == 0);
+  CHECK(nslots(ht) == 0);
+  CHECK(hashtable_search(ht, &keys[0]) == NULL);
+  CHECK(check_order(ht, keys, 1) == 0);
+  for (size_t k = NKEYS; k > 0; --k) {
+    CHECK(hashtable_add(ht, &keys[k - 1], &keys[k - 1]) != NULL);
+  }
+  CHECK(hashtable_count(ht) == NKEYS);
+  CHECK(nslots(ht) == 1024);
+  for (size_t k = 0; k < NKEYS; ++k) {
+    CHECK(hashtable_search(ht, &keys[k]) == &keys[k]);
+  }
+  struct trace t = {
+    .n = 0, .stop = NULL,
+  };
+  CHECK(hashtable_apply_reverse(ht, &t, trace_record) == 0);
+  for (size_t k = 0; k < NKEYS; ++k) {
+    CHECK(t.keys[k] == &keys[k]);
+  }
+  hashtable_dispose(&ht);
+  return 0;
+}
+
+int main(void) {
+  static int keys[NKEYS];
+  //  Clés distinctes, qui ne sont pas ajoutées dans l'ordre de leurs valeurs
+  //    de hachage.
+  for (size_t k = 0; k < NKEYS; ++k) {
+    keys[k] = (int) (k * 7919 % 100003);
+  }
+  if (check_add(keys) != 0 || check_remove(keys) != 0
+      || check_compact(keys) != 0) {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
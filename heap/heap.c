@@ -0,0 +1,106 @@
+//  heap.c : partie implantation d'un module pour la spécification d'un tas
+//    binaire de capacité bornée.
+
+#include <stdint.h>
+#include "heap.h"
+
+//  struct heap : le tas est un tableau de capacity références dont les count
+//    premières vérifient la propriété de tas minimum : la référence d'indice k
+//    n'est pas plus grande que celles d'indices 2k + 1 et 2k + 2.
+struct heap {
+  int (*compar)(const void *, const void *);
+  size_t capacity;
+  size_t count;
+  void **refs;
+};
+
+heap *heap_empty(size_t capacity,
+    int (*compar)(const void *, const void *)) {
+  if (capacity == 0 || capacity > SIZE_MAX / sizeof(void *)) {
+    return NULL;
+  }
+  heap *h = malloc(sizeof *h);
+  if (h == NULL) {
+    return NULL;
+  }
+  h->refs = malloc(capacity * sizeof *h->refs);
+  if (h->refs == NULL) {
+    free(h);
+    return NULL;
+  }
+  h->compar = compar;
+  h->capacity = capacity;
+  h->count = 0;
+  return h;
+}
+
+void heap_dispose(heap **hptr) {
+  if (*hptr == NULL) {
+    return;
+  }
+  free((*hptr)->refs);
+  free(*hptr);
+  *hptr = NULL;
+}
+
+//  heap__up, heap__down : rétablissent la propriété de tas à partir de
+//    l'indice k en faisant remonter (resp. descendre) la référence qui s'y
+//    trouve.
+
+static void heap__up(heap *h, size_t k) {
+  void *ref = h->refs[k];
+  while (k > 0 && h->compar(ref, h->refs[(k - 1) / 2]) < 0) {
+    h->refs[k] = h->refs[(k - 1) / 2];
+    k = (k - 1) / 2;
+  }
+  h->refs[k] = ref;
+}
+
+static void heap__down(heap *h, size_t k) {
+  void *ref = h->refs[k];
+  while (2 * k + 1 < h->count) {
+    size_t c = 2 * k + 1;
+    if (c + 1 < h->count && h->compar(h->refs[c + 1], h->refs[c]) < 0) {
+      ++c;
+    }
+    if (h->compar(h->refs[c], ref) >= 0) {
+      break;
+    }
+    h->refs[k] = h->refs[c];
+    k = c;
+  }
+  h->refs[k] = ref;
+}
+
+void *heap_offer(heap *h, void *ref) {
+  if (h->count < h->capacity) {
+    h->refs[h->count] = ref;
+    h->count += 1;
+    heap__up(h, h->count - 1);
+    return NULL;
+  }
+  if (h->compar(ref, h->refs[0]) <= 0) {
+    return ref;
+  }
+  void *min = h->refs[0];
+  h->refs[0] = ref;
+  heap__down(h, 0);
+  return min;
+}
+
+size_t heap_count(heap *h) {
+  return h->count;
+}
+
+void *heap_pop(heap *h) {
+  if (h->count == 0) {
+    return NULL;
+  }
+  void *min = h->refs[0];
+  h->count -= 1;
+  if (h->count > 0) {
+    h->refs[0] = h->refs[h->count];
+    heap__down(h, 0);
+  }
+  return min;
+}
@@ -0,0 +1,59 @@
+//  heap.h : partie interface d'un module pour la spécification d'un tas
+//    binaire de capacité bornée.
+
+#ifndef HEAP__H
+#define HEAP__H
+
+#include <stdlib.h>
+
+//  Fonctionnement général :
+//  - la structure de données ne stocke pas d'objets mais des références vers
+//      ces objets. Les références sont du type générique « void * » ;
+//  - la structure de données conserve, parmi les références qui lui sont
+//      proposées, les capacity plus grandes au sens d'une fonction de
+//      comparaison fournie à la création. Sa taille ne dépend que de sa
+//      capacité, et non du nombre de références proposées ;
+//  - la plus petite des références conservées est accessible en temps
+//      constant, ajout et retrait se font en temps logarithmique ;
+//  - si des opérations d'allocation dynamique sont effectuées, elles le sont
+//      pour la gestion propre de la structure de données, et en aucun cas pour
+//      réaliser des copies ou des destructions d'objets ;
+//  - les fonctions qui possèdent un paramètre de type « heap * » ou
+//      « heap ** » ont un comportement indéterminé lorsque ce paramètre ou sa
+//      déréférence n'est pas l'adresse d'un contrôleur préalablement renvoyée
+//      avec succès par la fonction heap_empty et non révoquée depuis par la
+//      fonction heap_dispose ;
+//  - aucune fonction ne peut ajouter NULL à la structure de données.
+
+//  struct heap, heap : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer un tas de capacité bornée.
+typedef struct heap heap;
+
+//  heap_empty : tente d'allouer les ressources nécessaires pour gérer un
+//    nouveau tas initialement vide de capacité capacity, non nulle. La
+//    fonction de comparaison des objets via leurs références est pointée par
+//    compar. Renvoie NULL en cas de dépassement de capacité. Renvoie sinon un
+//    pointeur vers le contrôleur associé au tas.
+extern heap *heap_empty(size_t capacity,
+    int (*compar)(const void *, const void *));
+
+//  heap_dispose : sans effet si *hptr vaut NULL. Libère sinon les ressources
+//    allouées à la gestion du tas associé à *hptr puis affecte NULL à *hptr.
+extern void heap_dispose(heap **hptr);
+
+//  heap_offer : propose la référence ref au tas associé à h. Si le tas n'est
+//    pas plein, ajoute ref au tas et renvoie NULL. Sinon, si l'objet pointé par
+//    ref est strictement plus grand que le plus petit des objets du tas,
+//    remplace la référence de ce dernier par ref et la renvoie. Sinon, renvoie
+//    ref. La référence renvoyée, qui ne figure pas dans le tas, peut être
+//    réutilisée par l'utilisateur.
+extern void *heap_offer(heap *h, void *ref);
+
+//  heap_count : renvoie le nombre de références du tas associé à h.
+extern size_t heap_count(heap *h);
+
+//  heap_pop : renvoie NULL si le tas associé à h est vide. Retire sinon du tas
+//    la référence du plus petit de ses objets et la renvoie.
+extern void *heap_pop(heap *h);
+
+#endif
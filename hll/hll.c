@@ -0,0 +1,81 @@
+//  hll.c : partie implantation d'un module pour l'estimation du nombre de
+//    valeurs distinctes d'un flot de valeurs de hachage de 64 bits par la
+//    méthode HyperLogLog.
+
+#include <string.h>
+#include <math.h>
+#include "hll.h"
+
+//  Les p bits de poids fort d'une valeur de hachage désignent son registre ;
+//    les 64 - p autres donnent son rang, position de leur premier bit à 1 en
+//    partant du poids fort, comptée à partir de 1, ou 64 - p + 1 s'ils sont
+//    tous nuls. L'estimation est la moyenne harmonique des 2^rang des
+//    registres, corrigée par le coefficient de Flajolet et al. ; tant qu'elle
+//    reste petite devant le nombre de registres et que certains sont encore
+//    nuls, le comptage linéaire des registres nuls est plus précis et lui est
+//    substitué.
+
+struct hll {
+  unsigned int p;
+  size_t m;
+  uint8_t *reg;
+};
+
+hll *hll_empty(unsigned int p) {
+  if (p < HLL_PMIN || p > HLL_PMAX) {
+    return NULL;
+  }
+  hll *s = malloc(sizeof *s);
+  if (s == NULL) {
+    return NULL;
+  }
+  s->p = p;
+  s->m = (size_t) 1 << p;
+  s->reg = calloc(s->m, sizeof *s->reg);
+  if (s->reg == NULL) {
+    free(s);
+    return NULL;
+  }
+  return s;
+}
+
+void hll_dispose(hll **hptr) {
+  if (*hptr == NULL) {
+    return;
+  }
+  free((*hptr)->reg);
+  free(*hptr);
+  *hptr = NULL;
+}
+
+void hll_add(hll *s, uint64_t h) {
+  size_t j = (size_t) (h >> (64 - s->p));
+  uint64_t w = h << s->p;
+  uint8_t rank = 1;
+  while (rank <= 64 - s->p && (w & ((uint64_t) 1 << 63)) == 0) {
+    w <<= 1;
+    ++rank;
+  }
+  if (rank > s->reg[j]) {
+    s->reg[j] = rank;
+  }
+}
+
+void hll_clear(hll *s) {
+  memset(s->reg, 0, s->m * sizeof *s->reg);
+}
+
+uint64_t hll_estimate(const hll *s) {
+  double m = (double) s->m;
+  double sum = 0.0;
+  size_t zeros = 0;
+  for (size_t j = 0; j < s->m; ++j) {
+    sum += ldexp(1.0, -s->reg[j]);
+    zeros += (s->reg[j] == 0);
+  }
+  double e = 0.7213 / (1.0 + 1.079 / m) * m * m / sum;
+  if (e <= 2.5 * m && zeros != 0) {
+    e = m * log(m / (double) zeros);
+  }
+  return (uint64_t) (e + 0.5);
+}
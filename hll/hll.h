@@ -0,0 +1,56 @@
+//  hll.h : partie interface d'un module pour l'estimation du nombre de valeurs
+//    distinctes d'un flot de valeurs de hachage de 64 bits par la méthode
+//    HyperLogLog.
+
+#ifndef HLL__H
+#define HLL__H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+//  Fonctionnement général :
+//  - la structure de données ne stocke ni objets ni références, mais, pour
+//      chacun de ses 2^p registres, le plus grand rang du premier bit à 1
+//      observé parmi les valeurs de hachage qui lui sont attribuées. Sa taille,
+//      de 2^p octets, ne dépend pas du nombre de valeurs ajoutées ;
+//  - l'estimation du nombre de valeurs distinctes ajoutées a une erreur
+//      relative type de l'ordre de 1,04 / racine(2^p), soit 1,6 % pour p = 12.
+//      Elle suppose que tous les bits des valeurs de hachage sont bien
+//      distribués ;
+//  - les fonctions qui possèdent un paramètre de type « hll * » ou « hll ** »
+//      ont un comportement indéterminé lorsque ce paramètre ou sa déréférence
+//      n'est pas l'adresse d'un contrôleur préalablement renvoyée avec succès
+//      par la fonction hll_empty et non révoquée depuis par la fonction
+//      hll_dispose.
+
+//  HLL_PMIN, HLL_PMAX : bornes de la précision p acceptée par hll_empty.
+#define HLL_PMIN 4
+#define HLL_PMAX 18
+
+//  struct hll, hll : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer un estimateur HyperLogLog.
+typedef struct hll hll;
+
+//  hll_empty : tente d'allouer les ressources nécessaires pour gérer un nouvel
+//    estimateur de précision p, initialement vide. Renvoie NULL si p n'est pas
+//    compris entre HLL_PMIN et HLL_PMAX ou en cas de dépassement de capacité.
+//    Renvoie sinon un pointeur vers le contrôleur associé à l'estimateur.
+extern hll *hll_empty(unsigned int p);
+
+//  hll_dispose : sans effet si *hptr vaut NULL. Libère sinon les ressources
+//    allouées à la gestion de l'estimateur associé à *hptr puis affecte NULL à
+//    *hptr.
+extern void hll_dispose(hll **hptr);
+
+//  hll_add : ajoute la valeur de hachage h à l'estimateur associé à s.
+extern void hll_add(hll *s, uint64_t h);
+
+//  hll_clear : vide l'estimateur associé à s.
+extern void hll_clear(hll *s);
+
+//  hll_estimate : renvoie une estimation du nombre de valeurs distinctes
+//    ajoutées à l'estimateur associé à s depuis sa création ou son dernier
+//    vidage.
+extern uint64_t hll_estimate(const hll *s);
+
+#endif
@@ -0,0 +1,352 @@
+//  htgen.h : générateur, par macro, de modules spécialisés pour la
+//    spécification d'une table de hachage de clés et de valeurs de types
+//    donnés.
+
+#ifndef HTGEN__H
+#define HTGEN__H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+
+//  Fonctionnement général :
+//  - contrairement au module polymorphe hashtable, qui appelle les fonctions
+//      de comparaison et de pré-hachage des clés par des pointeurs, une table
+//      produite par HTGEN les reçoit comme noms de fonctions ou de macros :
+//      elles sont intégrées aux fonctions de la table, toutes statiques et en
+//      ligne ;
+//  - la table range ses entrées, couples de clé de type K et de valeur de
+//      type V accompagnés de la valeur de pré-hachage de la clé, dans un
+//      tableau, dans l'ordre de leur ajout, ce qui permet de les parcourir
+//      dans cet ordre ou dans l'ordre inverse. Les clés ne sont comparées que
+//      si leurs valeurs de pré-hachage sont égales et ne sont jamais
+//      pré-hachées à nouveau lors d'un agrandissement ;
+//  - les entrées sont repérées par un tableau d'emplacements de 8 octets, à
+//      adressage ouvert et sondage linéaire. Son nombre d'emplacements,
+//      puissance de 2, est doublé dès que plus de la moitié serait occupée.
+//      L'emplacement initial d'une clé est obtenu par hachage de Fibonacci de
+//      sa valeur de pré-hachage, ce qui répartit même les valeurs dont les
+//      bits de poids faible sont mal distribués. Le nombre de clés est limité
+//      à UINT32_MAX ;
+//  - la table ne fait aucune copie des clés : si K est un type pointeur, les
+//      objets pointés doivent survivre à leur présence dans la table ;
+//  - les fonctions qui possèdent un paramètre de type « name * » ont un
+//      comportement indéterminé lorsque ce paramètre n'est pas l'adresse d'un
+//      contrôleur préalablement initialisé par la fonction name_init.
+
+//  HTGEN__LBNSLOTS_MIN : logarithme binaire du nombre d'emplacements alloués au
+//    premier ajout.
+#define HTGEN__LBNSLOTS_MIN 6
+
+//  HTGEN__BATCH : nombre maximal de recherches menées de front par
+//    name_search_batch. HTGEN__PREFETCH(p) : demande, si le compilateur le
+//    permet, le chargement anticipé en cache de l'objet d'adresse p.
+#define HTGEN__BATCH 16
+
+#if defined __GNUC__
+#define HTGEN__PREFETCH(p) __builtin_prefetch(p)
+#else
+#define HTGEN__PREFETCH(p) ((void) (p))
+#endif
+
+//  HTGEN_CALLOC, HTGEN_REALLOC, HTGEN_FREE : fonctions d'allocation des
+//    tableaux des tables, de mêmes spécifications que calloc, realloc et free.
+//    L'utilisateur peut les redéfinir avant l'inclusion de cet en-tête pour
+//    servir ces tableaux par un autre allocateur.
+#if !defined HTGEN_CALLOC
+#define HTGEN_CALLOC calloc
+#endif
+
+#if !defined HTGEN_REALLOC
+#define HTGEN_REALLOC realloc
+#endif
+
+#if !defined HTGEN_FREE
+#define HTGEN_FREE free
+#endif
+
+//  HTGEN : définit le type name d'un contrôleur de table de hachage de clés de
+//    type K et de valeurs de type V, où hashfun(k) renvoie la valeur de
+//    pré-hachage de type size_t de la clé k et equal(k1, k2) une valeur non
+//    nulle si et seulement si les clés k1 et k2 sont égales, ainsi que les
+//    fonctions suivantes :
+//
+//    void name_init(name *t) : initialise la table associée à t, vide. Ne
+//      demande aucune allocation.
+//
+//    void name_dispose(name *t) : libère les ressources allouées à la gestion
+//      de la table associée à t, qui redevient vide.
+//
+//    V *name_search(const name *t, K key) : renvoie l'adresse de la valeur
+//      associée à une clé égale à key, valide jusqu'au prochain ajout, ou NULL
+//      si aucune ne l'est.
+//
+//    void name_search_batch(const name *t, const K *keys, size_t n,
+//      V **vals) : affecte à vals[i], pour tout i < n, la valeur que
+//      renverrait name_search(t, keys[i]). Les emplacements initiaux des n
+//      clés puis les entrées qu'ils repèrent sont préchargés avant d'être
+//      consultés, de sorte que les défauts de cache des différentes recherches
+//      se recouvrent.
+//
+//    int name_add(name *t, K key, V val) : associe val à key, en remplaçant
+//      l'éventuelle valeur associée à une clé égale. Renvoie une valeur non
+//      nulle en cas de dépassement de capacité, zéro sinon.
+//
+//    size_t name_count(const name *t) : renvoie le nombre de clés.
+//
+//    void name_retain(name *t, void *context, int (*keep)(void *, K, V)) :
+//      retire de la table associée à t les couples (key, val) pour lesquels
+//      keep(context, key, val) renvoie zéro, appelée une fois pour chaque
+//      couple dans l'ordre de leur ajout, qui est préservé pour les couples
+//      conservés. keep peut libérer les ressources des couples qu'elle
+//      écarte mais ne doit pas modifier la table. Réduit ensuite les
+//      tableaux de la table à la mesure des clés restantes. Les adresses
+//      obtenues par name_search deviennent invalides.
+//
+//    int name_apply(const name *t, void *context, int (*fun)(void *, K, V)),
+//    int name_apply_reverse(const name *t, void *context,
+//      int (*fun)(void *, K, V)) : parcourt la table associée à t en appelant
+//      fun(context, key, val) pour chacun de ses couples (key, val), dans
+//      l'ordre de leur ajout ou dans l'ordre inverse. Si, lors du parcours, la
+//      valeur de l'appel n'est pas nulle, l'exécution de la fonction prend fin
+//      et la fonction renvoie cette valeur. Sinon, la fonction renvoie zéro.
+//      La table ne doit pas être modifiée par fun.
+#define HTGEN(name, K, V, hashfun, equal)                                      \
+                                                                               \
+  typedef struct {                                                             \
+    size_t tag;                                                                \
+    K key;                                                                     \
+    V val;                                                                     \
+  } name##_entry;                                                              \
+                                                                               \
+  typedef struct {                                                             \
+    uint32_t tag;                                                              \
+    uint32_t pos;                                                              \
+  } name##__slot;                                                              \
+                                                                               \
+  typedef struct {                                                             \
+    name##_entry *entries;                                                     \
+    name##__slot *slots;                                                       \
+    size_t lbnslots;                                                           \
+    size_t count;                                                              \
+    size_t capacity;                                                           \
+  } name;                                                                      \
+                                                                               \
+  static inline void name##_init(name *t) {                                    \
+    t->entries = NULL;                                                         \
+    t->slots = NULL;                                                           \
+    t->lbnslots = 0;                                                           \
+    t->count = 0;                                                              \
+    t->capacity = 0;                                                           \
+  }                                                                            \
+                                                                               \
+  static inline void name##_dispose(name *t) {                                 \
+    HTGEN_FREE(t->entries);                                                    \
+    HTGEN_FREE(t->slots);                                                      \
+    name##_init(t);                                                            \
+  }                                                                            \
+                                                                               \
+  /*  Le champ tag d'une entrée vaut la valeur de pré-hachage de sa clé.    */ \
+  /*    Un emplacement libre a un champ pos nul. Un emplacement occupé      */ \
+  /*    repère l'entrée d'indice pos - 1 et son champ tag conserve les 32   */ \
+  /*    bits de poids faible du champ tag de l'entrée : la plupart des      */ \
+  /*    entrées de clés différentes ne sont ainsi jamais consultées.        */ \
+  static inline size_t name##__tag(K key) {                                    \
+    return (size_t) (hashfun(key));                                            \
+  }                                                                            \
+                                                                               \
+  static inline size_t name##__index(size_t tag, size_t lbnslots) {            \
+    return (size_t) (((uint64_t) tag * 0x9E3779B97F4A7C15ULL)                  \
+      >> (64 - lbnslots));                                                     \
+  }                                                                            \
+                                                                               \
+  static inline name##__slot *name##__place(const name *t, size_t tag,         \
+      K key) {                                                                 \
+    size_t mask = ((size_t) 1 << t->lbnslots) - 1;                             \
+    size_t i = name##__index(tag, t->lbnslots);                                \
+    while (t->slots[i].pos != 0                                                \
+        && (t->slots[i].tag != (uint32_t) tag                                  \
+        || t->entries[t->slots[i].pos - 1].tag != tag                          \
+        || !(equal(t->entries[t->slots[i].pos - 1].key, key)))) {              \
+      i = (i + 1) & mask;                                                      \
+    }                                                                          \
+    return &t->slots[i];                                                       \
+  }                                                                            \
+                                                                               \
+  static inline V *name##_search(const name *t, K key) {                       \
+    if (t->slots == NULL) {                                                    \
+      return NULL;                                                             \
+    }                                                                          \
+    name##__slot *s = name##__place(t, name##__tag(key), key);                 \
+    return s->pos == 0 ? NULL : &t->entries[s->pos - 1].val;                   \
+  }                                                                            \
+                                                                               \
+  static inline void name##_search_batch(const name *t, const K *keys,         \
+      size_t n, V **vals) {                                                    \
+    size_t tags[HTGEN__BATCH];                                                 \
+    name##__slot *s[HTGEN__BATCH];                                             \
+    for (size_t j = 0; j < n; j += HTGEN__BATCH) {                             \
+      size_t m = (n - j < HTGEN__BATCH ? n - j : HTGEN__BATCH);                \
+      if (t->slots == NULL) {                                                  \
+        for (size_t k = 0; k < m; ++k) {                                       \
+          vals[j + k] = NULL;                                                  \
+        }                                                                      \
+        continue;                                                              \
+      }                                                                        \
+      for (size_t k = 0; k < m; ++k) {                                         \
+        tags[k] = name##__tag(keys[j + k]);                                    \
+        s[k] = &t->slots[name##__index(tags[k], t->lbnslots)];                 \
+        HTGEN__PREFETCH(s[k]);                                                 \
+      }                                                                        \
+      for (size_t k = 0; k < m; ++k) {                                         \
+        if (s[k]->pos != 0 && s[k]->tag == (uint32_t) tags[k]) {               \
+          HTGEN__PREFETCH(&t->entries[s[k]->pos - 1]);                         \
+        }                                                                      \
+      }                                                                        \
+      for (size_t k = 0; k < m; ++k) {                                         \
+        name##__slot *r = name##__place(t, tags[k], keys[j + k]);              \
+        vals[j + k] = (r->pos == 0 ? NULL : &t->entries[r->pos - 1].val);      \
+      }                                                                        \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  /*  Range les entrées, parcourues dans l'ordre de leur ajout, dans le     */ \
+  /*    tableau a de 2 ^ lb emplacements libres.                            */ \
+  static inline void name##__fill(const name *t, name##__slot *a,              \
+      size_t lb) {                                                             \
+    size_t mask = ((size_t) 1 << lb) - 1;                                      \
+    for (size_t k = 0; k < t->count; ++k) {                                    \
+      size_t i = name##__index(t->entries[k].tag, lb);                         \
+      while (a[i].pos != 0) {                                                  \
+        i = (i + 1) & mask;                                                    \
+      }                                                                        \
+      a[i] = (name##__slot) {                                                  \
+        .tag = (uint32_t) t->entries[k].tag, .pos = (uint32_t) (k + 1)         \
+      };                                                                       \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  /*  Reconstruit les emplacements, au nombre de 2 ^ lb, à partir des       */ \
+  /*    entrées.                                                            */ \
+  static inline int name##__rebuild(name *t, size_t lb) {                      \
+    if (lb >= 64 || lb >= sizeof(size_t) * CHAR_BIT                            \
+        || ((size_t) 1 << lb) > SIZE_MAX / sizeof *t->slots) {                 \
+      return -1;                                                               \
+    }                                                                          \
+    name##__slot *a = HTGEN_CALLOC((size_t) 1 << lb, sizeof *a);               \
+    if (a == NULL) {                                                           \
+      return -1;                                                               \
+    }                                                                          \
+    name##__fill(t, a, lb);                                                    \
+    HTGEN_FREE(t->slots);                                                      \
+    t->slots = a;                                                              \
+    t->lbnslots = lb;                                                          \
+    return 0;                                                                  \
+  }                                                                            \
+                                                                               \
+  static inline int name##_add(name *t, K key, V val) {                        \
+    size_t tag = name##__tag(key);                                             \
+    name##__slot *s;                                                           \
+    if (t->slots != NULL && (s = name##__place(t, tag, key))->pos != 0) {      \
+      t->entries[s->pos - 1].val = val;                                        \
+      return 0;                                                                \
+    }                                                                          \
+    if (t->count == UINT32_MAX) {                                              \
+      return -1;                                                               \
+    }                                                                          \
+    if (t->count == t->capacity) {                                             \
+      size_t c = (t->capacity == 0                                             \
+          ? (size_t) 1 << (HTGEN__LBNSLOTS_MIN - 1) : 2 * t->capacity);        \
+      name##_entry *a;                                                         \
+      if (c > SIZE_MAX / sizeof *a                                             \
+          || (a = HTGEN_REALLOC(t->entries, c * sizeof *a)) == NULL) {         \
+        return -1;                                                             \
+      }                                                                        \
+      t->entries = a;                                                          \
+      t->capacity = c;                                                         \
+    }                                                                          \
+    if (t->slots == NULL || t->count + 1 > ((size_t) 1 << t->lbnslots) / 2) {  \
+      if (name##__rebuild(t, t->slots == NULL                                  \
+          ? HTGEN__LBNSLOTS_MIN : t->lbnslots + 1) != 0) {                     \
+        return -1;                                                             \
+      }                                                                        \
+    }                                                                          \
+    s = name##__place(t, tag, key);                                            \
+    t->entries[t->count] = (name##_entry) {                                    \
+      .tag = tag, .key = key, .val = val                                       \
+    };                                                                         \
+    t->count += 1;                                                             \
+    *s = (name##__slot) { .tag = (uint32_t) tag, .pos = (uint32_t) t->count }; \
+    return 0;                                                                  \
+  }                                                                            \
+                                                                               \
+  static inline size_t name##_count(const name *t) {                           \
+    return t->count;                                                           \
+  }                                                                            \
+                                                                               \
+  /*  Les entrées conservées sont tassées en tête du tableau, dans leur     */ \
+  /*    ordre. Les emplacements sont ensuite reconstruits au plus petit     */ \
+  /*    nombre qui respecte le taux d'occupation, ou, faute de mémoire,     */ \
+  /*    vidés et remplis de nouveau sur place : la fonction n'échoue pas.   */ \
+  static inline void name##_retain(name *t, void *context,                     \
+      int (*keep)(void *, K, V)) {                                             \
+    size_t n = 0;                                                              \
+    for (size_t k = 0; k < t->count; ++k) {                                    \
+      if (keep(context, t->entries[k].key, t->entries[k].val)) {               \
+        t->entries[n] = t->entries[k];                                         \
+        n += 1;                                                                \
+      }                                                                        \
+    }                                                                          \
+    if (n == t->count) {                                                       \
+      return;                                                                  \
+    }                                                                          \
+    t->count = n;                                                              \
+    if (n == 0) {                                                              \
+      name##_dispose(t);                                                       \
+      return;                                                                  \
+    }                                                                          \
+    size_t lb = HTGEN__LBNSLOTS_MIN;                                           \
+    while (n > ((size_t) 1 << lb) / 2) {                                       \
+      lb += 1;                                                                 \
+    }                                                                          \
+    if (lb >= t->lbnslots || name##__rebuild(t, lb) != 0) {                    \
+      for (size_t i = 0; i < ((size_t) 1 << t->lbnslots); ++i) {               \
+        t->slots[i].pos = 0;                                                   \
+      }                                                                        \
+      name##__fill(t, t->slots, t->lbnslots);                                  \
+    }                                                                          \
+    size_t c = (size_t) 1 << (HTGEN__LBNSLOTS_MIN - 1);                        \
+    while (c < n) {                                                            \
+      c *= 2;                                                                  \
+    }                                                                          \
+    name##_entry *a;                                                           \
+    if (c < t->capacity                                                        \
+        && (a = HTGEN_REALLOC(t->entries, c * sizeof *a)) != NULL) {           \
+      t->entries = a;                                                          \
+      t->capacity = c;                                                         \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  static inline int name##_apply(const name *t, void *context,                 \
+      int (*fun)(void *, K, V)) {                                              \
+    for (size_t k = 0; k < t->count; ++k) {                                    \
+      int r = fun(context, t->entries[k].key, t->entries[k].val);              \
+      if (r != 0) {                                                            \
+        return r;                                                              \
+      }                                                                        \
+    }                                                                          \
+    return 0;                                                                  \
+  }                                                                            \
+                                                                               \
+  static inline int name##_apply_reverse(const name *t, void *context,         \
+      int (*fun)(void *, K, V)) {                                              \
+    for (size_t k = t->count; k > 0; --k) {                                    \
+      int r = fun(context, t->entries[k - 1].key, t->entries[k - 1].val);      \
+      if (r != 0) {                                                            \
+        return r;                                                              \
+      }                                                                        \
+    }                                                                          \
+    return 0;                                                                  \
+  }
+
+#endif
@@ -0,0 +1,366 @@
+//  hugemem.c : partie implantation d'un module d'allocation des grandes zones
+//    de mémoire sur des pages énormes.
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "hugemem.h"
+
+//  Chaque zone est précédée d'un en-tête, de type zone, qui mémorise sa taille
+//    et la longueur de sa projection, nulle si la zone est allouée par malloc.
+//    Les en-têtes des zones projetées sont chaînés dans la liste regions, ce
+//    qui permet de retrouver les projections parmi celles du processus. La
+//    taille de l'en-tête est arrondie à un multiple de l'alignement maximal :
+//    la zone qui le suit est convenablement alignée pour tout type.
+
+//  Une projection demande HUGEMEM_PAGE octets de plus que sa longueur : son
+//    début est ensuite avancé jusqu'au premier multiple de HUGEMEM_PAGE et les
+//    parties qui précèdent et qui suivent sont rendues au système.
+
+//  Les tronçons d'un entrepôt sont chaînés dans l'ordre inverse de leur
+//    allocation. Le premier mesure HUGEMEM_PAGE octets en-têtes compris et
+//    chaque tronçon suivant le double du précédent, jusqu'à
+//    HUGEMEM__ARENA_MAX : tous occupent exactement un multiple de
+//    HUGEMEM_PAGE. Une demande trop grande pour le tronçon courant et pour le
+//    suivant reçoit son propre tronçon, chaîné derrière le tronçon courant qui
+//    reste utilisé.
+
+#define HUGEMEM__ALIGN _Alignof(max_align_t)
+#define HUGEMEM__ROUND(n, m) (((n) + (m) - 1) / (m) * (m))
+#define HUGEMEM__ARENA_MAX ((size_t) 64 << 20)
+#define HUGEMEM__THP_ENABLED "/sys/kernel/mm/transparent_hugepage/enabled"
+#define HUGEMEM__SMAPS "/proc/self/smaps"
+#define HUGEMEM__SMAPS_HUGE "AnonHugePages:"
+#define HUGEMEM__LINE 512
+
+typedef struct zone zone;
+
+struct zone {
+  zone *prev;
+  zone *next;
+  size_t size;
+  size_t mapped;
+};
+
+#define HUGEMEM__HDR HUGEMEM__ROUND(sizeof(zone), HUGEMEM__ALIGN)
+
+#define ZONE(ptr) ((zone *) ((char *) (ptr) - HUGEMEM__HDR))
+#define DATA(z) ((void *) ((char *) (z) + HUGEMEM__HDR))
+
+static bool enabled = false;
+static zone *regions = NULL;
+static size_t nregions = 0;
+static size_t mapped = 0;
+static size_t nfallback = 0;
+
+int hugemem_enable(bool b) {
+  enabled = false;
+  if (!b) {
+    return 0;
+  }
+#if defined MADV_HUGEPAGE && defined MAP_ANONYMOUS
+  //  Le fichier de configuration indique entre crochets le mode retenu parmi
+  //    « always », « madvise » et « never ».
+  FILE *f = fopen(HUGEMEM__THP_ENABLED, "r");
+  if (f == NULL) {
+    return -1;
+  }
+  char buf[HUGEMEM__LINE];
+  bool never = (fgets(buf, sizeof buf, f) == NULL
+      || strstr(buf, "[never]") != NULL);
+  fclose(f);
+  if (never) {
+    return -1;
+  }
+  enabled = true;
+  return 0;
+#else
+  return -1;
+#endif
+}
+
+//  hugemem__map : tente de projeter une zone de len octets, multiple de
+//    HUGEMEM_PAGE, alignée sur HUGEMEM_PAGE et servie si possible par des
+//    pages énormes. Renvoie NULL en cas d'échec, l'adresse de la zone sinon.
+static void *hugemem__map(size_t len) {
+#if defined MADV_HUGEPAGE && defined MAP_ANONYMOUS
+  if (len > SIZE_MAX - HUGEMEM_PAGE) {
+    return NULL;
+  }
+  size_t n = len + HUGEMEM_PAGE;
+  char *p = mmap(NULL, n, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+      -1, 0);
+  if (p == MAP_FAILED) {
+    return NULL;
+  }
+  size_t head = (HUGEMEM_PAGE - (uintptr_t) p % HUGEMEM_PAGE) % HUGEMEM_PAGE;
+  if (head > 0) {
+    munmap(p, head);
+  }
+  if (n - head - len > 0) {
+    munmap(p + head + len, n - head - len);
+  }
+  p += head;
+  //  Un échec de madvise laisse la zone servie par des pages ordinaires.
+  (void) madvise(p, len, MADV_HUGEPAGE);
+  return p;
+#else
+  (void) len;
+  return NULL;
+#endif
+}
+
+//  hugemem__alloc : alloue une zone de size octets, mise à zéro si zero est
+//    vrai.
+static void *hugemem__alloc(size_t size, bool zero) {
+  if (size > SIZE_MAX - HUGEMEM__HDR - HUGEMEM_PAGE) {
+    return NULL;
+  }
+  size_t total = HUGEMEM__HDR + size;
+  zone *z = NULL;
+  if (enabled && total >= HUGEMEM_PAGE) {
+    size_t len = HUGEMEM__ROUND(total, HUGEMEM_PAGE);
+    if ((z = hugemem__map(len)) != NULL) {
+      z->mapped = len;
+      z->prev = NULL;
+      z->next = regions;
+      if (regions != NULL) {
+        regions->prev = z;
+      }
+      regions = z;
+      nregions += 1;
+      mapped += len;
+    } else {
+      nfallback += 1;
+    }
+  }
+  if (z == NULL) {
+    z = (zero ? calloc(1, total) : malloc(total));
+    if (z == NULL) {
+      return NULL;
+    }
+    z->mapped = 0;
+  }
+  z->size = size;
+  return DATA(z);
+}
+
+void *hugemem_malloc(size_t size) {
+  return hugemem__alloc(size, false);
+}
+
+void *hugemem_calloc(size_t nmemb, size_t size) {
+  if (size != 0 && nmemb > SIZE_MAX / size) {
+    return NULL;
+  }
+  return hugemem__alloc(nmemb * size, true);
+}
+
+void *hugemem_realloc(void *ptr, size_t size) {
+  if (ptr == NULL) {
+    return hugemem_malloc(size);
+  }
+  if (size > SIZE_MAX - HUGEMEM__HDR - HUGEMEM_PAGE) {
+    return NULL;
+  }
+  zone *z = ZONE(ptr);
+  size_t total = HUGEMEM__HDR + size;
+  if (z->mapped != 0 && total <= z->mapped) {
+    //  Réduction sur place : les pages énormes devenues inutiles sont rendues
+    //    au système.
+    size_t len = HUGEMEM__ROUND(total, HUGEMEM_PAGE);
+    if (len < z->mapped) {
+      munmap((char *) z + len, z->mapped - len);
+      mapped -= z->mapped - len;
+      z->mapped = len;
+    }
+    z->size = size;
+    return ptr;
+  }
+  if (z->mapped == 0 && (!enabled || total < HUGEMEM_PAGE)) {
+    zone *t = realloc(z, total);
+    if (t == NULL) {
+      return NULL;
+    }
+    t->size = size;
+    return DATA(t);
+  }
+  void *p = hugemem_malloc(size);
+  if (p == NULL) {
+    return NULL;
+  }
+  memcpy(p, ptr, z->size < size ? z->size : size);
+  hugemem_free(ptr);
+  return p;
+}
+
+void hugemem_free(void *ptr) {
+  if (ptr == NULL) {
+    return;
+  }
+  zone *z = ZONE(ptr);
+  if (z->mapped == 0) {
+    free(z);
+    return;
+  }
+  if (z->prev != NULL) {
+    z->prev->next = z->next;
+  } else {
+    regions = z->next;
+  }
+  if (z->next != NULL) {
+    z->next->prev = z->prev;
+  }
+  nregions -= 1;
+  mapped -= z->mapped;
+  munmap(z, z->mapped);
+}
+
+//  hugemem__overlaps : renvoie vrai si et seulement si l'intervalle d'adresses
+//    [lo, hi[ rencontre l'une des zones projetées.
+static bool hugemem__overlaps(uintptr_t lo, uintptr_t hi) {
+  for (const zone *z = regions; z != NULL; z = z->next) {
+    uintptr_t a = (uintptr_t) z;
+    if (a < hi && lo < a + z->mapped) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int hugemem_get_stats(struct hugemem_stats *hmsptr) {
+  *hmsptr = (struct hugemem_stats) {
+    .nregions = nregions,
+    .mapped = mapped,
+    .huge = 0,
+    .nfallback = nfallback,
+  };
+  if (regions == NULL) {
+    return 0;
+  }
+  //  Chaque projection du processus est décrite par une ligne d'en-tête
+  //    « début-fin ... », en hexadécimal, suivie de lignes « Champ: valeur ».
+  //    Le champ AnonHugePages donne, en kio, la part servie par des pages
+  //    énormes. Les projections voisines de mêmes attributs étant fusionnées
+  //    par le système, toute projection qui rencontre une zone est comptée.
+  FILE *f = fopen(HUGEMEM__SMAPS, "r");
+  if (f == NULL) {
+    return -1;
+  }
+  char buf[HUGEMEM__LINE];
+  bool in = false;
+  bool cont = false;
+  size_t huge = 0;
+  while (fgets(buf, sizeof buf, f) != NULL) {
+    bool c = cont;
+    cont = (strchr(buf, '\n') == NULL);
+    if (c) {
+      continue;
+    }
+    uintptr_t lo;
+    uintptr_t hi;
+    unsigned long long kb;
+    if (sscanf(buf, "%" SCNxPTR "-%" SCNxPTR, &lo, &hi) == 2) {
+      in = hugemem__overlaps(lo, hi);
+    } else if (in && sscanf(buf, HUGEMEM__SMAPS_HUGE " %llu", &kb) == 1) {
+      huge += (size_t) kb * 1024;
+    }
+  }
+  int r = ferror(f);
+  fclose(f);
+  if (r != 0) {
+    return -1;
+  }
+  hmsptr->huge = (huge < mapped ? huge : mapped);
+  return 0;
+}
+
+//--- Entrepôt -----------------------------------------------------------------
+
+typedef struct chunk chunk;
+
+struct chunk {
+  chunk *next;
+};
+
+#define HUGEMEM__CHUNK_HDR HUGEMEM__ROUND(sizeof(chunk), HUGEMEM__ALIGN)
+
+struct hugemem_arena {
+  chunk *head;
+  char *cur;
+  size_t left;
+  size_t next;
+};
+
+hugemem_arena *hugemem_arena_empty(void) {
+  hugemem_arena *a = malloc(sizeof *a);
+  if (a == NULL) {
+    return NULL;
+  }
+  a->head = NULL;
+  a->cur = NULL;
+  a->left = 0;
+  a->next = HUGEMEM_PAGE;
+  return a;
+}
+
+void hugemem_arena_dispose(hugemem_arena **aptr) {
+  if (*aptr == NULL) {
+    return;
+  }
+  chunk *c = (*aptr)->head;
+  while (c != NULL) {
+    chunk *t = c;
+    c = c->next;
+    hugemem_free(t);
+  }
+  free(*aptr);
+  *aptr = NULL;
+}
+
+void *hugemem_arena_alloc(hugemem_arena *a, size_t size) {
+  if (size > SIZE_MAX - HUGEMEM__ARENA_MAX) {
+    return NULL;
+  }
+  //  Un bloc vide occupe une unité d'alignement, pour que son adresse soit
+  //    valide et distincte de celle des autres blocs.
+  size = HUGEMEM__ROUND(size == 0 ? 1 : size, HUGEMEM__ALIGN);
+  if (size <= a->left) {
+    void *p = a->cur;
+    a->cur += size;
+    a->left -= size;
+    return p;
+  }
+  size_t n = a->next - HUGEMEM__HDR;
+  if (size > n - HUGEMEM__CHUNK_HDR) {
+    chunk *c = hugemem_malloc(HUGEMEM__CHUNK_HDR + size);
+    if (c == NULL) {
+      return NULL;
+    }
+    if (a->head == NULL) {
+      c->next = NULL;
+      a->head = c;
+    } else {
+      c->next = a->head->next;
+      a->head->next = c;
+    }
+    return (char *) c + HUGEMEM__CHUNK_HDR;
+  }
+  chunk *c = hugemem_malloc(n);
+  if (c == NULL) {
+    return NULL;
+  }
+  c->next = a->head;
+  a->head = c;
+  a->cur = (char *) c + HUGEMEM__CHUNK_HDR + size;
+  a->left = n - HUGEMEM__CHUNK_HDR - size;
+  if (a->next < HUGEMEM__ARENA_MAX) {
+    a->next *= 2;
+  }
+  return (char *) c + HUGEMEM__CHUNK_HDR;
+}
@@ -0,0 +1,92 @@
+//  hugemem.h : partie interface d'un module d'allocation des grandes zones de
+//    mémoire sur des pages énormes.
+
+#ifndef HUGEMEM__H
+#define HUGEMEM__H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+//  Fonctionnement général :
+//  - les fonctions hugemem_malloc, hugemem_calloc, hugemem_realloc et
+//      hugemem_free ont le comportement de leurs homologues de la bibliothèque
+//      standard, dont elles ne peuvent être mélangées : une zone allouée par
+//      l'une des trois premières ne peut être libérée que par hugemem_free et
+//      redimensionnée que par hugemem_realloc ;
+//  - tant que le service n'est pas activé par hugemem_enable, toutes les
+//      zones sont allouées par malloc. Une fois activé, les zones d'au moins
+//      HUGEMEM_PAGE octets sont projetées en mémoire anonyme par mmap, sur un
+//      multiple de HUGEMEM_PAGE octets aligné sur HUGEMEM_PAGE, et le système
+//      est invité par madvise(MADV_HUGEPAGE) à les servir par des pages
+//      énormes transparentes, ce qui réduit le nombre de défauts de page et de
+//      défauts de TLB lors des accès aléatoires. Si le système refuse l'une
+//      de ces demandes, la zone est servie par des pages ordinaires ou par
+//      malloc ;
+//  - un entrepôt, de type hugemem_arena, alloue des blocs de taille
+//      quelconque par simple incrémentation dans des tronçons obtenus par
+//      hugemem_malloc, de tailles croissantes. Les blocs ne sont pas libérés
+//      individuellement mais tous ensemble par hugemem_arena_dispose ;
+//  - le module n'est pas réentrant : ses fonctions ne doivent être appelées
+//      que par une seule tâche à la fois ;
+//  - les fonctions qui possèdent un paramètre de type « hugemem_arena * » ou
+//      « hugemem_arena ** » ont un comportement indéterminé lorsque ce
+//      paramètre ou sa déréférence n'est pas l'adresse d'un contrôleur
+//      préalablement renvoyée avec succès par la fonction hugemem_arena_empty
+//      et non révoquée depuis par la fonction hugemem_arena_dispose.
+
+//  HUGEMEM_PAGE : taille en octets d'une page énorme.
+#define HUGEMEM_PAGE ((size_t) 2 << 20)
+
+//  hugemem_enable : active ou, si b est faux, désactive le service des
+//    grandes zones par des pages énormes pour les allocations à venir. Renvoie
+//    une valeur non nulle si b est vrai et que le système ne propose pas de
+//    pages énormes transparentes, le service restant alors désactivé. Renvoie
+//    sinon zéro.
+extern int hugemem_enable(bool b);
+
+//  hugemem_malloc, hugemem_calloc, hugemem_realloc, hugemem_free : voir
+//    Fonctionnement général.
+extern void *hugemem_malloc(size_t size);
+extern void *hugemem_calloc(size_t nmemb, size_t size);
+extern void *hugemem_realloc(void *ptr, size_t size);
+extern void hugemem_free(void *ptr);
+
+//  struct hugemem_stats : nombre de zones projetées (nregions), nombre total
+//    d'octets projetés (mapped) et nombre d'octets de ces zones effectivement
+//    servis par des pages énormes (huge), ainsi que nombre de zones d'au moins
+//    HUGEMEM_PAGE octets allouées par malloc, faute de projection possible
+//    (nfallback).
+struct hugemem_stats {
+  size_t nregions;
+  size_t mapped;
+  size_t huge;
+  size_t nfallback;
+};
+
+//  hugemem_get_stats : affecte à *hmsptr les statistiques des zones en cours
+//    d'allocation. Le champ huge est mesuré par la lecture de /proc/self/smaps.
+//    Renvoie une valeur non nulle si cette lecture échoue, le champ huge
+//    valant alors zéro. Renvoie sinon zéro.
+extern int hugemem_get_stats(struct hugemem_stats *hmsptr);
+
+//  struct hugemem_arena, hugemem_arena : type et nom de type d'un contrôleur
+//    regroupant les informations nécessaires pour gérer un entrepôt.
+typedef struct hugemem_arena hugemem_arena;
+
+//  hugemem_arena_empty : tente d'allouer les ressources nécessaires pour gérer
+//    un nouvel entrepôt initialement vide. Renvoie NULL en cas de dépassement
+//    de capacité. Renvoie sinon un pointeur vers le contrôleur associé à
+//    l'entrepôt.
+extern hugemem_arena *hugemem_arena_empty(void);
+
+//  hugemem_arena_dispose : sans effet si *aptr vaut NULL. Libère sinon les
+//    ressources allouées à la gestion de l'entrepôt associé à *aptr, et donc
+//    tous ses blocs, puis affecte NULL à *aptr.
+extern void hugemem_arena_dispose(hugemem_arena **aptr);
+
+//  hugemem_arena_alloc : tente d'allouer dans l'entrepôt associé à a un bloc
+//    de size octets, convenablement aligné pour tout type. Renvoie NULL en cas
+//    de dépassement de capacité, l'adresse du bloc sinon.
+extern void *hugemem_arena_alloc(hugemem_arena *a, size_t size);
+
+#endif
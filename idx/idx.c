@@ -0,0 +1,310 @@
+//  idx.c : partie implantation d'un module pour la gestion d'index de lignes
+//    projetables en mémoire.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "idx.h"
+
+//  Un fichier d'index se compose, dans l'ordre :
+//  - d'un en-tête struct header ;
+//  - d'une table de hachage à adressage ouvert et sondage linéaire de nslots
+//      compartiments, nslots étant une puissance de 2 au moins égale au double
+//      du nombre de lignes. Chaque compartiment contient 0 s'il est libre, le
+//      rang de la ligne plus 1 sinon ;
+//  - du tableau des nkeys entrées struct entry, une par ligne, dans l'ordre
+//      des rangs ;
+//  - du contenu des lignes, chacune suivie d'une fin de chaîne.
+//  Les trois dernières parties commencent à des positions multiples de 8,
+//    mémorisées dans l'en-tête.
+
+#define IDX__MAGIC    "LNIDINDX"
+#define IDX__VERSION  1
+#define IDX__ALIGN    8
+
+struct header {
+  char magic[8];
+  uint32_t version;
+  uint32_t flags;
+  char opts[IDX_FILTER_MAX];
+  uint64_t nkeys;
+  uint64_t nslots;
+  uint64_t slots;
+  uint64_t entries;
+  uint64_t keys;
+  uint64_t size;
+};
+
+struct entry {
+  uint64_t hash;
+  uint64_t key;
+  uint64_t len;
+  uint64_t count;
+};
+
+#define ALIGN(n) (((n) + IDX__ALIGN - 1) / IDX__ALIGN * IDX__ALIGN)
+
+//--- Construction -------------------------------------------------------------
+
+//  struct idxb : les entrées et le contenu des lignes sont accumulés dans deux
+//    tableaux dynamiques dont la capacité est doublée au besoin.
+
+#define IDXB__CAPACITY_MIN 64
+
+struct idxb {
+  struct header h;
+  struct entry *entries;
+  size_t nentries;
+  size_t centries;
+  char *keys;
+  size_t lkeys;
+  size_t ckeys;
+};
+
+idxb *idxb_empty(uint32_t flags, const char *opts) {
+  if (strlen(opts) >= IDX_FILTER_MAX) {
+    return NULL;
+  }
+  idxb *b = malloc(sizeof *b);
+  if (b == NULL) {
+    return NULL;
+  }
+  memset(&b->h, 0, sizeof b->h);
+  memcpy(b->h.magic, IDX__MAGIC, sizeof b->h.magic);
+  b->h.version = IDX__VERSION;
+  b->h.flags = flags;
+  strcpy(b->h.opts, opts);
+  b->entries = NULL;
+  b->nentries = 0;
+  b->centries = 0;
+  b->keys = NULL;
+  b->lkeys = 0;
+  b->ckeys = 0;
+  return b;
+}
+
+void idxb_dispose(idxb **bptr) {
+  if (*bptr == NULL) {
+    return;
+  }
+  free((*bptr)->entries);
+  free((*bptr)->keys);
+  free(*bptr);
+  *bptr = NULL;
+}
+
+int idxb_add(idxb *b, uint64_t h, const char *s, size_t len, uint64_t count) {
+  if (b->nentries == b->centries) {
+    size_t c = (b->centries == 0 ? IDXB__CAPACITY_MIN : 2 * b->centries);
+    if (c > SIZE_MAX / sizeof *b->entries) {
+      return -1;
+    }
+    struct entry *t = realloc(b->entries, c * sizeof *t);
+    if (t == NULL) {
+      return -1;
+    }
+    b->entries = t;
+    b->centries = c;
+  }
+  if (len >= SIZE_MAX - b->lkeys) {
+    return -1;
+  }
+  if (b->lkeys + len + 1 > b->ckeys) {
+    size_t c = (b->ckeys == 0 ? IDXB__CAPACITY_MIN : b->ckeys);
+    while (c < b->lkeys + len + 1) {
+      if (c > SIZE_MAX / 2) {
+        return -1;
+      }
+      c *= 2;
+    }
+    char *t = realloc(b->keys, c);
+    if (t == NULL) {
+      return -1;
+    }
+    b->keys = t;
+    b->ckeys = c;
+  }
+  b->entries[b->nentries] = (struct entry) {
+    .hash = h, .key = b->lkeys, .len = len, .count = count
+  };
+  b->nentries += 1;
+  memcpy(b->keys + b->lkeys, s, len);
+  b->keys[b->lkeys + len] = '\0';
+  b->lkeys += len + 1;
+  return 0;
+}
+
+int idxb_write(idxb *b, const char *filename) {
+  size_t m = 1;
+  while (m < 2 * b->nentries) {
+    if (m > SIZE_MAX / 2 / sizeof(uint64_t)) {
+      return -1;
+    }
+    m *= 2;
+  }
+  uint64_t *slots = calloc(m, sizeof *slots);
+  if (slots == NULL) {
+    return -1;
+  }
+  for (size_t i = 0; i < b->nentries; ++i) {
+    size_t k = (size_t) (b->entries[i].hash & (m - 1));
+    while (slots[k] != 0) {
+      k = (k + 1) & (m - 1);
+    }
+    slots[k] = i + 1;
+  }
+  struct header h = b->h;
+  h.nkeys = b->nentries;
+  h.nslots = m;
+  h.slots = ALIGN(sizeof h);
+  h.entries = h.slots + m * sizeof *slots;
+  h.keys = h.entries + b->nentries * sizeof *b->entries;
+  h.size = h.keys + b->lkeys;
+  //  Les entrées mémorisent des positions relatives au début des contenus ;
+  //    elles sont rendues relatives au début du fichier à l'écriture.
+  for (size_t i = 0; i < b->nentries; ++i) {
+    b->entries[i].key += h.keys;
+  }
+  static const char pad[IDX__ALIGN];
+  size_t flen = strlen(filename);
+  char tmp[flen + sizeof ".tmp"];
+  strcpy(tmp, filename);
+  strcpy(tmp + flen, ".tmp");
+  FILE *f = fopen(tmp, "wb");
+  int r = f == NULL
+    || fwrite(&h, sizeof h, 1, f) != 1
+    || fwrite(pad, 1, h.slots - sizeof h, f) != h.slots - sizeof h
+    || fwrite(slots, sizeof *slots, m, f) != m
+    || fwrite(b->entries, sizeof *b->entries, b->nentries, f) != b->nentries
+    || fwrite(b->keys, 1, b->lkeys, f) != b->lkeys;
+  if (f != NULL && (fclose(f) != 0 || r != 0 || rename(tmp, filename) != 0)) {
+    remove(tmp);
+    r = 1;
+  }
+  for (size_t i = 0; i < b->nentries; ++i) {
+    b->entries[i].key -= h.keys;
+  }
+  free(slots);
+  return r;
+}
+
+//--- Consultation -------------------------------------------------------------
+
+struct idx {
+  void *base;
+  size_t size;
+  const struct header *h;
+  const uint64_t *slots;
+  const struct entry *entries;
+};
+
+idx *idx_open(const char *filename) {
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (uintmax_t) st.st_size < sizeof(struct header)
+      || (uintmax_t) st.st_size > SIZE_MAX) {
+    close(fd);
+    return NULL;
+  }
+  size_t size = (size_t) st.st_size;
+  void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    return NULL;
+  }
+  const struct header *h = base;
+  if (memcmp(h->magic, IDX__MAGIC, sizeof h->magic) != 0
+      || h->version != IDX__VERSION
+      || h->opts[IDX_FILTER_MAX - 1] != '\0'
+      || h->size != size
+      || h->nslots == 0 || (h->nslots & (h->nslots - 1)) != 0
+      || h->nslots < h->nkeys
+      || h->nslots > size / sizeof(uint64_t)
+      || h->nkeys > size / sizeof(struct entry)
+      || h->slots != ALIGN(sizeof *h)
+      || h->entries != h->slots + h->nslots * sizeof(uint64_t)
+      || h->keys != h->entries + h->nkeys * sizeof(struct entry)
+      || h->keys > size) {
+    munmap(base, size);
+    return NULL;
+  }
+  idx *ix = malloc(sizeof *ix);
+  if (ix == NULL) {
+    munmap(base, size);
+    return NULL;
+  }
+  ix->base = base;
+  ix->size = size;
+  ix->h = h;
+  ix->slots = (const uint64_t *) ((const char *) base + h->slots);
+  ix->entries = (const struct entry *) ((const char *) base + h->entries);
+  return ix;
+}
+
+void idx_dispose(idx **iptr) {
+  if (*iptr == NULL) {
+    return;
+  }
+  munmap((*iptr)->base, (*iptr)->size);
+  free(*iptr);
+  *iptr = NULL;
+}
+
+uint32_t idx_flags(const idx *ix) {
+  return ix->h->flags;
+}
+
+const char *idx_opts(const idx *ix) {
+  return ix->h->opts;
+}
+
+size_t idx_length(const idx *ix) {
+  return (size_t) ix->h->nkeys;
+}
+
+//  VALID : teste si l'entrée e désigne un contenu situé dans l'index ix.
+#define VALID(ix, e)                                                           \
+  ((e)->key >= (ix)->h->keys && (e)->key < (ix)->size                          \
+  && (e)->len < (ix)->size - (e)->key)
+
+size_t idx_search(const idx *ix, uint64_t h, const char *s, size_t len) {
+  uint64_t mask = ix->h->nslots - 1;
+  uint64_t k = h & mask;
+  for (uint64_t n = 0; n < ix->h->nslots; ++n) {
+    uint64_t r = ix->slots[k];
+    if (r == 0 || r > ix->h->nkeys) {
+      return IDX_NONE;
+    }
+    const struct entry *e = &ix->entries[r - 1];
+    if (e->hash == h && e->len == len && VALID(ix, e)
+        && memcmp((const char *) ix->base + e->key, s, len) == 0) {
+      return (size_t) (r - 1);
+    }
+    k = (k + 1) & mask;
+  }
+  return IDX_NONE;
+}
+
+const char *idx_line(const idx *ix, size_t i, uint64_t *count) {
+  if (i >= ix->h->nkeys) {
+    return NULL;
+  }
+  const struct entry *e = &ix->entries[i];
+  if (!VALID(ix, e)) {
+    return NULL;
+  }
+  const char *s = (const char *) ix->base + e->key;
+  if (s[e->len] != '\0') {
+    return NULL;
+  }
+  *count = e->count;
+  return s;
+}
@@ -0,0 +1,108 @@
+//  idx.h : partie interface d'un module pour la gestion d'index de lignes
+//    projetables en mémoire.
+
+#ifndef IDX__H
+#define IDX__H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+//  Fonctionnement général :
+//  - un index associe à des lignes de texte, données par leur contenu, leur
+//      longueur et une valeur de hachage sur 64 bits calculée par
+//      l'utilisateur, un compteur et un rang. Les rangs vont de 0 au nombre de
+//      lignes moins 1, dans l'ordre d'ajout des lignes ;
+//  - un index est construit à l'aide d'un constructeur, de type idxb, puis
+//      écrit dans un fichier. Le format du fichier est versionné et ne contient
+//      que des positions relatives à son début : ouvrir un index consiste à
+//      projeter le fichier en mémoire, sans aucune désérialisation ni aucune
+//      allocation par ligne. La table de hachage du fichier est consultée
+//      directement dans la projection ;
+//  - le fichier est écrit dans l'ordre des octets de la machine et n'est
+//      lisible que sur une machine de même boutisme ;
+//  - les valeurs de hachage sont mémorisées dans l'index : l'utilisateur doit
+//      employer la même fonction de hachage lors de la construction et lors des
+//      recherches ;
+//  - les fonctions qui possèdent un paramètre de type « idx * », « idx ** »,
+//      « idxb * » ou « idxb ** » ont un comportement indéterminé lorsque ce
+//      paramètre ou sa déréférence n'est pas l'adresse d'un contrôleur
+//      préalablement renvoyée avec succès par la fonction idx_open (resp.
+//      idxb_empty) et non révoquée depuis par la fonction idx_dispose (resp.
+//      idxb_dispose).
+
+//  IDX_NONE : valeur renvoyée par idx_search en cas de recherche négative.
+#define IDX_NONE SIZE_MAX
+
+//  IDX_FILTER_MAX : longueur maximale, fin de chaîne comprise, de la chaîne
+//    de description des options mémorisée par un index.
+#define IDX_FILTER_MAX 32
+
+//  struct idx, idx : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour consulter un index ouvert.
+typedef struct idx idx;
+
+//  struct idxb, idxb : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour construire un index.
+typedef struct idxb idxb;
+
+//- CONSTRUCTION ---------------------------------------------------------------
+
+//  idxb_empty : tente d'allouer les ressources nécessaires pour construire un
+//    nouvel index initialement vide. L'entier flags et la chaîne opts, de
+//    longueur inférieure à IDX_FILTER_MAX, sont mémorisés tels quels et
+//    permettent de décrire les options avec lesquelles les lignes ont été
+//    lues. Renvoie NULL en cas de dépassement de capacité ou si opts est trop
+//    longue. Renvoie sinon un pointeur vers le contrôleur associé.
+extern idxb *idxb_empty(uint32_t flags, const char *opts);
+
+//  idxb_dispose : sans effet si *bptr vaut NULL. Libère sinon les ressources
+//    allouées à la construction associée à *bptr puis affecte NULL à *bptr.
+extern void idxb_dispose(idxb **bptr);
+
+//  idxb_add : tente d'ajouter à l'index en construction associé à b la ligne de
+//    contenu s, de longueur len, de valeur de hachage h et de compteur count.
+//    La ligne ne doit pas déjà figurer dans l'index. Renvoie une valeur non
+//    nulle en cas de dépassement de capacité, zéro sinon.
+extern int idxb_add(idxb *b, uint64_t h, const char *s, size_t len,
+    uint64_t count);
+
+//  idxb_write : tente d'écrire l'index en construction associé à b dans le
+//    fichier de nom filename. L'écriture a lieu dans un fichier temporaire, de
+//    nom filename suivi de « .tmp », qui remplace le fichier d'index une fois
+//    complet. Renvoie une valeur négative en cas de dépassement de capacité,
+//    une valeur positive en cas d'erreur d'écriture, zéro sinon.
+extern int idxb_write(idxb *b, const char *filename);
+
+//- CONSULTATION ---------------------------------------------------------------
+
+//  idx_open : tente de projeter en mémoire l'index contenu dans le fichier de
+//    nom filename. Renvoie NULL si le fichier ne peut être projeté ou ne
+//    contient pas un index valide de la version courante. Renvoie sinon un
+//    pointeur vers le contrôleur associé à l'index.
+extern idx *idx_open(const char *filename);
+
+//  idx_dispose : sans effet si *iptr vaut NULL. Libère sinon les ressources
+//    allouées à la consultation de l'index associé à *iptr puis affecte NULL à
+//    *iptr.
+extern void idx_dispose(idx **iptr);
+
+//  idx_flags, idx_opts : renvoient l'entier et la chaîne de description des
+//    options mémorisés par l'index associé à ix.
+extern uint32_t idx_flags(const idx *ix);
+extern const char *idx_opts(const idx *ix);
+
+//  idx_length : renvoie le nombre de lignes de l'index associé à ix.
+extern size_t idx_length(const idx *ix);
+
+//  idx_search : recherche dans l'index associé à ix la ligne de contenu s, de
+//    longueur len et de valeur de hachage h. Renvoie IDX_NONE si la recherche
+//    est négative, le rang de la ligne sinon.
+extern size_t idx_search(const idx *ix, uint64_t h, const char *s, size_t len);
+
+//  idx_line : renvoie le contenu, terminé par une fin de chaîne, de la ligne de
+//    rang i de l'index associé à ix et affecte son compteur à *count. Renvoie
+//    NULL si i n'est pas un rang valide ou si la ligne est hors de l'index.
+extern const char *idx_line(const idx *ix, size_t i, uint64_t *count);
+
+#endif
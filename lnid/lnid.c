@@ -0,0 +1,1944 @@
+//  lnid.c : partie implantation d'un module de recherche des lignes répétées
+//    dans un texte ou communes à plusieurs, lus par morceaux.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include "lnid.h"
+#include "bloom.h"
+#include "da.h"
+#include "hashtable.h"
+#include "heap.h"
+#include "hugemem.h"
+#include "idx.h"
+#include "radix.h"
+#include "dagen.h"
+
+//  Les tableaux des tables produites par HTGEN sont alloués par le module
+//    hugemem, qui les sert par des pages énormes si le service en est activé.
+#define HTGEN_CALLOC hugemem_calloc
+#define HTGEN_REALLOC hugemem_realloc
+#define HTGEN_FREE hugemem_free
+#include "htgen.h"
+
+//  Nombre maximal de lignes complètes mises en attente avant leur traitement
+//    groupé et capacité initiale du tampon des lignes.
+#define LNID__BATCH 32
+#define LNID__LINES_CAP_MIN 4096
+
+//  Nombre d'emplacements, puissance de 2, de l'antémémoire des lignes
+//    fréquentes. Si, sur les LNID__HOT_WINDOW dernières recherches dans
+//    l'antémémoire, moins d'une sur LNID__HOT_MINRATE aboutit, l'antémémoire
+//    n'est plus consultée pendant les LNID__HOT_SKIP groupes de lignes
+//    suivants.
+#define LNID__HOT_NSLOTS 256
+#define LNID__HOT_WINDOW 4096
+#define LNID__HOT_MINRATE 8
+#define LNID__HOT_SKIP (65536 / LNID__BATCH)
+
+//  Capacité initiale du tableau des enregistrements du moteur par tri. Les
+//    enregistrements codent la position d'un fichier dans l'ordre de
+//    traitement sur les LNID__SORT_FILE_BITS bits de poids fort de leur champ
+//    pos et la position d'une ligne dans son fichier sur les autres.
+#define LNID__SORT_CAP_MIN ((size_t) 1 << 16)
+#define LNID__SORT_FILE_BITS 16
+#define LNID__SORT_OFF_BITS (64 - LNID__SORT_FILE_BITS)
+#define LNID__SORT_OFF_MASK (((uint64_t) 1 << LNID__SORT_OFF_BITS) - 1)
+
+//  Taille des lectures effectuées par lnid_reread.
+#define LNID__REREAD_BUFSIZE 4096
+
+//  Signature et version du format des fichiers d'état.
+#define LNID__STATE_MAGIC "LNIDTAIL"
+#define LNID__STATE_VERSION 2
+
+//  Bits des options mémorisées par un fichier d'index indiquant le passage en
+//    majuscules et, en présence de celui-ci ou d'une classe, le traitement des
+//    lignes par caractères UTF-8 plutôt que par octets.
+#define LNID__INDEX_UPPER 1u
+#define LNID__INDEX_UTF8 2u
+
+//  Alignement et position du tableau de compteurs alloué à la suite d'une clé
+//    de n octets, voir lnid__entry.
+#define LNID__ENTRY_ALIGN _Alignof(max_align_t)
+#define LNID__ENTRY_OFFSET(n) \
+  (((n) + LNID__ENTRY_ALIGN - 1) / LNID__ENTRY_ALIGN * LNID__ENTRY_ALIGN)
+
+//  LNID__STR_EQUAL : égalité de deux chaînes de caractères.
+#define LNID__STR_EQUAL(s1, s2) (strcmp((s1), (s2)) == 0)
+
+//  cnt : tableau dynamique de compteurs d'une ligne, dont les DA_INLINE
+//    premiers sont stockés dans son contrôleur.
+DAGEN(cnt, int, DA_INLINE)
+
+//  strtab : table qui associe à chaque ligne son tableau de compteurs, hors
+//    mode économe en mémoire.
+HTGEN(strtab, const char *, cnt *, hashtable_str_hashfun, LNID__STR_EQUAL)
+
+//  struct entrytail : suite d'un bloc alloué par lnid__entry, qui suit la clé.
+//    Le champ cpt, premier champ, est le tableau de compteurs de la ligne : la
+//    table l'associe à la clé par son adresse, qui est aussi celle de la
+//    structure. Le champ first est le numéro de la première occurrence de la
+//    ligne dans le fichier d'ordre de la session, voir lnid_order, s'il n'est
+//    pas celui de position 0.
+struct entrytail {
+  cnt cpt;
+  int first;
+};
+
+//  LNID__TAIL : adresse de la structure dont le tableau de compteurs cpt est le
+//    premier champ.
+#define LNID__TAIL(cpt) ((struct entrytail *) (cpt))
+
+//  struct fingerprint : empreinte d'une ligne en mode économe en mémoire. Le
+//    champ h contient deux valeurs de hachage de la ligne, de graines
+//    différentes, le champ off la position de sa première occurrence dans le
+//    premier fichier et le champ cpt son tableau de compteurs. Une même
+//    empreinte sert de clé et de valeur dans la table, seul le champ h
+//    intervenant dans la comparaison et le hachage des clés.
+struct fingerprint {
+  uint64_t h[2];
+  off_t off;
+  cnt *cpt;
+};
+
+//  struct pending : ligne complète en attente de traitement. Les champs start
+//    et dslen donnent la position de son contenu dans le tampon des lignes et
+//    sa longueur, fin de chaîne comprise, les champs nbline et off son numéro
+//    et sa position dans son fichier. Le champ fp reçoit, en mode économe en
+//    mémoire, son empreinte. Le champ resolved est vrai lorsque le résultat de
+//    la recherche de la ligne dans la table est connu et définitif : le champ
+//    val vaut alors le tableau de compteurs ou, en mode économe en mémoire,
+//    l'empreinte trouvés, NULL si la ligne est absente. Le champ h reçoit la
+//    valeur de hachage de graine nulle de la ligne ; le champ dup est vrai si
+//    la ligne est égale à la ligne en attente qui la précède, dont elle
+//    partage alors le résultat de la recherche sans avoir été hachée.
+struct pending {
+  size_t start;
+  size_t dslen;
+  int nbline;
+  off_t off;
+  struct fingerprint fp;
+  uint64_t h;
+  bool dup;
+  bool resolved;
+  void *val;
+};
+
+//  struct hotslot : emplacement de l'antémémoire des lignes fréquentes. Le
+//    champ val vaut la valeur de la table, tableau de compteurs ou, en mode
+//    économe en mémoire, empreinte, d'une ligne de valeur de hachage h et de
+//    longueur dslen, fin de chaîne comprise, NULL si l'emplacement est libre.
+//    Le champ key vaut la clé de la ligne dans la table, hors mode économe en
+//    mémoire.
+struct hotslot {
+  uint64_t h;
+  size_t dslen;
+  const char *key;
+  void *val;
+};
+
+//  struct sortrec : enregistrement d'une ligne pour le moteur par tri. Les
+//    champs h et h2 sont deux valeurs de hachage de la ligne, de graines
+//    différentes, la seconde réduite à 32 bits, le champ pos code la position
+//    de son fichier dans l'ordre de traitement et sa position dans ce fichier,
+//    voir LNID__SORT_FILE_BITS, et le champ nbline est son numéro. Le champ h,
+//    premier champ, est la clé du tri par base.
+struct sortrec {
+  uint64_t h;
+  uint64_t pos;
+  uint32_t h2;
+  uint32_t nbline;
+};
+
+//  Les champs tail, lowmem et sort indiquent les options LNID_TAIL, LNID_LOWMEM
+//    et LNID_SORT. Les champs filter et upper sont la classe et l'indicateur
+//    de passage en majuscules appliqués aux lignes. Le champ arena est, avec
+//    l'option LNID_HUGEPAGES, l'entrepôt des blocs alloués par lnid__entry,
+//    libéré d'un seul tenant avec la table ; il vaut NULL sinon. Le champ
+//    line est la fonction de l'utilisateur confiée par lnid_lines, NULL si
+//    aucune, appelée avec le champ linecontext.
+
+//  Le champ source est le descripteur de la source, -1 si aucune, et le champ
+//    verify indique la vérification des empreintes demandée par lnid_verify.
+//    Les lignes relues par lnid_reread le sont dans le tampon reread, de
+//    capacité rereadcap, pour y être filtrées et transformées comme les
+//    lignes lues.
+
+//  Lorsqu'un index tient lieu de table, le champ ix lui est associé et le
+//    champ icpt est un tableau de compteurs à deux dimensions : le compteur du
+//    fichier de position p pour la ligne de rang i de l'index est
+//    icpt[i * nfiles + p]. Le champ ix vaut NULL sinon.
+
+//  Les champs offset et nbline mémorisent, pour chaque fichier, la position
+//    qui suit la dernière ligne traitée et le numéro de celle-ci. Le champ cur
+//    est la position du fichier en cours de traitement, nfiles si aucun. Pour
+//    ce fichier, le champ pos est la position du prochain octet passé, le
+//    champ off celle qui suit la dernière fin de ligne lue et le champ next le
+//    numéro de la ligne en cours de lecture.
+
+//  Les champs st, ht et bf regroupent l'état du traitement : la table qui
+//    associe à chaque ligne son tableau de compteurs, st ou, en mode économe en
+//    mémoire, ht, et l'éventuel filtre de Bloom des lignes de la table,
+//    construit sur ses bfkeys clés d'alors. Chaque clé de la table est le
+//    début d'un bloc alloué par lnid__entry qui contient aussi son tableau de
+//    compteurs : la table, parcourue dans l'ordre de ses ajouts ou dans
+//    l'ordre inverse, permet seule de les retrouver.
+
+//  Les champs prunelen, drop et ndrop servent au retrait par lnid__prune des
+//    lignes de la table absentes d'un fichier : seules sont conservées celles
+//    de prunelen compteurs ; en mode économe en mémoire, les empreintes des
+//    autres sont d'abord rangées dans les ndrop premières composantes de drop.
+//    Le champ npruned compte les lignes ainsi retirées et le champ exhausted
+//    est vrai si aucune ne reste après le retrait de la fin d'un fichier.
+
+//  Le champ order est la position du fichier d'ordre du résultat, voir
+//    lnid_order.
+
+//  Avec le moteur par tri, aucune table n'est construite : chaque ligne lue
+//    est décrite par un enregistrement ajouté au tableau recs, de capacité
+//    caprecs, dont les nrecs premières composantes sont occupées.
+
+//  Les lignes lues sont accumulées dans le tampon lines, de capacité linescap,
+//    dont les lineslen premiers octets sont occupés. Les lignes complètes y
+//    sont mises en attente, décrites par les npend premières composantes de
+//    pend, et la ligne en cours de lecture commence à la position linestart.
+//    Les lignes en attente sont traitées par groupes de LNID__BATCH : les
+//    recherches d'un groupe dans la table sont menées de front, ce qui
+//    recouvre leurs défauts de cache, avant que ses lignes ne soient traitées
+//    une à une dans leur ordre de lecture. Les octets des lignes sont copiés
+//    tels quels dans le tampon ; la classe et le passage en majuscules sont
+//    appliqués à chaque ligne complète, qui contient tous les octets de ses
+//    caractères UTF-8.
+
+//  Les lignes très fréquentes, comme les messages périodiques des journaux,
+//    sont retrouvées sans recherche dans la table : une ligne égale à celle
+//    qui la précède dans le groupe en attente en partage le résultat, et les
+//    lignes récemment trouvées dans la table sont mémorisées dans
+//    l'antémémoire hot, à correspondance directe, indexée par les bits de
+//    poids faible de leur valeur de hachage. Les champs hotprev, hothits et
+//    hotlookups comptent respectivement les lignes résolues par la ligne
+//    précédente, les lignes résolues par l'antémémoire et les lignes
+//    cherchées dans l'antémémoire, chaque ligne au plus une fois. Le champ
+//    hoton est vrai si l'antémémoire est consultée pour le groupe en attente,
+//    le champ hotskip donne le nombre de groupes pour lesquels elle ne le
+//    sera pas et les champs hotwin et hotwinhits comptent les recherches et
+//    les succès depuis la dernière décision.
+
+struct lnid {
+  size_t nfiles;
+  bool tail;
+  bool lowmem;
+  bool sort;
+  utf8class filter;
+  bool upper;
+  hugemem_arena *arena;
+  void *linecontext;
+  int (*line)(void *, size_t, const char *, size_t, int, off_t);
+  int source;
+  bool verify;
+  char *reread;
+  size_t rereadcap;
+  idx *ix;
+  int *icpt;
+  off_t *offset;
+  int *nbline;
+  size_t cur;
+  off_t pos;
+  off_t off;
+  int next;
+  strtab st;
+  hashtable *ht;
+  bloom *bf;
+  size_t bfkeys;
+  size_t prunelen;
+  struct fingerprint **drop;
+  size_t ndrop;
+  size_t npruned;
+  bool exhausted;
+  size_t order;
+  struct sortrec *recs;
+  size_t nrecs;
+  size_t caprecs;
+  char *lines;
+  size_t linescap;
+  size_t lineslen;
+  size_t linestart;
+  struct pending pend[LNID__BATCH];
+  size_t npend;
+  struct hotslot hot[LNID__HOT_NSLOTS];
+  uint64_t hotprev;
+  uint64_t hothits;
+  uint64_t hotlookups;
+  bool hoton;
+  size_t hotskip;
+  size_t hotwin;
+  size_t hotwinhits;
+};
+
+//--- Fonctions auxiliaires ----------------------------------------------------
+
+uint64_t lnid_hash64(const char *s, size_t len, uint64_t seed) {
+  const uint64_t m = 0x9E3779B97F4A7C15ULL;
+  uint64_t h = (len ^ seed) * m;
+  size_t k = 0;
+  for (; k + sizeof(uint64_t) <= len; k += sizeof(uint64_t)) {
+    uint64_t w;
+    memcpy(&w, s + k, sizeof w);
+    h = (h ^ w) * m;
+    h ^= h >> 29;
+  }
+  uint64_t w = 0;
+  memcpy(&w, s + k, len - k);
+  h = (h ^ w) * m;
+  h ^= h >> 32;
+  h *= 0xD6E8FEB86659FD93ULL;
+  return h ^ (h >> 32);
+}
+
+static int lnid__fingerprint_compar(const struct fingerprint *a,
+    const struct fingerprint *b) {
+  return memcmp(a->h, b->h, sizeof a->h);
+}
+
+static size_t lnid__fingerprint_hashfun(const struct fingerprint *a) {
+  return (size_t) a->h[0];
+}
+
+//  lnid__entry : Tente d'allouer d'un seul bloc, dans l'entrepôt a ou par
+//    malloc si a vaut NULL, une copie de la clé t de taille dslen et, à sa
+//    suite, une structure entrytail de tableau de compteurs vide. Affecte à
+//    *key l'adresse de la copie, qui est aussi celle du bloc. Le bloc doit
+//    ensuite être ajouté à la table ou libéré à l'aide de lnid__discard.
+//  Renvoie le tableau de compteurs en cas de succès, NULL en cas de
+//    dépassement de capacité.
+static cnt *lnid__entry(hugemem_arena *a, const char *t, size_t dslen,
+    char **key) {
+  size_t off = LNID__ENTRY_OFFSET(dslen);
+  if (off < dslen || off > SIZE_MAX - sizeof(struct entrytail)) {
+    return NULL;
+  }
+  char *k = (a == NULL ? malloc(off + sizeof(struct entrytail))
+      : hugemem_arena_alloc(a, off + sizeof(struct entrytail)));
+  if (k == NULL) {
+    return NULL;
+  }
+  memcpy(k, t, dslen);
+  cnt *cpt = (cnt *) (k + off);
+  cnt_init(cpt);
+  LNID__TAIL(cpt)->first = 0;
+  *key = k;
+  return cpt;
+}
+
+//  lnid__discard : Libère les ressources allouées à la gestion du bloc key,
+//    alloué par lnid__entry dans l'entrepôt a, et de son tableau de compteurs
+//    cpt. Un bloc alloué dans un entrepôt n'est libéré qu'avec lui.
+static void lnid__discard(hugemem_arena *a, char *key, cnt *cpt) {
+  cnt_dispose(cpt);
+  if (a == NULL) {
+    free(key);
+  }
+}
+
+//  lnid__free : Libère les ressources allouées à la gestion du bloc de clé key
+//    et de valeur val dans la table de s. Renvoie zéro.
+static int lnid__free(lnid *s, const void *key, void *val) {
+  cnt_dispose(s->lowmem ? ((struct fingerprint *) val)->cpt : val);
+  if (s->arena == NULL) {
+    free((void *) key);
+  }
+  return 0;
+}
+
+//  lnid__table_apply : Parcourt la table de s en appelant fun(context, key,
+//    val) pour chacune de ses clés key, de valeur val, dans l'ordre inverse de
+//    leur ajout si reverse est vrai, dans l'ordre de leur ajout sinon. Renvoie
+//    la première valeur non nulle renvoyée par fun, zéro si aucune ne l'est.
+static int lnid__table_apply(lnid *s, bool reverse, void *context,
+    int (*fun)(void *, const void *, void *)) {
+  if (s->lowmem) {
+    return reverse ? hashtable_apply_reverse(s->ht, context, fun)
+      : hashtable_apply(s->ht, context, fun);
+  }
+  int (*f)(void *, const char *, cnt *)
+    = (int (*)(void *, const char *, cnt *))fun;
+  return reverse ? strtab_apply_reverse(&s->st, context, f)
+    : strtab_apply(&s->st, context, f);
+}
+
+//--- Gestion de la session ----------------------------------------------------
+
+lnid *lnid_empty(size_t nfiles, unsigned flags, utf8class filter,
+    bool upper) {
+  lnid *s = malloc(sizeof *s);
+  if (s == NULL) {
+    return NULL;
+  }
+  *s = (struct lnid) {
+    .nfiles = nfiles, .tail = (flags & LNID_TAIL) != 0,
+    .lowmem = (flags & LNID_LOWMEM) != 0, .sort = (flags & LNID_SORT) != 0,
+    .filter = filter, .upper = upper, .arena = NULL, .linecontext = NULL,
+    .line = NULL, .source = -1, .verify = false, .reread = NULL,
+    .rereadcap = 0, .ix = NULL, .icpt = NULL,
+    .offset = calloc(nfiles, sizeof *s->offset),
+    .nbline = calloc(nfiles, sizeof *s->nbline), .cur = nfiles,
+    .pos = 0, .off = 0, .next = 0, .ht = NULL, .bf = NULL, .bfkeys = 0,
+    .prunelen = 0, .drop = NULL, .ndrop = 0, .npruned = 0, .exhausted = false,
+    .order = 0, .recs = NULL, .nrecs = 0, .caprecs = 0, .lines = NULL,
+    .linescap = 0, .lineslen = 0, .linestart = 0, .npend = 0,
+    .hot = { { .val = NULL } }, .hotprev = 0, .hothits = 0, .hotlookups = 0,
+    .hoton = false, .hotskip = 0, .hotwin = 0, .hotwinhits = 0
+  };
+  strtab_init(&s->st);
+  if (s->offset == NULL || s->nbline == NULL) {
+    goto error;
+  }
+  if ((flags & LNID_HUGEPAGES) != 0
+      && (s->arena = hugemem_arena_empty()) == NULL) {
+    goto error;
+  }
+  if (s->lowmem) {
+    s->ht = hashtable_empty(
+        (int (*)(const void *, const void *))lnid__fingerprint_compar,
+        (size_t (*)(const void *))lnid__fingerprint_hashfun);
+    if (s->ht == NULL) {
+      goto error;
+    }
+  }
+  return s;
+error:
+  lnid_dispose(&s);
+  return NULL;
+}
+
+void lnid_dispose(lnid **sptr) {
+  if (*sptr == NULL) {
+    return;
+  }
+  lnid *s = *sptr;
+  if (!s->lowmem || s->ht != NULL) {
+    lnid__table_apply(s, false, s,
+        (int (*)(void *, const void *, void *))lnid__free);
+  }
+  strtab_dispose(&s->st);
+  hashtable_dispose(&s->ht);
+  hugemem_arena_dispose(&s->arena);
+  bloom_dispose(&s->bf);
+  hugemem_free(s->recs);
+  free(s->lines);
+  free(s->reread);
+  idx_dispose(&s->ix);
+  free(s->icpt);
+  free(s->offset);
+  free(s->nbline);
+  free(s);
+  *sptr = NULL;
+}
+
+void lnid_order(lnid *s, size_t p) {
+  s->order = p;
+}
+
+void lnid_lines(lnid *s, void *context, int (*line)(void *context,
+    size_t p, const char *t, size_t len, int nbline, off_t off)) {
+  s->linecontext = context;
+  s->line = line;
+}
+
+void lnid_source(lnid *s, int fd) {
+  s->source = fd;
+}
+
+void lnid_verify(lnid *s) {
+  s->verify = true;
+}
+
+lnidret lnid_reread(lnid *s, int fd, off_t off, const char **t,
+    size_t *len) {
+  size_t n = 0;
+  bool eol = false;
+  while (!eol) {
+    if (s->rereadcap - n < LNID__REREAD_BUFSIZE) {
+      if (s->rereadcap > SIZE_MAX / 2) {
+        return LNID_ECAP;
+      }
+      size_t m = (s->rereadcap == 0 ? LNID__REREAD_BUFSIZE : 2 * s->rereadcap);
+      char *a = realloc(s->reread, m);
+      if (a == NULL) {
+        return LNID_ECAP;
+      }
+      s->reread = a;
+      s->rereadcap = m;
+    }
+    ssize_t r = pread(fd, s->reread + n, LNID__REREAD_BUFSIZE, off);
+    if (r < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return LNID_EREAD;
+    }
+    if (r == 0) {
+      break;
+    }
+    const char *nl = memchr(s->reread + n, '\n', (size_t) r);
+    eol = (nl != NULL);
+    n = (eol ? (size_t) (nl - s->reread) : n + (size_t) r);
+    off += r;
+  }
+  //  Chaque lecture laisse au moins LNID__REREAD_BUFSIZE octets libres avant
+  //    elle : la fin de chaîne trouve sa place.
+  if (s->filter != UTF8_ANY || s->upper) {
+    n = utf8_map(s->reread, n, s->filter, s->upper);
+  }
+  s->reread[n] = '\0';
+  *t = s->reread;
+  *len = strlen(s->reread);
+  return LNID_OK;
+}
+
+int lnid_extend(lnid *s, size_t nfiles) {
+  if (nfiles > SIZE_MAX / sizeof *s->offset) {
+    return -1;
+  }
+  off_t *offset = realloc(s->offset, nfiles * sizeof *offset);
+  if (offset == NULL) {
+    return -1;
+  }
+  s->offset = offset;
+  int *nbline = realloc(s->nbline, nfiles * sizeof *nbline);
+  if (nbline == NULL) {
+    return -1;
+  }
+  s->nbline = nbline;
+  for (size_t p = s->nfiles; p < nfiles; ++p) {
+    s->offset[p] = 0;
+    s->nbline[p] = 0;
+  }
+  s->nfiles = nfiles;
+  s->cur = nfiles;
+  return 0;
+}
+
+void lnid_seek(lnid *s, size_t p, off_t off, int nbline) {
+  s->offset[p] = off;
+  s->nbline[p] = nbline;
+}
+
+off_t lnid_tell(const lnid *s, size_t p, int *nbline) {
+  if (nbline != NULL) {
+    *nbline = s->nbline[p];
+  }
+  return s->offset[p];
+}
+
+size_t lnid_count(const lnid *s) {
+  return s->lowmem ? hashtable_count(s->ht) : strtab_count(&s->st);
+}
+
+bool lnid_exhausted(const lnid *s) {
+  return s->exhausted;
+}
+
+void lnid_stats(const lnid *s, struct lnid_stats *st) {
+  *st = (struct lnid_stats) {
+    .lines = lnid_count(s), .records = s->nrecs, .pruned = s->npruned,
+    .hotprev = s->hotprev, .hothits = s->hothits,
+    .hotlookups = s->hotlookups
+  };
+}
+
+//--- Traitement des lignes ----------------------------------------------------
+
+//  lnid__hot_lookup : Recherche dans l'antémémoire de s la ligne t en attente
+//    pointée par pd, dont les champs dslen, h et, en mode économe en mémoire,
+//    fp sont renseignés. Renvoie sa valeur dans la table si elle y figure,
+//    NULL sinon.
+static void *lnid__hot_lookup(lnid *s, const struct pending *pd,
+    const char *t) {
+  const struct hotslot *e = &s->hot[pd->h & (LNID__HOT_NSLOTS - 1)];
+  if (e->val != NULL && e->h == pd->h && e->dslen == pd->dslen
+      && (s->lowmem
+      ? ((const struct fingerprint *) e->val)->h[1] == pd->fp.h[1]
+      : memcmp(e->key, t, pd->dslen) == 0)) {
+    return e->val;
+  }
+  return NULL;
+}
+
+//  lnid__hot_store : Mémorise dans l'antémémoire de s la valeur val, non NULL,
+//    trouvée dans la table pour la ligne t en attente pointée par pd, dont les
+//    champs dslen et h sont renseignés.
+static void lnid__hot_store(lnid *s, const struct pending *pd, const char *t,
+    void *val) {
+  //  Hors mode économe en mémoire, la clé précède le tableau de compteurs
+  //    dans le bloc alloué par lnid__entry. La table compare les clés comme
+  //    des chaînes : celle trouvée pour une ligne qui contient un caractère
+  //    nul est plus courte que la ligne et sa position ne se déduit pas de
+  //    dslen. Une telle ligne n'est pas mémorisée.
+  if (!s->lowmem && strlen(t) + 1 != pd->dslen) {
+    return;
+  }
+  s->hot[pd->h & (LNID__HOT_NSLOTS - 1)] = (struct hotslot) {
+    .h = pd->h, .dslen = pd->dslen,
+    .key = (s->lowmem ? NULL
+        : (const char *) val - LNID__ENTRY_OFFSET(pd->dslen)),
+    .val = val
+  };
+}
+
+//  lnid__resolve : Recherche de front dans la table de s les lignes en
+//    attente, lues dans le fichier en cours de traitement, et renseigne leurs
+//    champs fp, resolved et val. Une recherche négative n'est définitive que si
+//    aucune ligne n'est ajoutée à la table pendant le traitement du fichier :
+//    une ligne précédente du même groupe pourrait sinon être égale à la ligne
+//    cherchée. Les lignes résolues par la ligne précédente ou par
+//    l'antémémoire, si elle est consultée pour ce groupe, ne sont pas
+//    cherchées. Sans effet si la session ne fait pas usage de la table.
+static void lnid__resolve(lnid *s) {
+  if (s->line != NULL || s->sort || s->ix != NULL) {
+    return;
+  }
+  //  Les lignes que le filtre de Bloom écarte sont absentes de la table ; les
+  //    autres sont cherchées de front. Les lignes trouvées le restent jusqu'à
+  //    la fin du fichier : la table ne fait que croître pendant son traitement
+  //    et ses valeurs ne sont jamais remplacées. Les retraits de lnid__prune,
+  //    entre deux fichiers, vident l'antémémoire, dont les valeurs restent
+  //    ainsi valides.
+  bool final = (s->cur > 0 && !s->tail);
+  if (s->hotwin >= LNID__HOT_WINDOW) {
+    if (s->hotwinhits * LNID__HOT_MINRATE < s->hotwin) {
+      s->hotskip = LNID__HOT_SKIP;
+    }
+    s->hotwin = 0;
+    s->hotwinhits = 0;
+  }
+  s->hoton = (s->hotskip == 0);
+  if (!s->hoton) {
+    --s->hotskip;
+  }
+  size_t m = 0;
+  size_t w[LNID__BATCH];
+  const char *keys[LNID__BATCH];
+  const void *fps[LNID__BATCH];
+  for (size_t i = 0; i < s->npend; ++i) {
+    struct pending *pd = &s->pend[i];
+    const char *t = s->lines + pd->start;
+    pd->resolved = false;
+    pd->val = NULL;
+    pd->dup = (i > 0 && pd->dslen == pd[-1].dslen
+        && memcmp(t, s->lines + pd[-1].start, pd->dslen) == 0);
+    if (pd->dup) {
+      ++s->hotprev;
+      continue;
+    }
+    if (s->hoton || s->bf != NULL || s->lowmem) {
+      pd->h = lnid_hash64(t, pd->dslen - 1, 0);
+    }
+    if (s->lowmem) {
+      pd->fp = (struct fingerprint) {
+        .h = { pd->h, lnid_hash64(t, pd->dslen - 1, LNID_SEED) },
+        .off = pd->off, .cpt = NULL
+      };
+    }
+    if (s->hoton) {
+      ++s->hotlookups;
+      ++s->hotwin;
+      if ((pd->val = lnid__hot_lookup(s, pd, t)) != NULL) {
+        ++s->hothits;
+        ++s->hotwinhits;
+        pd->resolved = true;
+        continue;
+      }
+    }
+    if (s->bf != NULL && !bloom_contains(s->bf, pd->h)) {
+      pd->resolved = true;
+      continue;
+    }
+    w[m] = i;
+    keys[m] = t;
+    fps[m] = &pd->fp;
+    ++m;
+  }
+  void *vals[LNID__BATCH];
+  if (m > 0 && s->lowmem) {
+    hashtable_search_batch(s->ht, fps, m, vals);
+  } else if (m > 0) {
+    cnt **v[LNID__BATCH];
+    strtab_search_batch(&s->st, keys, m, v);
+    for (size_t j = 0; j < m; ++j) {
+      vals[j] = (v[j] == NULL ? NULL : *v[j]);
+    }
+  }
+  for (size_t j = 0; j < m; ++j) {
+    struct pending *pd = &s->pend[w[j]];
+    pd->val = vals[j];
+    pd->resolved = (vals[j] != NULL || final);
+    if (vals[j] != NULL && s->hoton) {
+      lnid__hot_store(s, pd, s->lines + pd->start, vals[j]);
+    }
+  }
+  for (size_t i = 1; i < s->npend; ++i) {
+    struct pending *pd = &s->pend[i];
+    if (pd->dup) {
+      pd->h = pd[-1].h;
+      pd->fp = pd[-1].fp;
+      pd->fp.off = pd->off;
+      pd->resolved = pd[-1].resolved;
+      pd->val = pd[-1].val;
+    }
+  }
+}
+
+//  lnid__insert : Ajoute à la table de s la clé t de longueur dslen, fin de
+//    chaîne comprise, ou l'empreinte t de taille dslen en mode économe en
+//    mémoire, lue dans le fichier en cours de traitement où elle porte le
+//    numéro nbline, associée à un nouveau tableau de compteurs.
+//  Renvoie zéro en cas de succès, une valeur négative en cas de dépassement de
+//    capacité.
+static int lnid__insert(lnid *s, const char *t, size_t dslen, int nbline) {
+  char *key;
+  cnt *cpt = lnid__entry(s->arena, t, dslen, &key);
+  if (cpt == NULL) {
+    return -1;
+  }
+  if (s->nfiles == 1) {
+    if (cnt_add(cpt, nbline) != 0) {
+      goto error;
+    }
+  } else if (!s->tail) {
+    if (cnt_add(cpt, 1) != 0) {
+      goto error;
+    }
+  } else {
+    //  En mode incrémental, une ligne peut apparaître dans un fichier avant
+    //    d'apparaître dans les autres : chaque fichier a son compteur.
+    if (cnt_reserve(cpt, s->nfiles) != 0) {
+      goto error;
+    }
+    for (size_t k = 0; k < s->nfiles; ++k) {
+      if (cnt_add(cpt, k == s->cur) != 0) {
+        goto error;
+      }
+    }
+  }
+  if (s->lowmem) {
+    struct fingerprint *fp = (struct fingerprint *) key;
+    fp->cpt = cpt;
+    if (hashtable_add(s->ht, fp, fp) == NULL) {
+      goto error;
+    }
+  } else if (strtab_add(&s->st, key, cpt) != 0) {
+    goto error;
+  }
+  return 0;
+error:
+  lnid__discard(s->arena, key, cpt);
+  return -1;
+}
+
+//  lnid__sort_add : Ajoute au tableau des enregistrements du moteur par tri de
+//    s celui de la ligne t en attente pointée par pd.
+//  Renvoie zéro en cas de succès, une valeur négative en cas de dépassement de
+//    capacité.
+static int lnid__sort_add(lnid *s, const struct pending *pd, const char *t) {
+  if (s->nrecs == s->caprecs) {
+    size_t cap = (s->caprecs == 0 ? LNID__SORT_CAP_MIN : 2 * s->caprecs);
+    if (cap > SIZE_MAX / sizeof *s->recs) {
+      return -1;
+    }
+    struct sortrec *a = hugemem_realloc(s->recs, cap * sizeof *a);
+    if (a == NULL) {
+      return -1;
+    }
+    s->recs = a;
+    s->caprecs = cap;
+  }
+  s->recs[s->nrecs] = (struct sortrec) {
+    .h = lnid_hash64(t, pd->dslen - 1, 0),
+    .pos = ((uint64_t) s->cur << LNID__SORT_OFF_BITS)
+        | ((uint64_t) pd->off & LNID__SORT_OFF_MASK),
+    .h2 = (uint32_t) lnid_hash64(t, pd->dslen - 1, LNID_SEED),
+    .nbline = (uint32_t) pd->nbline
+  };
+  s->nrecs += 1;
+  return 0;
+}
+
+//  lnid__verify : Vérifie que la ligne de position off dans la source de s est
+//    égale à la chaîne t de longueur len.
+//  Renvoie zéro si c'est le cas, LNID_ECOLL si ce n'est pas le cas, une valeur
+//    négative en cas de dépassement de capacité et LNID_EREAD en cas d'erreur
+//    de lecture.
+static int lnid__verify(lnid *s, off_t off, const char *t, size_t len) {
+  const char *u;
+  size_t n;
+  lnidret e = lnid_reread(s, s->source, off, &u, &n);
+  if (e != LNID_OK) {
+    return e == LNID_ECAP ? -1 : (int) e;
+  }
+  return n == len && memcmp(u, t, len) == 0 ? 0 : LNID_ECOLL;
+}
+
+//  lnid__probe : Compte la ligne t de longueur len, lue dans le fichier en
+//    cours de traitement de s, si elle figure dans l'index de s et, hors le
+//    fichier de position 0, dans le fichier de position précédente.
+static void lnid__probe(lnid *s, const char *t, size_t len) {
+  size_t i = idx_search(s->ix, lnid_hash64(t, len, 0), t, len);
+  if (i == IDX_NONE) {
+    return;
+  }
+  int *cpt = s->icpt + i * s->nfiles;
+  size_t p = s->cur;
+  if (p == 0 || cpt[p - 1] > 0) {
+    cpt[p] += 1;
+  }
+}
+
+//  lnid__line : Traite la ligne en attente pointée par pd. Si la session fait
+//    usage de la table, lnid__resolve doit avoir été appelée sur son groupe.
+static int lnid__line(lnid *s, struct pending *pd) {
+  const char *t = s->lines + pd->start;
+  size_t dslen = pd->dslen;
+  int nbline = pd->nbline;
+  if (s->ix != NULL) {
+    lnid__probe(s, t, dslen - 1);
+    return 0;
+  }
+  if (s->line != NULL) {
+    return s->line(s->linecontext, s->cur, t, dslen - 1, nbline, pd->off);
+  }
+  if (s->sort) {
+    return lnid__sort_add(s, pd, t);
+  }
+  if (!pd->resolved && s->hoton
+      && (pd->val = lnid__hot_lookup(s, pd, t)) != NULL) {
+    s->hothits += !pd->dup;
+    s->hotwinhits += !pd->dup;
+  } else if (!pd->resolved) {
+    if (s->lowmem) {
+      pd->val = hashtable_search(s->ht, &pd->fp);
+    } else {
+      cnt **v = strtab_search(&s->st, t);
+      pd->val = (v == NULL ? NULL : *v);
+    }
+    if (pd->val != NULL && s->hoton) {
+      lnid__hot_store(s, pd, t, pd->val);
+    }
+  }
+  cnt *cpt = pd->val;
+  if (s->lowmem && pd->val != NULL) {
+    const struct fingerprint *f = pd->val;
+    int r;
+    if (s->verify && (r = lnid__verify(s, f->off, t, dslen - 1)) != 0) {
+      return r;
+    }
+    cpt = f->cpt;
+  }
+  size_t p = s->cur;
+  if (cpt == NULL) {
+    if (p == 0 || s->tail) {
+      return s->lowmem
+        ? lnid__insert(s, (const char *) &pd->fp, sizeof pd->fp, nbline)
+        : lnid__insert(s, t, dslen, nbline);
+    }
+    return 0;
+  }
+  if (s->nfiles == 1) {
+    return cnt_add(cpt, nbline) == 0 ? 0 : -1;
+  }
+  if (s->tail || cnt_length(cpt) == p + 1) {
+    *cnt_ref(cpt, p) += 1;
+  } else if (cnt_length(cpt) == p) {
+    //  Première occurrence dans le fichier de position p d'une ligne présente
+    //    dans tous les fichiers précédents : ajout d'un compteur.
+    if (p == s->order) {
+      LNID__TAIL(cpt)->first = nbline;
+    }
+    return cnt_add(cpt, 1) == 0 ? 0 : -1;
+  }
+  return 0;
+}
+
+//  lnid__flush : Traite les lignes en attente de s : mène de front leurs
+//    recherches dans la table à l'aide de lnid__resolve puis les traite une à
+//    une à l'aide de lnid__line dans leur ordre de lecture. Vide ensuite le
+//    tampon des lignes, qui ne doit pas contenir de ligne en cours de lecture.
+static int lnid__flush(lnid *s) {
+  lnid__resolve(s);
+  for (size_t i = 0; i < s->npend; ++i) {
+    int r = lnid__line(s, &s->pend[i]);
+    if (r != 0) {
+      return r;
+    }
+  }
+  s->npend = 0;
+  s->lineslen = 0;
+  s->linestart = 0;
+  return 0;
+}
+
+//  lnid__append : Ajoute les n octets de t, sans filtre ni transformation, au
+//    tampon des lignes de s.
+//  Renvoie zéro en cas de succès, une valeur négative en cas de dépassement de
+//    capacité.
+static int lnid__append(lnid *s, const char *t, size_t n) {
+  if (s->linescap - s->lineslen < n) {
+    size_t m = (s->linescap == 0 ? LNID__LINES_CAP_MIN : s->linescap);
+    while (m - s->lineslen < n) {
+      if (m > SIZE_MAX / 2) {
+        return -1;
+      }
+      m *= 2;
+    }
+    char *a = realloc(s->lines, m);
+    if (a == NULL) {
+      return -1;
+    }
+    s->lines = a;
+    s->linescap = m;
+  }
+  memcpy(s->lines + s->lineslen, t, n);
+  s->lineslen += n;
+  return 0;
+}
+
+//  lnid__endline : Termine la ligne en cours de lecture de s, lui applique la
+//    classe et le passage en majuscules de s et la met en attente si elle
+//    n'est pas vide. Traite les lignes en attente à l'aide de lnid__flush si
+//    elles sont au nombre de LNID__BATCH.
+static int lnid__endline(lnid *s) {
+  if (s->filter != UTF8_ANY || s->upper) {
+    s->lineslen = s->linestart + utf8_map(s->lines + s->linestart,
+        s->lineslen - s->linestart, s->filter, s->upper);
+  }
+  if (s->lineslen == s->linestart) {
+    return 0;
+  }
+  if (lnid__append(s, "", 1) != 0) {
+    return -1;
+  }
+  //  Comme la table, qui compare ses clés comme des chaînes, toute la suite du
+  //    traitement ne retient de la ligne que ce qui précède son premier
+  //    caractère nul.
+  s->pend[s->npend] = (struct pending) {
+    .start = s->linestart, .dslen = strlen(s->lines + s->linestart) + 1,
+    .nbline = s->next, .off = s->off, .resolved = false, .val = NULL
+  };
+  ++s->npend;
+  s->linestart = s->lineslen;
+  return s->npend == LNID__BATCH ? lnid__flush(s) : 0;
+}
+
+//  lnid__bloom_addkey : Ajoute au filtre de Bloom de s la valeur de hachage de
+//    la clé key de la table de s ou, en mode économe en mémoire, la première
+//    valeur de hachage de l'empreinte key. Renvoie zéro.
+static int lnid__bloom_addkey(lnid *s, const void *key, void *val) {
+  (void) val;
+  if (s->lowmem) {
+    bloom_add(s->bf, ((const struct fingerprint *) key)->h[0]);
+  } else {
+    bloom_add(s->bf, lnid_hash64(key, strlen(key), 0));
+  }
+  return 0;
+}
+
+//  lnid__keep : Renvoie une valeur non nulle si la ligne de clé key et de
+//    tableau de compteurs cpt dans la table de s a s->prunelen compteurs.
+//    Libère sinon ses ressources à l'aide de lnid__free et renvoie zéro.
+static int lnid__keep(lnid *s, const char *key, cnt *cpt) {
+  if (cnt_length(cpt) == s->prunelen) {
+    return 1;
+  }
+  lnid__free(s, key, cpt);
+  return 0;
+}
+
+//  lnid__drop : Range l'empreinte fp de la table de s dans s->drop si son
+//    tableau de compteurs n'a pas s->prunelen compteurs. Renvoie zéro.
+static int lnid__drop(lnid *s, const void *key, struct fingerprint *fp) {
+  (void) key;
+  if (cnt_length(fp->cpt) != s->prunelen) {
+    s->drop[s->ndrop] = fp;
+    s->ndrop += 1;
+  }
+  return 0;
+}
+
+//  lnid__prune : Retire de la table de s, une fois traité le fichier de
+//    position p, les lignes qui en sont absentes : elles ne peuvent plus
+//    figurer dans le résultat. Vide alors l'antémémoire des lignes fréquentes
+//    et, si la table a au moins diminué de moitié depuis la construction du
+//    filtre de Bloom, reconstruit celui-ci ; le filtre précédent est conservé
+//    si la mémoire manque, de même que les lignes sont toutes conservées en
+//    mode économe en mémoire si le tableau drop ne peut être alloué.
+static void lnid__prune(lnid *s, size_t p) {
+  size_t n = lnid_count(s);
+  s->prunelen = p + 1;
+  if (s->lowmem) {
+    s->drop = malloc(n * sizeof *s->drop);
+    if (s->drop == NULL) {
+      return;
+    }
+    s->ndrop = 0;
+    hashtable_apply(s->ht, s,
+        (int (*)(void *, const void *, void *))lnid__drop);
+    for (size_t i = 0; i < s->ndrop; ++i) {
+      hashtable_remove(s->ht, s->drop[i]);
+      lnid__free(s, s->drop[i], s->drop[i]);
+    }
+    free(s->drop);
+    s->drop = NULL;
+    if (s->ndrop > 0) {
+      hashtable_compact(s->ht);
+    }
+  } else {
+    strtab_retain(&s->st, s, (int (*)(void *, const char *, cnt *))lnid__keep);
+  }
+  size_t m = lnid_count(s);
+  if (m == n) {
+    return;
+  }
+  s->npruned += n - m;
+  for (size_t i = 0; i < LNID__HOT_NSLOTS; ++i) {
+    s->hot[i].val = NULL;
+  }
+  if (m > 0 && m <= s->bfkeys / 2) {
+    bloom *bf = bloom_empty(m);
+    if (bf != NULL) {
+      bloom_dispose(&s->bf);
+      s->bf = bf;
+      s->bfkeys = m;
+      lnid__table_apply(s, false, s,
+          (int (*)(void *, const void *, void *))lnid__bloom_addkey);
+    }
+  }
+}
+
+int lnid_feed(lnid *s, size_t p, const char *buf, size_t n) {
+  if (p != s->cur) {
+    if (s->cur != s->nfiles) {
+      int r = lnid_end(s, s->cur);
+      if (r != 0) {
+        return r;
+      }
+    }
+    s->cur = p;
+    s->pos = s->offset[p];
+    s->off = s->offset[p];
+    s->next = s->nbline[p] + 1;
+  }
+  //  pos est la position dans le fichier du premier octet de buf, off celle qui
+  //    suit la dernière fin de ligne lue.
+  size_t i = 0;
+  const char *nl;
+  while (i < n && (nl = memchr(buf + i, '\n', n - i)) != NULL) {
+    size_t j = (size_t) (nl - buf);
+    if (lnid__append(s, buf + i, j - i) != 0) {
+      return -1;
+    }
+    int r = lnid__endline(s);
+    if (r != 0) {
+      return r;
+    }
+    ++s->next;
+    s->off = s->pos + (off_t) j + 1;
+    i = j + 1;
+  }
+  if (lnid__append(s, buf + i, n - i) != 0) {
+    return -1;
+  }
+  s->pos += (off_t) n;
+  return 0;
+}
+
+int lnid_end(lnid *s, size_t p) {
+  if (p != s->cur) {
+    int r = lnid_feed(s, p, "", 0);
+    if (r != 0) {
+      return r;
+    }
+  }
+  int r = 0;
+  if (s->tail) {
+    s->lineslen = s->linestart;
+  } else if (s->pos != s->off) {
+    r = lnid__endline(s);
+    ++s->next;
+    s->off = s->pos;
+  }
+  if (r == 0) {
+    r = lnid__flush(s);
+  }
+  s->offset[p] = s->off;
+  s->nbline[p] = s->next - 1;
+  s->cur = s->nfiles;
+  if (r != 0 || s->tail || s->line != NULL || s->sort || s->ix != NULL) {
+    return r;
+  }
+  //  Les lignes des fichiers suivants ne sont comptées que si elles figurent
+  //    déjà dans la table : la plupart étant absentes, un filtre de Bloom
+  //    construit sur les clés du premier fichier les écarte avant la recherche
+  //    dans la table. Après chacun des fichiers suivants, hors le dernier, les
+  //    lignes qui en sont absentes sont retirées.
+  if (p == 0 && s->nfiles > 1) {
+    s->bf = bloom_empty(lnid_count(s));
+    if (s->bf == NULL) {
+      return -1;
+    }
+    lnid__table_apply(s, false, s,
+        (int (*)(void *, const void *, void *))lnid__bloom_addkey);
+    s->bfkeys = lnid_count(s);
+  } else if (p > 0 && p + 1 < s->nfiles && s->bf != NULL) {
+    lnid__prune(s, p);
+    s->exhausted = (lnid_count(s) == 0);
+  }
+  return 0;
+}
+
+int lnid_restore(lnid *s, const char *t, const int *counts, size_t n) {
+  char *key;
+  cnt *cpt = lnid__entry(s->arena, t, strlen(t) + 1, &key);
+  if (cpt == NULL) {
+    return -1;
+  }
+  if (cnt_reserve(cpt, n) != 0) {
+    goto error;
+  }
+  for (size_t k = 0; k < n; ++k) {
+    if (cnt_add(cpt, counts[k]) != 0) {
+      goto error;
+    }
+  }
+  if (strtab_add(&s->st, key, cpt) != 0) {
+    goto error;
+  }
+  return 0;
+error:
+  lnid__discard(s->arena, key, cpt);
+  return -1;
+}
+
+//--- Production du résultat ---------------------------------------------------
+
+//  lnid__selected : Renvoie vrai si la ligne de n compteurs counts doit
+//    figurer dans le résultat de s, faux sinon.
+static bool lnid__selected(const lnid *s, const int *counts, size_t n) {
+  if (s->nfiles == 1) {
+    return n >= 2;
+  }
+  if (n < s->nfiles) {
+    return false;
+  }
+  for (size_t k = 0; k < s->nfiles; k++) {
+    if (counts[k] == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//  lnid__score : Renvoie le nombre total d'occurrences de la ligne de n
+//    compteurs counts de s.
+static size_t lnid__score(const lnid *s, const int *counts, size_t n) {
+  if (s->nfiles == 1) {
+    return n;
+  }
+  size_t score = 0;
+  for (size_t k = 0; k < s->nfiles; k++) {
+    score += (size_t) counts[k];
+  }
+  return score;
+}
+
+//  lnid__result : Affecte à *r la description de la ligne de clé key et de
+//    valeur val dans la table de s.
+static void lnid__result(const lnid *s, const void *key, void *val,
+    struct lnid_result *r) {
+  if (s->lowmem) {
+    const struct fingerprint *fp = val;
+    *r = (struct lnid_result) {
+      .text = NULL, .len = 0, .off = fp->off,
+      .counts = cnt_ref(fp->cpt, 0), .ncounts = cnt_length(fp->cpt),
+      .reread = false, .indexed = 0
+    };
+  } else {
+    *r = (struct lnid_result) {
+      .text = key, .len = strlen(key), .off = 0,
+      .counts = cnt_ref(val, 0), .ncounts = cnt_length(val),
+      .reread = false, .indexed = 0
+    };
+  }
+}
+
+//  lnid__emit : Passe à fun, avec context, la ligne r de s après avoir relu son
+//    contenu dans la source de s s'il n'est pas mémorisé et qu'elle existe.
+//  Renvoie la valeur renvoyée par fun, une valeur négative en cas de
+//    dépassement de capacité et LNID_EREAD en cas d'erreur de lecture.
+static int lnid__emit(lnid *s, struct lnid_result *r, void *context,
+    int (*fun)(void *, const struct lnid_result *)) {
+  if (r->text == NULL && s->source >= 0) {
+    lnidret e = lnid_reread(s, s->source, r->off, &r->text, &r->len);
+    if (e != LNID_OK) {
+      return e == LNID_ECAP ? -1 : (int) e;
+    }
+    r->reread = true;
+  }
+  return fun(context, r);
+}
+
+//  struct applying : contexte du parcours de la table par lnid_apply.
+struct applying {
+  lnid *s;
+  void *context;
+  int (*fun)(void *, const struct lnid_result *);
+};
+
+static int lnid__apply_one(struct applying *ap, const void *key, void *val) {
+  struct lnid_result r;
+  lnid__result(ap->s, key, val, &r);
+  return lnid__emit(ap->s, &r, ap->context, ap->fun);
+}
+
+int lnid_apply(lnid *s, bool reverse, void *context,
+    int (*fun)(void *context, const struct lnid_result *r)) {
+  struct applying ap = {
+    .s = s, .context = context, .fun = fun
+  };
+  return lnid__table_apply(s, reverse, &ap,
+      (int (*)(void *, const void *, void *))lnid__apply_one);
+}
+
+//  lnid__first : Renvoie le numéro de la première occurrence dans le fichier
+//    d'ordre de s de la ligne de valeur val dans la table de s.
+static int lnid__first(const lnid *s, const void *val) {
+  const cnt *cpt = (s->lowmem ? ((const struct fingerprint *) val)->cpt : val);
+  return LNID__TAIL(cpt)->first;
+}
+
+//  Le résultat est parcouru dans l'ordre inverse des ajouts à la table, qui
+//    est celui des premières occurrences des lignes dans le fichier de
+//    position 0. Lorsque le fichier d'ordre est un autre, les lignes retenues
+//    sont rangées dans un tableau de struct ordered puis triées par base sur
+//    le complément du numéro de leur première occurrence dans ce fichier, qui
+//    sert aussi de rang pour départager les candidats de même total.
+
+//  struct ordered : ligne retenue pour le résultat, de clé key et de valeur val
+//    dans la table, de rang rank, clé du tri par base.
+struct ordered {
+  uint64_t rank;
+  const void *key;
+  void *val;
+};
+
+//  struct ranked : une ligne candidate au résultat avec une valeur de top non
+//    nulle : sa clé et sa valeur dans la table, son nombre total d'occurrences
+//    et son rang dans l'ordre du parcours, qui départage les lignes de même
+//    total au profit de la première rencontrée.
+struct ranked {
+  const void *key;
+  void *val;
+  size_t score;
+  size_t rank;
+};
+
+static int lnid__ranked_compar(const struct ranked *a,
+    const struct ranked *b) {
+  if (a->score != b->score) {
+    return a->score < b->score ? -1 : 1;
+  }
+  return (a->rank < b->rank) - (a->rank > b->rank);
+}
+
+//  struct ranking : contexte du parcours du résultat par lnid_results. Les
+//    champs mincount, context et fun sont les paramètres de lnid_results. Le
+//    champ pool est un tableau de top + 1 candidats, dont ceux du tas h et
+//    celui pointé par spare, libre, qui reçoit le candidat suivant. Le champ
+//    rank est le rang de la ligne suivante. Le tas h vaut NULL si top est
+//    nul : les lignes retenues sont alors passées à fun au fil du parcours
+//    ou, si le fichier d'ordre de s n'est pas celui de position 0, rangées
+//    dans les nord premières composantes du tableau ord, de capacité capord.
+struct ranking {
+  lnid *s;
+  size_t mincount;
+  void *context;
+  int (*fun)(void *, const struct lnid_result *);
+  heap *h;
+  struct ranked *pool;
+  struct ranked *spare;
+  size_t rank;
+  struct ordered *ord;
+  size_t nord;
+  size_t capord;
+};
+
+//  lnid__ranking_init : Initialise le contexte rk du parcours du résultat de s
+//    pour les paramètres top, mincount, context et fun de lnid_results et
+//    affecte à *sorted un tableau de top candidats si top n'est pas nul.
+//    Renvoie zéro en cas de succès, une valeur négative en cas de dépassement
+//    de capacité.
+static int lnid__ranking_init(struct ranking *rk, lnid *s, size_t top,
+    size_t mincount, void *context,
+    int (*fun)(void *, const struct lnid_result *), struct ranked ***sorted) {
+  *rk = (struct ranking) {
+    .s = s, .mincount = mincount, .context = context, .fun = fun,
+    .h = NULL, .pool = NULL, .spare = NULL, .rank = 0, .ord = NULL,
+    .nord = 0, .capord = 0
+  };
+  *sorted = NULL;
+  if (top == 0) {
+    return 0;
+  }
+  if (top >= SIZE_MAX / sizeof *rk->pool
+      || (rk->pool = malloc((top + 1) * sizeof *rk->pool)) == NULL
+      || (*sorted = malloc(top * sizeof **sorted)) == NULL
+      || (rk->h = heap_empty(top,
+          (int (*)(const void *, const void *))lnid__ranked_compar)) == NULL) {
+    return -1;
+  }
+  rk->spare = rk->pool;
+  return 0;
+}
+
+//  lnid__ranking_offer : Propose au tas de rk le candidat de clé key, de valeur
+//    val, de nombre total d'occurrences score et de rang rank.
+static void lnid__ranking_offer(struct ranking *rk, const void *key,
+    void *val, size_t score, size_t rank) {
+  *rk->spare = (struct ranked) {
+    .key = key, .val = val, .score = score, .rank = rank
+  };
+  struct ranked *r = heap_offer(rk->h, rk->spare);
+  rk->spare = (r == NULL ? rk->pool + heap_count(rk->h) : r);
+}
+
+//  lnid__ranking_drain : Retire du tas de rk ses candidats et les range dans
+//    sorted par total décroissant. Renvoie leur nombre.
+static size_t lnid__ranking_drain(struct ranking *rk, struct ranked **sorted) {
+  //  Le tas restitue les candidats par total croissant.
+  size_t n = heap_count(rk->h);
+  for (size_t i = n; i > 0; --i) {
+    sorted[i - 1] = heap_pop(rk->h);
+  }
+  return n;
+}
+
+//  lnid__ranking_dispose : Libère les ressources allouées à la gestion de rk
+//    et de sorted.
+static void lnid__ranking_dispose(struct ranking *rk, struct ranked **sorted) {
+  heap_dispose(&rk->h);
+  free(rk->pool);
+  hugemem_free(rk->ord);
+  free(sorted);
+}
+
+//  lnid__ranking_keep : Range la ligne de clé key, de valeur val et de rang
+//    rank dans le tableau ord de rk. Renvoie zéro en cas de succès, une valeur
+//    négative en cas de dépassement de capacité.
+static int lnid__ranking_keep(struct ranking *rk, const void *key, void *val,
+    uint64_t rank) {
+  if (rk->nord == rk->capord) {
+    size_t cap = (rk->capord == 0 ? LNID__SORT_CAP_MIN : 2 * rk->capord);
+    struct ordered *a;
+    if (cap > SIZE_MAX / sizeof *a
+        || (a = hugemem_realloc(rk->ord, cap * sizeof *a)) == NULL) {
+      return -1;
+    }
+    rk->ord = a;
+    rk->capord = cap;
+  }
+  rk->ord[rk->nord] = (struct ordered) {
+    .rank = rank, .key = key, .val = val
+  };
+  rk->nord += 1;
+  return 0;
+}
+
+//  lnid__rank : Passe la ligne de clé key et de valeur val à la fonction de rk
+//    si elle doit figurer dans le résultat ou, avec un tas, la propose à
+//    celui-ci.
+static int lnid__rank(struct ranking *rk, const void *key, void *val) {
+  lnid *s = rk->s;
+  size_t rank = rk->rank;
+  rk->rank += 1;
+  struct lnid_result r;
+  lnid__result(s, key, val, &r);
+  if (!lnid__selected(s, r.counts, r.ncounts)) {
+    return 0;
+  }
+  if (s->order != 0) {
+    rank = (size_t) ~(uint64_t) lnid__first(s, val);
+  }
+  if (rk->h == NULL && rk->mincount == 0) {
+    return s->order != 0 ? lnid__ranking_keep(rk, key, val, rank)
+      : lnid__emit(s, &r, rk->context, rk->fun);
+  }
+  size_t score = lnid__score(s, r.counts, r.ncounts);
+  if (score < rk->mincount) {
+    return 0;
+  }
+  if (rk->h == NULL) {
+    return s->order != 0 ? lnid__ranking_keep(rk, key, val, rank)
+      : lnid__emit(s, &r, rk->context, rk->fun);
+  }
+  lnid__ranking_offer(rk, key, val, score, rank);
+  return 0;
+}
+
+//  lnid__ranking_sorted : Passe à la fonction de rk, par rang croissant, les
+//    lignes rangées dans le tableau ord de rk.
+static int lnid__ranking_sorted(struct ranking *rk) {
+  long nproc = sysconf(_SC_NPROCESSORS_ONLN);
+  void *tmp = NULL;
+  if (rk->nord > 0
+      && (tmp = hugemem_malloc(rk->nord * sizeof *rk->ord)) == NULL) {
+    return -1;
+  }
+  radix_sort(rk->ord, tmp, rk->nord, sizeof *rk->ord,
+      nproc < 1 ? 1 : (size_t) nproc);
+  hugemem_free(tmp);
+  for (size_t i = 0; i < rk->nord; ++i) {
+    struct lnid_result r;
+    lnid__result(rk->s, rk->ord[i].key, rk->ord[i].val, &r);
+    int e = lnid__emit(rk->s, &r, rk->context, rk->fun);
+    if (e != 0) {
+      return e;
+    }
+  }
+  return 0;
+}
+
+//  Avec le moteur par tri, les enregistrements sont triés par leur champ h
+//    puis, à champ h égal, par leur champ h2 : les lignes égales forment alors
+//    des suites contiguës, dans leur ordre de lecture, qui sont sélectionnées
+//    en un seul parcours. Les suites retenues sont ensuite triées par numéro
+//    décroissant de leur première ligne dans le fichier d'ordre, ce qui
+//    reproduit l'ordre du résultat de la table.
+
+//  struct sortgroup : suite des enregistrements de rangs start à end - 1 du
+//    tableau trié, qui décrivent une même ligne. Le champ key, clé du tri par
+//    base des suites, est le complément du numéro de sa première ligne dans
+//    le fichier d'ordre.
+struct sortgroup {
+  uint64_t key;
+  uint64_t start;
+  uint64_t end;
+};
+
+//  lnid__sort_settle : Trie par insertion, de manière stable, les n
+//    enregistrements du tableau a, de même champ h, par leur champ h2. Hors
+//    collision des valeurs h de lignes différentes, tous les champs h2 sont
+//    égaux et le tri se réduit à un parcours.
+static void lnid__sort_settle(struct sortrec *a, size_t n) {
+  for (size_t i = 1; i < n; ++i) {
+    if (a[i - 1].h2 <= a[i].h2) {
+      continue;
+    }
+    struct sortrec t = a[i];
+    size_t j = i;
+    while (j > 0 && a[j - 1].h2 > t.h2) {
+      a[j] = a[j - 1];
+      --j;
+    }
+    a[j] = t;
+  }
+}
+
+//  lnid__sort_selected : Renvoie vrai si la ligne décrite par les n
+//    enregistrements du tableau a, dans leur ordre de lecture, doit figurer
+//    dans le résultat de s, faux sinon. Les fichiers étant lus dans l'ordre de
+//    traitement, la ligne figure dans tous les fichiers si et seulement si les
+//    positions de leurs fichiers se suivent, sans lacune, de 0 à la dernière :
+//    la première doit être 0.
+static bool lnid__sort_selected(const lnid *s, const struct sortrec *a,
+    size_t n) {
+  if (s->nfiles == 1) {
+    return n >= 2;
+  }
+  if (a[0].pos >> LNID__SORT_OFF_BITS != 0) {
+    return false;
+  }
+  uint64_t q = 0;
+  for (size_t i = 1; i < n; ++i) {
+    uint64_t p = a[i].pos >> LNID__SORT_OFF_BITS;
+    if (p == q + 1) {
+      q = p;
+    } else if (p != q) {
+      return false;
+    }
+  }
+  return q == s->nfiles - 1;
+}
+
+//  lnid__sort_show : Passe à la fonction de rk la ligne décrite par la suite
+//    g, après avoir construit son tableau de compteurs.
+static int lnid__sort_show(struct ranking *rk, const struct sortgroup *g) {
+  lnid *s = rk->s;
+  const struct sortrec *a = s->recs;
+  cnt c;
+  cnt_init(&c);
+  int r = -1;
+  if (s->nfiles == 1) {
+    for (size_t i = g->start; i < g->end; ++i) {
+      if (cnt_add(&c, (int) a[i].nbline) != 0) {
+        goto dispose;
+      }
+    }
+  } else {
+    if (cnt_reserve(&c, s->nfiles) != 0) {
+      goto dispose;
+    }
+    for (size_t k = 0; k < s->nfiles; ++k) {
+      if (cnt_add(&c, 0) != 0) {
+        goto dispose;
+      }
+    }
+    for (size_t i = g->start; i < g->end; ++i) {
+      *cnt_ref(&c, a[i].pos >> LNID__SORT_OFF_BITS) += 1;
+    }
+  }
+  struct lnid_result res = {
+    .text = NULL, .len = 0,
+    .off = (off_t) (a[g->start].pos & LNID__SORT_OFF_MASK),
+    .counts = cnt_ref(&c, 0), .ncounts = cnt_length(&c), .reread = false,
+    .indexed = 0
+  };
+  r = lnid__emit(s, &res, rk->context, rk->fun);
+dispose:
+  cnt_dispose(&c);
+  return r;
+}
+
+//  lnid__sort_results : Variante de lnid_results pour le moteur par tri, de
+//    contexte de parcours rk et de tableau de candidats sorted.
+static int lnid__sort_results(struct ranking *rk, struct ranked **sorted) {
+  lnid *s = rk->s;
+  struct sortrec *a = s->recs;
+  size_t n = s->nrecs;
+  struct sortgroup *groups = NULL;
+  size_t ngroups = 0;
+  size_t capgroups = 0;
+  void *tmp = NULL;
+  int r = -1;
+  long nproc = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t nthreads = (nproc < 1 ? 1 : (size_t) nproc);
+  if (n > 0 && (tmp = hugemem_malloc(n * sizeof *a)) == NULL) {
+    goto dispose;
+  }
+  radix_sort(a, tmp, n, sizeof *a, nthreads);
+  hugemem_free(tmp);
+  tmp = NULL;
+  for (size_t i = 0; i < n; ) {
+    size_t j = i + 1;
+    while (j < n && a[j].h == a[i].h) {
+      ++j;
+    }
+    lnid__sort_settle(a + i, j - i);
+    for (size_t b = i; b < j; ) {
+      size_t e = b + 1;
+      while (e < j && a[e].h2 == a[b].h2) {
+        ++e;
+      }
+      if (lnid__sort_selected(s, a + b, e - b)) {
+        if (ngroups == capgroups) {
+          size_t cap = (capgroups == 0 ? LNID__SORT_CAP_MIN : 2 * capgroups);
+          struct sortgroup *t;
+          if (cap > SIZE_MAX / sizeof *t
+              || (t = hugemem_realloc(groups, cap * sizeof *t)) == NULL) {
+            goto dispose;
+          }
+          groups = t;
+          capgroups = cap;
+        }
+        //  La ligne figure dans tous les fichiers, dont le fichier d'ordre.
+        size_t f = b;
+        while (s->order != 0 && a[f].pos >> LNID__SORT_OFF_BITS != s->order) {
+          ++f;
+        }
+        groups[ngroups] = (struct sortgroup) {
+          .key = ~(uint64_t) a[f].nbline, .start = b, .end = e
+        };
+        ngroups += 1;
+      }
+      b = e;
+    }
+    i = j;
+  }
+  if (ngroups > 0
+      && (tmp = hugemem_malloc(ngroups * sizeof *groups)) == NULL) {
+    goto dispose;
+  }
+  radix_sort(groups, tmp, ngroups, sizeof *groups, nthreads);
+  hugemem_free(tmp);
+  tmp = NULL;
+  //  Le nombre total d'occurrences d'une ligne est la longueur de sa suite.
+  //    Les candidats sont départagés comme dans la table, le rang d'une suite
+  //    étant son indice.
+  for (size_t i = 0; i < ngroups; ++i) {
+    size_t score = (size_t) (groups[i].end - groups[i].start);
+    if (score < rk->mincount) {
+      continue;
+    }
+    if (rk->h == NULL) {
+      if ((r = lnid__sort_show(rk, &groups[i])) != 0) {
+        goto dispose;
+      }
+      continue;
+    }
+    lnid__ranking_offer(rk, &groups[i], NULL, score, i);
+  }
+  if (rk->h != NULL) {
+    size_t m = lnid__ranking_drain(rk, sorted);
+    for (size_t i = 0; i < m; ++i) {
+      if ((r = lnid__sort_show(rk, sorted[i]->key)) != 0) {
+        goto dispose;
+      }
+    }
+  }
+  r = 0;
+dispose:
+  hugemem_free(tmp);
+  hugemem_free(groups);
+  return r;
+}
+
+//  lnid__index_results : Variante de lnid_results lorsqu'un index tient lieu de
+//    table.
+static int lnid__index_results(lnid *s, void *context,
+    int (*fun)(void *, const struct lnid_result *)) {
+  size_t n = idx_length(s->ix);
+  for (size_t i = 0; i < n; ++i) {
+    const int *cpt = s->icpt + i * s->nfiles;
+    if (cpt[s->nfiles - 1] == 0) {
+      continue;
+    }
+    struct lnid_result r = {
+      .off = 0, .counts = cpt, .ncounts = s->nfiles, .reread = false
+    };
+    if ((r.text = idx_line(s->ix, i, &r.indexed)) == NULL) {
+      return LNID_EINDEX;
+    }
+    r.len = strlen(r.text);
+    int e = fun(context, &r);
+    if (e != 0) {
+      return e;
+    }
+  }
+  return 0;
+}
+
+int lnid_results(lnid *s, size_t top, size_t mincount, void *context,
+    int (*fun)(void *context, const struct lnid_result *r)) {
+  if (s->ix != NULL) {
+    return lnid__index_results(s, context, fun);
+  }
+  struct ranking rk;
+  struct ranked **sorted;
+  int r = -1;
+  if (lnid__ranking_init(&rk, s, top, mincount, context, fun, &sorted) != 0) {
+    goto dispose;
+  }
+  if (s->sort) {
+    r = lnid__sort_results(&rk, sorted);
+    goto dispose;
+  }
+  if ((r = lnid__table_apply(s, true, &rk,
+      (int (*)(void *, const void *, void *))lnid__rank)) != 0
+      || (s->order != 0 && rk.h == NULL
+      && (r = lnid__ranking_sorted(&rk)) != 0)) {
+    goto dispose;
+  }
+  if (rk.h != NULL) {
+    size_t n = lnid__ranking_drain(&rk, sorted);
+    for (size_t i = 0; i < n; ++i) {
+      struct lnid_result res;
+      lnid__result(s, sorted[i]->key, sorted[i]->val, &res);
+      if ((r = lnid__emit(s, &res, context, fun)) != 0) {
+        goto dispose;
+      }
+    }
+  }
+  r = 0;
+dispose:
+  lnid__ranking_dispose(&rk, sorted);
+  return r;
+}
+
+//--- Fichiers d'état ----------------------------------------------------------
+
+//  Un fichier d'état est une suite d'entiers non signés sur 64 bits dans
+//    l'ordre des octets de la machine et de chaînes de caractères, chacune
+//    précédée de sa longueur. Il contient, dans l'ordre : la signature
+//    LNID__STATE_MAGIC, la version LNID__STATE_VERSION, l'indicateur de
+//    passage en majuscules, le nom de la classe (chaîne vide si UTF8_ANY), le
+//    nombre de fichiers puis, pour chacun, son nom, sa position et son nombre
+//    de lignes traitées, le nombre de lignes de la table puis, pour chacune
+//    dans l'ordre de leur ajout, son contenu, son nombre de compteurs et leurs
+//    valeurs.
+
+//  lnid__classname : Renvoie le nom de la classe de s, chaîne vide si UTF8_ANY.
+static const char *lnid__classname(const lnid *s) {
+  const char *name = utf8_classname(s->filter);
+  return name == NULL ? "" : name;
+}
+
+static int lnid__state_write(FILE *f, uint64_t x) {
+  return fwrite(&x, sizeof x, 1, f) != 1;
+}
+
+static int lnid__state_write_str(FILE *f, const char *t) {
+  size_t n = strlen(t);
+  return lnid__state_write(f, n) || fwrite(t, 1, n, f) != n;
+}
+
+//  lnid__state_write_line : Écrit sur f la ligne r de la table et ses
+//    compteurs. Renvoie une valeur non nulle en cas d'erreur d'écriture, zéro
+//    sinon.
+static int lnid__state_write_line(FILE *f, const struct lnid_result *r) {
+  int w = lnid__state_write_str(f, r->text)
+    || lnid__state_write(f, r->ncounts);
+  for (size_t j = 0; !w && j < r->ncounts; ++j) {
+    w = lnid__state_write(f, (uint64_t) r->counts[j]);
+  }
+  return w;
+}
+
+static int lnid__state_read(FILE *f, uint64_t *x) {
+  return fread(x, sizeof *x, 1, f) != 1;
+}
+
+//  lnid__state_read_str : Lit une chaîne de caractères sur f et l'affecte,
+//    allouée dynamiquement, à *t. Renvoie zéro en cas de succès, une valeur
+//    négative en cas de dépassement de capacité, une valeur positive en cas
+//    d'erreur de lecture.
+static int lnid__state_read_str(FILE *f, char **t) {
+  uint64_t n;
+  if (lnid__state_read(f, &n) != 0) {
+    return 1;
+  }
+  if (n >= SIZE_MAX || (*t = malloc((size_t) n + 1)) == NULL) {
+    return -1;
+  }
+  if (fread(*t, 1, (size_t) n, f) != n) {
+    free(*t);
+    return 1;
+  }
+  (*t)[n] = '\0';
+  return 0;
+}
+
+//  lnid__state_match : Lit une chaîne de caractères sur f et renvoie zéro si
+//    elle est égale à t, une valeur négative en cas de dépassement de
+//    capacité, une valeur positive sinon.
+static int lnid__state_match(FILE *f, const char *t) {
+  char *u;
+  int r = lnid__state_read_str(f, &u);
+  if (r != 0) {
+    return r;
+  }
+  r = strcmp(t, u) != 0;
+  free(u);
+  return r;
+}
+
+lnidret lnid_state_load(lnid *s, const char *path,
+    const char * const *names) {
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) {
+    return errno == ENOENT ? LNID_OK : LNID_ESTATE;
+  }
+  lnidret e = LNID_ESTATE;
+  size_t len = s->nfiles;
+  char magic[sizeof LNID__STATE_MAGIC - 1];
+  uint64_t x;
+  uint64_t n;
+  int r;
+  if (fread(magic, sizeof magic, 1, f) != 1
+      || memcmp(magic, LNID__STATE_MAGIC, sizeof magic) != 0
+      || lnid__state_read(f, &x) != 0 || x != LNID__STATE_VERSION
+      || lnid__state_read(f, &x) != 0 || x != s->upper) {
+    goto dispose;
+  }
+  if ((r = lnid__state_match(f, lnid__classname(s))) != 0) {
+    goto error;
+  }
+  if (lnid__state_read(f, &n) != 0 || n != len) {
+    goto dispose;
+  }
+  for (size_t p = 0; p < len; ++p) {
+    if ((r = lnid__state_match(f, names[p])) != 0) {
+      goto error;
+    }
+    if (lnid__state_read(f, &x) != 0 || x > INT64_MAX) {
+      goto dispose;
+    }
+    off_t off = (off_t) x;
+    if (lnid__state_read(f, &x) != 0 || x > INT_MAX) {
+      goto dispose;
+    }
+    lnid_seek(s, p, off, (int) x);
+  }
+  if (lnid__state_read(f, &n) != 0) {
+    goto dispose;
+  }
+  //  Les compteurs d'une ligne sont lus dans le tableau counts, de capacité
+  //    capcounts, avant que la ligne ne soit ajoutée à la table.
+  int *counts = NULL;
+  size_t capcounts = 0;
+  char *t = NULL;
+  for (uint64_t i = 0; i < n; ++i) {
+    if ((r = lnid__state_read_str(f, &t)) != 0) {
+      t = NULL;
+      goto error_line;
+    }
+    uint64_t m;
+    r = 1;
+    if (lnid__state_read(f, &m) != 0 || (len > 1 && m != len)) {
+      goto error_line;
+    }
+    for (uint64_t j = 0; j < m; ++j) {
+      if (lnid__state_read(f, &x) != 0 || x > INT_MAX) {
+        goto error_line;
+      }
+      if (j == capcounts) {
+        size_t cap = (capcounts == 0 ? len : 2 * capcounts);
+        int *a;
+        if (cap > SIZE_MAX / sizeof *a
+            || (a = realloc(counts, cap * sizeof *a)) == NULL) {
+          r = -1;
+          goto error_line;
+        }
+        counts = a;
+        capcounts = cap;
+      }
+      counts[j] = (int) x;
+    }
+    if (lnid_restore(s, t, counts, (size_t) m) != 0) {
+      r = -1;
+      goto error_line;
+    }
+    free(t);
+    t = NULL;
+  }
+  free(counts);
+  e = LNID_OK;
+  goto dispose;
+error_line:
+  free(t);
+  free(counts);
+error:
+  e = (r < 0 ? LNID_ECAP : LNID_ESTATE);
+dispose:
+  fclose(f);
+  return e;
+}
+
+lnidret lnid_state_save(lnid *s, const char *path,
+    const char * const *names) {
+  size_t plen = strlen(path);
+  char tmp[plen + sizeof ".tmp"];
+  strcpy(tmp, path);
+  strcpy(tmp + plen, ".tmp");
+  FILE *f = fopen(tmp, "wb");
+  if (f == NULL) {
+    return LNID_ESTATE;
+  }
+  int w = fwrite(LNID__STATE_MAGIC, sizeof LNID__STATE_MAGIC - 1, 1, f) != 1
+    || lnid__state_write(f, LNID__STATE_VERSION)
+    || lnid__state_write(f, s->upper)
+    || lnid__state_write_str(f, lnid__classname(s))
+    || lnid__state_write(f, s->nfiles);
+  for (size_t p = 0; !w && p < s->nfiles; ++p) {
+    int nbline;
+    off_t off = lnid_tell(s, p, &nbline);
+    w = lnid__state_write_str(f, names[p])
+      || lnid__state_write(f, (uint64_t) off)
+      || lnid__state_write(f, (uint64_t) nbline);
+  }
+  w = w || lnid__state_write(f, lnid_count(s))
+    || lnid_apply(s, false,
+        f, (int (*)(void *, const struct lnid_result *))lnid__state_write_line);
+  if (fclose(f) != 0 || w || rename(tmp, path) != 0) {
+    remove(tmp);
+    return LNID_ESTATE;
+  }
+  return LNID_OK;
+}
+
+//--- Fichiers d'index ---------------------------------------------------------
+
+//  Un fichier d'index mémorise le passage en majuscules dans le bit
+//    LNID__INDEX_UPPER de ses options, complétées par lnid__index_flags, et le
+//    nom de la classe, chaîne vide si UTF8_ANY, dans sa chaîne de description
+//    des options.
+
+//  lnid__index_flags : Renvoie les options de s mémorisées par un fichier
+//    d'index.
+static uint32_t lnid__index_flags(const lnid *s) {
+  if (!s->upper && s->filter == UTF8_ANY) {
+    return 0;
+  }
+  return (s->upper ? LNID__INDEX_UPPER : 0) | LNID__INDEX_UTF8;
+}
+
+lnidret lnid_index_open(lnid *s, const char *path) {
+  s->ix = idx_open(path);
+  if (s->ix == NULL) {
+    return LNID_EINDEX;
+  }
+  lnidret e = LNID_EINDEX;
+  if (idx_flags(s->ix) != lnid__index_flags(s)
+      || strcmp(idx_opts(s->ix), lnid__classname(s)) != 0) {
+    goto error;
+  }
+  e = LNID_ECAP;
+  size_t n = idx_length(s->ix);
+  if (n != 0 && s->nfiles > SIZE_MAX / sizeof *s->icpt / n) {
+    goto error;
+  }
+  s->icpt = calloc(n * s->nfiles + 1, sizeof *s->icpt);
+  if (s->icpt == NULL) {
+    goto error;
+  }
+  return LNID_OK;
+error:
+  idx_dispose(&s->ix);
+  return e;
+}
+
+//  struct indexing : contexte de l'écriture d'un fichier d'index.
+struct indexing {
+  lnid *s;
+  idxb *b;
+};
+
+//  lnid__index_add : Ajoute au constructeur de ix la ligne r de la table.
+//    Renvoie zéro en cas de succès, une valeur non nulle en cas de dépassement
+//    de capacité.
+static int lnid__index_add(struct indexing *ix, const struct lnid_result *r) {
+  uint64_t count = (uint64_t) (ix->s->nfiles == 1
+      ? r->ncounts : (size_t) r->counts[0]);
+  return idxb_add(ix->b, lnid_hash64(r->text, r->len, 0), r->text, r->len,
+      count);
+}
+
+lnidret lnid_index_save(lnid *s, const char *path) {
+  struct indexing ix = {
+    .s = s, .b = idxb_empty(lnid__index_flags(s), lnid__classname(s))
+  };
+  if (ix.b == NULL) {
+    return LNID_ECAP;
+  }
+  lnidret e = LNID_ECAP;
+  if (lnid_apply(s, true,
+      &ix, (int (*)(void *, const struct lnid_result *))lnid__index_add) == 0) {
+    int w = idxb_write(ix.b, path);
+    e = (w < 0 ? LNID_ECAP : w > 0 ? LNID_EINDEX : LNID_OK);
+  }
+  idxb_dispose(&ix.b);
+  return e;
+}
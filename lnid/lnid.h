@@ -0,0 +1,324 @@
+//  lnid.h : partie interface d'un module de recherche des lignes répétées dans
+//    un texte ou communes à plusieurs, lus par morceaux.
+
+#ifndef LNID__H
+#define LNID__H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "utf8.h"
+
+//  Fonctionnement général :
+//  - une session traite nfiles textes, appelés fichiers, désignés par leur
+//      position, de 0 à nfiles - 1, dans l'ordre de traitement. Les octets d'un
+//      fichier sont passés à la session par morceaux de longueurs quelconques
+//      à l'aide de lnid_feed, puis la fin du fichier est signalée à l'aide de
+//      lnid_end. Hors mode incrémental, les fichiers sont traités une seule
+//      fois, chacun en entier avant le suivant, dans l'ordre de leurs
+//      positions ;
+//  - les lignes, terminées par '\n', sont filtrées et transformées à l'aide
+//      de utf8_map selon la classe et l'indicateur de passage en majuscules
+//      de la session ; les lignes qui deviennent vides sont ignorées. Hors
+//      mode incrémental, une dernière ligne sans fin de ligne est traitée à la
+//      fin de son fichier ;
+//  - le résultat d'une session d'un seul fichier est formé des lignes qui y
+//      apparaissent au moins deux fois, associées aux numéros des lignes où
+//      elles apparaissent, à partir de 1. Le résultat d'une session de
+//      plusieurs fichiers est formé des lignes qui apparaissent dans chacun,
+//      associées à leur nombre d'occurrences dans chacun, dans l'ordre de
+//      traitement. Seules les lignes du premier fichier sont ajoutées à la
+//      table de la session : traiter en premier le plus petit fichier borne sa
+//      taille. Les lignes absentes d'un des fichiers suivants, hors le
+//      dernier, en sont retirées dès la fin de ce fichier. Les lignes du
+//      résultat sont ordonnées selon leurs premières occurrences dans le
+//      fichier d'ordre, de position 0 par défaut, de la dernière à la
+//      première ;
+//  - en mode incrémental, option LNID_TAIL, les lignes de tous les fichiers
+//      sont ajoutées à la table et chacune a un compteur par fichier. Les
+//      fichiers sont traités dans un ordre quelconque, et autant de fois que
+//      voulu, chaque traitement reprenant à la position qui suit la dernière
+//      ligne complète du précédent : une dernière ligne sans fin de ligne
+//      n'est pas traitée, elle doit être passée à nouveau en entier au
+//      traitement suivant du fichier ;
+//  - en mode économe en mémoire, option LNID_LOWMEM, la table ne mémorise
+//      qu'une empreinte de 128 bits et la position dans le premier fichier de
+//      chaque ligne ; avec le moteur par tri, option LNID_SORT, aucune table
+//      n'est construite : chaque ligne est décrite par deux valeurs de
+//      hachage, son fichier, sa position et son numéro, et ces descriptions
+//      sont triées lors de la production du résultat. Dans les deux cas, le
+//      contenu des lignes du résultat n'est pas mémorisé : il est relu dans
+//      le premier fichier, dont l'utilisateur fournit le descripteur à l'aide
+//      de lnid_source, à la position de leur première occurrence ;
+//  - avec l'option LNID_HUGEPAGES, les lignes mémorisées le sont dans un
+//      entrepôt du module hugemem, servi par des pages énormes si le service
+//      en a été activé à l'aide de hugemem_enable ;
+//  - une session dotée d'une fonction de traitement des lignes par lnid_lines
+//      ne construit aucune table : chaque ligne lue est passée à cette
+//      fonction, et le résultat est vide. Une session à laquelle un index
+//      tient lieu de table, voir lnid_index_open, ne construit pas non plus
+//      de table ;
+//  - le contenu d'une session de mode incrémental peut être sauvegardé dans
+//      un fichier d'état, puis chargé dans une nouvelle session qui reprend
+//      le traitement là où l'a laissé la précédente ;
+//  - les fonctions qui renvoient une valeur de type int renvoient zéro en cas
+//      de succès, une valeur négative en cas de dépassement de capacité et,
+//      le cas échéant, la première valeur non nulle renvoyée par une fonction
+//      de l'utilisateur ou la valeur de type lnidret qui signale l'échec
+//      d'une relecture ou d'une vérification. Les fonctions de l'utilisateur
+//      renvoient de préférence elles-mêmes une valeur de type lnidret ;
+//  - les fonctions qui possèdent un paramètre de type « lnid * » ont un
+//      comportement indéterminé lorsque ce paramètre n'est pas l'adresse d'une
+//      session préalablement renvoyée par lnid_empty et non encore libérée, ou
+//      lorsque les conditions d'usage décrites ci-dessus ne sont pas
+//      respectées.
+
+//  LNID_TAIL, LNID_LOWMEM, LNID_SORT, LNID_HUGEPAGES : options d'une session,
+//    à combiner par « | ». Les options LNID_LOWMEM et LNID_SORT excluent
+//    chacune les trois autres, LNID_HUGEPAGES exceptée.
+#define LNID_TAIL 1u
+#define LNID_LOWMEM 2u
+#define LNID_SORT 4u
+#define LNID_HUGEPAGES 8u
+
+//  LNID_SORT_MAX : nombre maximal de fichiers d'une session de moteur par tri.
+#define LNID_SORT_MAX ((size_t) 1 << 16)
+
+//  LNID_SEED : graine de la seconde valeur de hachage des empreintes.
+#define LNID_SEED 0x2545F4914F6CDD1DULL
+
+//  lnidret : énumération des valeurs de retour qui signalent la nature d'un
+//    échec : LNID_ECAP un dépassement de capacité, LNID_EFILE un fichier qui ne
+//    peut être ouvert, LNID_EREAD une erreur de lecture, LNID_ETRUNC un fichier
+//    plus court que la position mémorisée, LNID_ESTATE un fichier d'état
+//    illisible, invalide ou qui ne correspond pas à la session, LNID_EINDEX de
+//    même pour un fichier d'index, LNID_ECOLL deux lignes différentes de même
+//    empreinte, LNID_EWRITE une erreur d'écriture et LNID_ESERVE une erreur
+//    sur une prise. LNID_OK signale un succès.
+typedef enum {
+  LNID_OK,
+  LNID_ECAP,
+  LNID_EFILE,
+  LNID_EREAD,
+  LNID_ETRUNC,
+  LNID_ESTATE,
+  LNID_EINDEX,
+  LNID_ECOLL,
+  LNID_EWRITE,
+  LNID_ESERVE,
+} lnidret;
+
+//  struct lnid_result : ligne du résultat ou de la table d'une session. Le
+//    champ text pointe sur son contenu, chaîne de caractères de longueur len,
+//    valide jusqu'à la libération de la session ou, si le champ reread est
+//    vrai parce que ce contenu, non mémorisé, a été relu dans la source de la
+//    session, jusqu'au retour de la fonction à laquelle la ligne est passée.
+//    Il vaut NULL si ce contenu n'est pas mémorisé et que la session n'a pas
+//    de source. Le champ off donne la position de sa première occurrence dans
+//    le premier fichier lorsque son contenu n'est pas mémorisé. Le champ
+//    counts pointe sur ses ncounts compteurs, numéros de lignes ou nombres
+//    d'occurrences, valides jusqu'au retour de la fonction à laquelle la
+//    ligne est passée. Lorsqu'un index tient lieu de table, le champ indexed
+//    est le nombre d'occurrences mémorisé par l'index ; il vaut zéro sinon.
+struct lnid_result {
+  const char *text;
+  size_t len;
+  off_t off;
+  const int *counts;
+  size_t ncounts;
+  bool reread;
+  uint64_t indexed;
+};
+
+//  struct lnid_stats : statistiques d'une session. Les champs lines, records et
+//    pruned sont les nombres de lignes de la table, d'enregistrements du
+//    moteur par tri et de lignes retirées de la table. Les champs hotprev,
+//    hothits et hotlookups comptent les lignes retrouvées sans recherche dans
+//    la table parce qu'égales à la précédente ou présentes dans l'antémémoire
+//    des lignes fréquentes, et les lignes cherchées dans cette antémémoire.
+struct lnid_stats {
+  size_t lines;
+  size_t records;
+  size_t pruned;
+  uint64_t hotprev;
+  uint64_t hothits;
+  uint64_t hotlookups;
+};
+
+//  struct lnid, lnid : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer une session.
+typedef struct lnid lnid;
+
+//  lnid_hash64 : renvoie une valeur de hachage sur 64 bits, de graine seed, des
+//    len premiers octets de s, dont tous les bits sont bien distribués.
+extern uint64_t lnid_hash64(const char *s, size_t len, uint64_t seed);
+
+//  lnid_empty : tente d'allouer les ressources nécessaires pour gérer une
+//    nouvelle session de nfiles fichiers, au moins un et au plus LNID_SORT_MAX
+//    avec l'option LNID_SORT, d'options flags, qui filtre les lignes par la
+//    classe filter et les passe en majuscules si upper vaut true. Renvoie NULL
+//    en cas de dépassement de capacité. Renvoie sinon un pointeur vers le
+//    contrôleur associé à la session.
+extern lnid *lnid_empty(size_t nfiles, unsigned flags, utf8class filter,
+    bool upper);
+
+//  lnid_dispose : sans effet si *sptr vaut NULL. Libère sinon les ressources
+//    allouées à la gestion de la session associée à *sptr puis affecte NULL à
+//    *sptr.
+extern void lnid_dispose(lnid **sptr);
+
+//  lnid_order : fait du fichier de position p le fichier d'ordre de la session
+//    associée à s, de plusieurs fichiers, hors mode incrémental, à laquelle
+//    aucun octet ne doit avoir été passé. Un utilisateur qui traite en premier
+//    le plus petit fichier obtient ainsi le résultat dans l'ordre qu'aurait
+//    donné le traitement en premier du fichier de position p.
+extern void lnid_order(lnid *s, size_t p);
+
+//  lnid_lines : confie à la fonction line le traitement des lignes de la
+//    session associée à s, qui ne doit pas être de mode économe en mémoire ni
+//    de moteur par tri et à laquelle aucun octet ne doit avoir été passé.
+//    Chaque ligne lue est passée à line avec context, la position p de son
+//    fichier, son contenu t, chaîne de caractères de longueur len, son numéro
+//    nbline et sa position off dans son fichier. Toute valeur non nulle
+//    renvoyée par line interrompt le traitement.
+extern void lnid_lines(lnid *s, void *context, int (*line)(void *context,
+    size_t p, const char *t, size_t len, int nbline, off_t off));
+
+//  lnid_source : fait du fichier ouvert en lecture de descripteur fd, le
+//    premier fichier, la source de la session associée à s, de mode économe
+//    en mémoire ou de moteur par tri : le contenu des lignes du résultat y est
+//    relu à l'aide de lnid_reread. Le descripteur n'est pas fermé par la
+//    session.
+extern void lnid_source(lnid *s, int fd);
+
+//  lnid_verify : demande la vérification, par relecture dans sa source, des
+//    lignes de même empreinte de la session associée à s, de mode économe en
+//    mémoire et dotée d'une source. Chaque ligne lue dont l'empreinte figure
+//    dans la table est comparée à la ligne de même empreinte du premier
+//    fichier : le traitement est interrompu par la valeur LNID_ECOLL si elles
+//    diffèrent, LNID_EREAD en cas d'erreur de lecture.
+extern void lnid_verify(lnid *s);
+
+//  lnid_reread : relit la ligne qui commence à la position off du fichier
+//    ouvert en lecture de descripteur fd, lui applique la classe et le passage
+//    en majuscules de la session associée à s, puis affecte à *t son contenu,
+//    chaîne de caractères valide jusqu'au prochain appel de lnid_reread ou
+//    jusqu'à la libération de la session, et à *len sa longueur. Comme lors
+//    de sa lecture par la session, la ligne s'arrête à son premier caractère
+//    nul. Renvoie LNID_OK en cas de succès, LNID_ECAP en cas de dépassement
+//    de capacité et LNID_EREAD en cas d'erreur de lecture.
+extern lnidret lnid_reread(lnid *s, int fd, off_t off, const char **t,
+    size_t *len);
+
+//  lnid_extend : porte à nfiles, au moins égal au précédent, le nombre de
+//    fichiers de la session associée à s, de plusieurs fichiers, hors mode
+//    incrémental et moteur par tri, dont seul le fichier de position 0 a été
+//    traité. Les fichiers ajoutés suivent les précédents dans l'ordre de
+//    traitement. Renvoie zéro en cas de succès, une valeur négative en cas de
+//    dépassement de capacité.
+extern int lnid_extend(lnid *s, size_t nfiles);
+
+//  lnid_seek : en mode incrémental, fait reprendre le prochain traitement du
+//    fichier de position p de la session associée à s à la position off, la
+//    ligne qui s'y trouve portant le numéro nbline + 1.
+extern void lnid_seek(lnid *s, size_t p, off_t off, int nbline);
+
+//  lnid_tell : renvoie la position qui suit la dernière ligne traitée du
+//    fichier de position p de la session associée à s et, si nbline ne vaut
+//    pas NULL, affecte à *nbline son numéro.
+extern off_t lnid_tell(const lnid *s, size_t p, int *nbline);
+
+//  lnid_feed : traite les n octets de buf, qui suivent ceux déjà passés, du
+//    fichier de position p de la session associée à s. Termine auparavant à
+//    l'aide de lnid_end le fichier dont des octets ont été passés en dernier
+//    s'il diffère et n'a pas été terminé.
+extern int lnid_feed(lnid *s, size_t p, const char *buf, size_t n);
+
+//  lnid_end : termine le fichier de position p de la session associée à s,
+//    dont aucun octet n'a pu être passé, et achève le traitement de ses
+//    lignes. Hors mode incrémental, retire ensuite de la table, si p n'est
+//    ni la première ni la dernière position, les lignes absentes du fichier.
+extern int lnid_end(lnid *s, size_t p);
+
+//  lnid_exhausted : renvoie true si et seulement si, hors mode incrémental,
+//    aucune ligne ne reste dans la table de la session associée à s après le
+//    retrait des lignes absentes d'un fichier : le résultat est vide, les
+//    fichiers suivants n'ont pas à être traités.
+extern bool lnid_exhausted(const lnid *s);
+
+//  lnid_count : renvoie le nombre de lignes de la table de la session associée
+//    à s.
+extern size_t lnid_count(const lnid *s);
+
+//  lnid_restore : ajoute à la table de la session associée à s, de mode
+//    incrémental ou d'un seul fichier, la ligne t, absente de la table,
+//    associée aux n compteurs de counts.
+extern int lnid_restore(lnid *s, const char *t, const int *counts, size_t n);
+
+//  lnid_apply : appelle fun(context, r) pour chaque ligne de la table de la
+//    session associée à s, décrite par r, dans l'ordre inverse de leur ajout
+//    si reverse vaut true, dans l'ordre de leur ajout sinon. Les compteurs
+//    d'une ligne sont ceux des fichiers traités depuis le premier jusqu'au
+//    dernier où elle apparaît, ou tous en mode incrémental.
+extern int lnid_apply(lnid *s, bool reverse, void *context,
+    int (*fun)(void *context, const struct lnid_result *r));
+
+//  lnid_results : appelle fun(context, r) pour chaque ligne du résultat de la
+//    session associée à s, décrite par r, dans l'ordre inverse de leurs
+//    premières occurrences dans le fichier d'ordre. Si mincount ne vaut pas
+//    zéro, seules les lignes d'au moins mincount occurrences en tout sont
+//    retenues. Si top ne vaut pas zéro, seules les top lignes retenues de
+//    plus grands nombres d'occurrences en tout le sont, par nombre
+//    décroissant, les premières dans l'ordre précédent l'emportant à nombre
+//    égal.
+extern int lnid_results(lnid *s, size_t top, size_t mincount, void *context,
+    int (*fun)(void *context, const struct lnid_result *r));
+
+//  lnid_state_load : si le fichier d'état de nom path existe, charge son
+//    contenu dans la session associée à s, de mode incrémental, à laquelle
+//    aucun octet ne doit avoir été passé, et dont les fichiers ont pour noms,
+//    dans l'ordre de traitement, ceux de names. Renvoie LNID_OK en cas de
+//    succès ou si le fichier n'existe pas, LNID_ECAP en cas de dépassement de
+//    capacité et LNID_ESTATE si le fichier est illisible, invalide ou a été
+//    écrit pour d'autres fichiers ou une autre classe ou un autre passage en
+//    majuscules que ceux de la session.
+extern lnidret lnid_state_load(lnid *s, const char *path,
+    const char * const *names);
+
+//  lnid_state_save : écrit dans le fichier d'état de nom path le contenu de la
+//    table et les positions des fichiers de la session associée à s, de mode
+//    incrémental, dont les fichiers ont pour noms, dans l'ordre de
+//    traitement, ceux de names. L'écriture a lieu dans un fichier temporaire,
+//    de nom path suivi de « .tmp », qui remplace le fichier d'état une fois
+//    complet. Renvoie LNID_OK en cas de succès, LNID_ECAP en cas de
+//    dépassement de capacité et LNID_ESTATE en cas d'erreur d'écriture.
+extern lnidret lnid_state_save(lnid *s, const char *path,
+    const char * const *names);
+
+//  lnid_index_open : fait tenir lieu de table à la session associée à s, hors
+//    mode incrémental, économe en mémoire et moteur par tri, à laquelle aucun
+//    octet ne doit avoir été passé, l'index de nom path : une ligne lue n'est
+//    comptée que si elle figure dans l'index et, hors le fichier de position
+//    0, dans le fichier de position précédente. Le résultat est formé, dans
+//    l'ordre de l'index, de ses lignes présentes dans tous les fichiers,
+//    associées à leurs nombres d'occurrences dans chacun ; les paramètres top
+//    et mincount de lnid_results sont sans effet. Renvoie LNID_OK en cas de
+//    succès, LNID_ECAP en cas de dépassement de capacité et LNID_EINDEX si le
+//    fichier est illisible, invalide ou a été construit avec une autre classe
+//    ou un autre passage en majuscules que ceux de la session.
+extern lnidret lnid_index_open(lnid *s, const char *path);
+
+//  lnid_index_save : écrit dans le fichier d'index de nom path les lignes de la
+//    table de la session associée à s, hors mode incrémental, économe en
+//    mémoire et moteur par tri, dont seul le fichier de position 0 a été
+//    traité, associées au nombre de leurs occurrences dans ce fichier, dans
+//    l'ordre inverse de leur ajout. Renvoie LNID_OK en cas de succès, LNID_ECAP
+//    en cas de dépassement de capacité et LNID_EINDEX en cas d'erreur
+//    d'écriture.
+extern lnidret lnid_index_save(lnid *s, const char *path);
+
+//  lnid_stats : affecte à *st les statistiques de la session associée à s.
+extern void lnid_stats(const lnid *s, struct lnid_stats *st);
+
+#endif
@@ -0,0 +1,114 @@
+#!/bin/sh
+#  check.sh : vérifications des moteurs de lnid.
+#
+#  Exécute lnid sur des fichiers générés et compare sa sortie standard à une
+#    sortie attendue ou à celle du moteur par table de hachage. Les lignes qui
+#    contiennent un caractère nul ne sont retenues que jusqu'à celui-ci, comme
+#    les clés de la table, quel que soit le moteur.
+
+set -u
+
+LNID=${LNID:-../nbline/lnid}
+
+lnid=$(cd "$(dirname "$LNID")" && pwd)/$(basename "$LNID")
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+cd "$tmp" || exit 1
+
+fails=0
+
+#  expect attendu arguments... : compare la sortie de la commande lnid de ces
+#    arguments à la chaîne attendu, interprétée par printf.
+expect() {
+  # shellcheck disable=SC2059
+  printf "$1" > expected.out
+  shift
+  "$lnid" "$@" > got.out 2> /dev/null
+  if ! cmp -s got.out expected.out; then
+    echo "*** Check failed: $*" >&2
+    fails=$((fails + 1))
+  fi
+}
+
+#  same moteur options arguments... : compare la sortie de la commande lnid de
+#    l'option moteur, des options et des arguments à celle de la commande lnid
+#    de ces seuls options et arguments.
+same() {
+  engine=$1
+  opts=$2
+  shift 2
+  # shellcheck disable=SC2086
+  "$lnid" $engine $opts "$@" > got.out 2> /dev/null
+  # shellcheck disable=SC2086
+  "$lnid" $opts "$@" > expected.out 2> /dev/null
+  if ! cmp -s got.out expected.out; then
+    echo "*** Check failed: $engine $opts $*" >&2
+    fails=$((fails + 1))
+  fi
+}
+
+#  gen fichier lignes modulo graine : écrit dans fichier le nombre de lignes
+#    demandé, chacune tirée parmi modulo lignes distinctes, dont certaines
+#    contiennent un caractère nul.
+gen() {
+  awk -v n="$2" -v m="$3" -v s="$4" 'BEGIN {
+    srand(s)
+    for (i = 0; i < n; ++i) {
+      k = int(rand() * rand() * m)
+      if (k % 7 == 0) {
+        printf "line %d%cNUL %d\n", k, 0, int(rand() * 3)
+      } else {
+        printf "line %d\n", k
+      }
+    }
+  }' > "$1"
+}
+
+#  Lignes qui contiennent un caractère nul, cherchées dans la table après le
+#    filtre de Bloom des fichiers suivants.
+printf 'a\000b\nx\n' > nul1
+printf 'a\000bcdefgh\na\n' > nul2
+{
+  printf 'a\n'
+  for i in 1 2 3; do
+    printf 'a\000bcdefghijklmnopqrstuvwxyz0123456789\nz%d\n' "$i"
+  done
+} > nul3
+cp nul3 nul4
+expect '1\t1\tx\n1\t1\ta\n' nul1 nul1
+expect '2\t2\ta\n' nul2 nul2
+expect '1,2,4,6\ta\n' nul3
+expect '1\t1\tz3\n1\t1\tz2\n1\t1\tz1\n4\t4\ta\n' nul3 nul4
+
+#  Les modes approché et de synthèse regroupent les lignes comme la table.
+printf 'a\000b\na\000c\nx\n' > nul5
+expect '2\t2\ta\n1\t1\tx\n' --approx nul5
+expect '4\t4\ta\n2\t2\tx\n' --approx nul5 nul5
+expect '3\t2\t1\t0.3333\tnul5\n' --summary nul5
+
+#  Au format jsonl, un octet qui ne commence pas un caractère UTF-8 valide est
+#    remplacé par U+FFFD.
+printf 'x\377\nx\377\n\303\251\n\303\251\n' > utf8
+expect '{"lines":[3,4],"text":"\303\251"}\n{"lines":[1,2],"text":"x\\ufffd"}\n' \
+  -O jsonl utf8
+
+#  Le moteur par tri et le mode économe en mémoire, avec ou sans vérification
+#    des empreintes, donnent le résultat du moteur par table de hachage.
+gen big 20000 3000 1
+gen small 2000 3000 2
+gen mid 8000 3000 3
+for opts in "" "-t 5" "-m 3" "-O tsv" "-O jsonl" "-O bin"; do
+  for files in "big" "small" "big small" "big mid small" "nul1" "nul1 nul1" \
+      "nul2 nul2" "nul3" "nul3 nul4"; do
+    # shellcheck disable=SC2086
+    same --engine=sort "$opts" $files
+    # shellcheck disable=SC2086
+    same --low-memory "$opts" $files
+    # shellcheck disable=SC2086
+    same "--low-memory --verify" "$opts" $files
+  done
+done
+
+if [ "$fails" -ne 0 ]; then
+  exit 1
+fi
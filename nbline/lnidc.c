@@ -0,0 +1,84 @@
+//  lnidc.c : client du mode serveur de lnid. Envoie ses arguments, qui suivent
+//    le chemin de la prise, au serveur lancé par « lnid --serve=prise
+//    référence ... », qui les exécute comme ceux d'une commande lnid, puis
+//    termine avec le statut de fin de cette commande.
+//
+//  La commande est exécutée dans le répertoire de travail de lnidc, qui est
+//    envoyé avec les arguments, et lit et écrit directement sur les entrée,
+//    sortie et sortie erreur standard de lnidc. Les options qui écrivent des
+//    fichiers, --state et --save-index, sont refusées. Une commande dont le
+//    premier fichier est l'une des références du serveur ne relit pas ce
+//    fichier : sa table est déjà construite.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "serve.h"
+
+#define USAGE "Syntaxe : %s prise [argument ...]\n"
+
+//  CWD_SIZE : taille initiale du tampon du nom du répertoire de travail.
+#define CWD_SIZE 256
+
+//  cwd_get : Renvoie le nom absolu du répertoire de travail, alloué par
+//    malloc, NULL en cas d'échec.
+static char *cwd_get(void) {
+  size_t size = CWD_SIZE;
+  while (true) {
+    char *buf = malloc(size);
+    if (buf == NULL) {
+      return NULL;
+    }
+    if (getcwd(buf, size) != NULL) {
+      return buf;
+    }
+    int e = errno;
+    free(buf);
+    if (e != ERANGE || size > SIZE_MAX / 2) {
+      errno = e;
+      return NULL;
+    }
+    size *= 2;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    fprintf(stderr, USAGE, argv[0]);
+    return EXIT_FAILURE;
+  }
+  char *cwd = cwd_get();
+  if (cwd == NULL) {
+    fprintf(stderr, "*** Error: Cannot get the working directory: %s\n",
+        strerror(errno));
+    return EXIT_FAILURE;
+  }
+  int fd = serve_connect(argv[1]);
+  if (fd < 0) {
+    fprintf(stderr, "*** Error: Cannot connect to the socket %s: %s\n",
+        argv[1], strerror(errno));
+    free(cwd);
+    return EXIT_FAILURE;
+  }
+  //  La requête est formée du répertoire de travail, qui prend la place du
+  //    chemin de la prise, et des arguments qui suivent.
+  argv[1] = cwd;
+  const int fds[SERVE_NFDS] = {
+    STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO
+  };
+  int r;
+  if (serve_send(fd, (size_t) argc - 1, (const char * const *) argv + 1, fds)
+      != 0 || serve_status(fd, &r) != 0) {
+    fprintf(stderr, "*** Error: %s\n", strerror(errno));
+    r = EXIT_FAILURE;
+  }
+  close(fd);
+  free(cwd);
+  return r;
+}
@@ -1,11 +1,35 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <sys/select.h>
+#include <sys/wait.h>
 #include "da.h"
 #include "holdall.h"
-#include "hashtable.h"
 #include "opt.h"
-#include "ds.h"
+#include "reader.h"
+#include "dagen.h"
+#include "hugemem.h"
+#include "utf8.h"
+#include "lnid.h"
+#include "out.h"
+#include "approx.h"
+#include "summary.h"
+#include "serve.h"
 
 #define TRACK fprintf(stderr, "*** %s:%d\n", __func__, __LINE__);
 
@@ -22,6 +46,59 @@
   "ligne dans chacun des fichiers et le contenu de la ligne.\n"                \
   "Les options peuvent être mises à n'importe quel endroit dans la commande "  \
   "d'appel après l'exécutable.\n"                                              \
+  "Un argument de la forme @liste, comme l'option --files-from=liste, ajoute " \
+  "les noms de fichiers lus, un par ligne, dans le fichier liste ou, si liste " \
+  "vaut « - », sur l'entrée standard.\n"                                      \
+  "Avec l'option --state, la position atteinte dans chaque fichier et l'état " \
+  "de la table sont sauvegardés à la fin de l'exécution ; l'exécution "        \
+  "suivante avec le même fichier d'état ne lit que les lignes ajoutées "       \
+  "depuis. Avec l'option --follow, les fichiers sont surveillés et le "        \
+  "résultat est affiché à nouveau, précédé d'une ligne vide, à chaque ajout.\n" \
+  "Avec l'option --save-index, la table construite à partir du premier "       \
+  "fichier traité est écrite dans un fichier d'index. Avec l'option --index, " \
+  "ce fichier d'index tient lieu de premier fichier : le nombre d'occurrences " \
+  "qu'il mémorise est affiché avant ceux des fichiers de la ligne de "         \
+  "commande.\n"                                                                \
+  "Avec l'option --low-memory, la table ne mémorise qu'une empreinte de 128 "  \
+  "bits et la position de chaque ligne, dont le contenu est relu dans le "     \
+  "premier fichier traité lors de l'affichage ; l'option --verify vérifie en " \
+  "outre, par relecture, que deux lignes de même empreinte sont égales.\n"     \
+  "Avec l'option --min-count, seules les lignes dont le nombre total "         \
+  "d'occurrences atteint la valeur passée en argument sont affichées. Avec "   \
+  "l'option --top, seules les lignes de plus grands nombres totaux "           \
+  "d'occurrences, en nombre au plus égal à la valeur passée en argument, "     \
+  "sont affichées, par nombre total décroissant.\n"                            \
+  "Avec l'option --approx[=Mio], les lignes les plus fréquentes de "           \
+  "l'ensemble des fichiers sont recherchées dans un résumé de taille fixe, de " \
+  "64 Mio par défaut : pour chacune, sont affichés une majoration et une "     \
+  "minoration de son nombre d'occurrences puis son contenu. L'erreur maximale " \
+  "est affichée sur la sortie erreur.\n"                                      \
+  "Avec l'option --summary, aucune table n'est construite : est affiché pour " \
+  "chaque fichier, dans l'ordre de la ligne de commande, son nombre de "       \
+  "lignes non vides, une estimation de son nombre de lignes distinctes, le "   \
+  "nombre de doublons qui s'en déduit, le taux de doublons et son nom. "       \
+  "L'estimation est exacte, aux collisions d'empreintes de 64 bits près, "     \
+  "avec --summary=exact.\n"                                                   \
+  "Avec l'option --hugepages, les grands tableaux des tables et les blocs "    \
+  "des lignes mémorisées sont, si le système le permet, servis par des pages " \
+  "énormes, ce qui réduit les défauts de page et de TLB sur les grandes "      \
+  "entrées. Avec l'option --stats, le nombre de lignes de la table, le temps " \
+  "écoulé, les défauts de page, la mémoire maximale utilisée, le taux de "     \
+  "lignes retrouvées sans recherche dans la table et la part de mémoire "      \
+  "servie par des pages énormes sont affichés sur la sortie erreur.\n"         \
+  "Avec l'option --engine=sort, aucune table n'est construite : chaque ligne " \
+  "est décrite en 24 octets par deux valeurs de hachage, son fichier, sa "     \
+  "position et son numéro, ces descriptions sont triées par base puis les "    \
+  "lignes égales, aux collisions d'empreintes de 96 bits près, sont "          \
+  "regroupées en un seul parcours. Le résultat est celui du moteur par "       \
+  "défaut, --engine=hash.\n"                                                   \
+  "L'option --output-format choisit le format du résultat : text, celui "     \
+  "décrit ci-dessus et le format par défaut, tsv, le même précédé d'une "      \
+  "ligne d'en-tête et dont les tabulations et barres obliques inverses des "   \
+  "lignes sont protégées, jsonl, un objet JSON par ligne, ou bin, un format "  \
+  "binaire par colonnes destiné à être projeté en mémoire par les "            \
+  "programmes qui le lisent.\n"                                                \
+  "Avec --serve, les fichiers restent en mémoire, voir lnidc.\n"
 
 #define USAGE "Syntaxe : %s [fichier] or  %s [fichier1] [fichier2] ...\n"
 
@@ -34,98 +111,443 @@
 #define LONGUPPER "uppercase"
 #define SHORTUPPER "u"
 
-#define NBOPTION 2
+#define LONGSTATE "state="
+#define SHORTSTATE "s"
+
+#define LONGFOLLOW "follow"
+#define SHORTFOLLOW "F"
+
+#define LONGINDEX "index="
+#define SHORTINDEX "i"
+
+#define LONGSAVEINDEX "save-index="
+#define SHORTSAVEINDEX "S"
+
+#define LONGLOWMEM "low-memory"
+#define SHORTLOWMEM "l"
+
+#define LONGVERIFY "verify"
+#define SHORTVERIFY "V"
+
+#define LONGTOP "top="
+#define SHORTTOP "t"
+
+#define LONGMINCOUNT "min-count="
+#define SHORTMINCOUNT "m"
+
+#define LONGAPPROX "approx"
+#define SHORTAPPROX "a"
+
+#define LONGSUMMARY "summary"
+#define SHORTSUMMARY "d"
+#define SUMMARYEXACT "exact"
+
+#define LONGFILESFROM "files-from="
+#define SHORTFILESFROM "T"
+
+#define LONGHUGEPAGES "hugepages"
+#define SHORTHUGEPAGES "H"
+
+#define LONGSTATS "stats"
+#define SHORTSTATS "I"
+
+#define LONGENGINE "engine="
+#define SHORTENGINE "E"
+#define ENGINEHASH "hash"
+#define ENGINESORT "sort"
+
+#define LONGFORMAT "output-format="
+#define SHORTFORMAT "O"
+
+#define LONGSERVE "serve="
+#define SHORTSERVE "D"
+
+//  Préfixe d'un argument désignant un fichier de noms de fichiers et nom
+//    désignant l'entrée standard.
+#define LISTPREFIX '@'
+#define LISTSTDIN "-"
+
+#define NBOPTION 18
+
+//  Délai, en secondes, entre deux examens des fichiers en mode suivi.
+#define FOLLOW_DELAY 1
 
 //--- Définition structure et fonctions ----------------------------------------
 
+//  Le champ pos associe à l'indice d'un fichier dans filelist, c'est-à-dire
+//    dans l'ordre de la ligne de commande, sa position dans l'ordre de
+//    traitement, qui est aussi l'indice de son compteur dans les tableaux de
+//    compteurs. Le champ order est la bijection réciproque. Le champ names
+//    contient les noms des fichiers dans l'ordre de traitement et le champ
+//    start, en mode incrémental, leurs positions de départ : ils sont passés au
+//    lecteur rd qui lit les fichiers pendant que leurs lignes sont traitées.
+
+//  Le champ session est la session du module lnid qui traite les lignes des
+//    fichiers. Le champ nskipped compte les fichiers qui n'ont pas été lus
+//    faute de lignes restantes dans sa table.
+
+//  Avec l'option --serve, le champ serve est le chemin de la prise d'écoute et
+//    refs le tableau des sessions des fichiers de référence, un par fichier de
+//    filelist, dont le tableau refstat mémorise les attributs, obtenus par
+//    stat avant leur lecture. Dans le processus fils qui traite une requête,
+//    le champ warm est vrai si la session est celle, déjà construite par le
+//    serveur, de la référence qui est le premier fichier de la requête : ce
+//    fichier n'est pas lu à nouveau.
+
+//  Les champs index et saveindex sont les noms des fichiers d'index à lire et à
+//    écrire, voir lnid_index_open et lnid_index_save.
+
+//  En mode économe en mémoire (champ lowmem vrai) et avec le moteur par tri
+//    (champ sort vrai), le contenu des lignes est relu au besoin par la
+//    session dans le premier fichier traité, de descripteur lowfd. Le champ
+//    verify demande la vérification des lignes de même empreinte.
+
+//  Les champs top et mincount sont les valeurs des options --top et
+//    --min-count, zéro si elles sont absentes.
+
+//  En mode approché, le champ approx est la taille en Mio du résumé ap, qui
+//    remplace la table. Il vaut zéro sinon.
+
+//  En mode résumé (champ summary vrai), aucune table n'est construite : les
+//    lignes distinctes de chaque fichier sont comptées par sm, exactement avec
+//    --summary=exact (champ exact vrai).
+
+//  Le champ hugepages indique l'option --hugepages. Avec l'option --stats
+//    (champ stats vrai), le champ started mémorise l'instant du début de
+//    l'exécution, voir stats_report.
+
+//  Le champ format est le format du résultat, écrit sur la sortie standard par
+//    le contrôleur out.
+
+//  Le fourretout hasname mémorise les noms de fichiers lus dans les fichiers
+//    de noms. Le champ listname est le nom du dernier fichier de noms lu et le
+//    champ listret le résultat de sa lecture.
+
+//  En mode incrémental (champ state non NULL ou champ follow vrai), le champ
+//    end mémorise la taille de chaque fichier lors de sa dernière lecture.
+
 typedef struct {
-  int (*filter)(int c);
-  int (*transform)(int c);
+  utf8class filter;
+  bool upper;
+  const char *state;
+  bool follow;
+  const char *index;
+  const char *saveindex;
+  bool lowmem;
+  bool verify;
+  size_t top;
+  size_t mincount;
+  size_t approx;
+  approx *ap;
+  bool summary;
+  bool exact;
+  summary *sm;
+  bool hugepages;
+  bool stats;
+  double started;
+  bool sort;
+  outformat format;
+  out *out;
   da *filelist;
+  holdall *hasname;
+  const char *listname;
+  lnidret listret;
+  size_t *order;
+  size_t *pos;
+  const char **names;
+  off_t *start;
+  reader *rd;
+  lnid *session;
+  size_t nskipped;
+  const char *serve;
+  lnid **refs;
+  struct stat *refstat;
+  bool warm;
+  int lowfd;
+  off_t *end;
 } cnxt;
 
-//  str_hashfun : L'une des fonctions de pré-hachage conseillées par Kernighan
-//    et Pike pour les chaines de caractères.
-static size_t str_hashfun(const char *s);
+#define TAIL(cntxt) ((cntxt)->state != NULL || (cntxt)->follow)
 
-//  lnid_display : Affiche sur la sortie standard le contenu du tableau cpt,
-//    le caractère tabulation si la longueur de cpt est égale à celle du tableau
-//    filelist contenu dans cntxt. Ou une virgule si la longueur de cpt est
-//    supérieur ou égale à deux. Puis affiche la chaîne de caratère s et la
-//    fin de ligne.
-//  Renvoie zéro en cas de succès une valeur non nulle sinon.
-static int lnid_display(cnxt *cntxt, const char *s, da *cpt);
+//  lnid_file : Passe à la session de cntxt le fichier de position p dans
+//    l'ordre de traitement, lu par le lecteur de cntxt à partir de sa position
+//    mémorisée par la session en mode incrémental, du début sinon, puis en
+//    signale la fin.
+//  Renvoie LNID_OK en cas de succès, LNID_ECAP en cas de dépassement de
+//    capacité, LNID_EFILE si le fichier ne peut être ouvert, LNID_EREAD en cas
+//    d'erreur de lecture, LNID_ETRUNC si le fichier est plus court que la
+//    position mémorisée et LNID_ECOLL si la vérification de la session
+//    rencontre deux lignes différentes de même empreinte.
+static lnidret lnid_file(cnxt *cntxt, size_t p);
 
-//  rfree : Libère la zone mémoire pointée par ptr et renvoie zéro.
-static int rfree(void *ptr);
+//  follow_wait : Attend que la taille d'un des fichiers de cntxt diffère de
+//    celle de sa dernière lecture.
+//  Renvoie zéro dès que c'est le cas, une valeur non nulle si la taille d'un
+//    des fichiers ne peut être obtenue.
+static int follow_wait(cnxt *cntxt);
 
-//  rdefree : Libére le tableau dynamique pointé par p et renvoie zéro.
-static int rdafree(da *p);
+//  stats_clock : Renvoie l'instant courant, en secondes, d'une horloge
+//    monotone.
+static double stats_clock(void);
 
-//  addline : On suppose que le fichier filename est ouvert en lecture. Tente
-//    de lire une ligne de filename caractère par caractère et les ajoutent à p
-//    s'ils respectent le filtre lié à cntxt si celui-ci est défini et
-//    transforme les caractères selon la fonction transform de cntxt si celle-ci
-//    est défini.
-//  Renvoie zéro en cas de succès, une valeur négative en cas de problème de
-//    lecture ou de dépassement de capacité, une valeur positive si la fin de
-//    fichier est atteint.
-static int addline(ds *p, FILE *filename, cnxt *cntxt);
+//  stats_report : Affiche sur la sortie erreur le nombre de lignes de la table
+//    de la session de cntxt ou, avec le moteur par tri, le nombre de ses
+//    enregistrements, le temps écoulé depuis le début de l'exécution, les
+//    nombres de défauts de page, la mémoire maximale utilisée par le
+//    processus, les compteurs de l'antémémoire des lignes fréquentes et le
+//    bilan des zones allouées par le module hugemem.
+static void stats_report(cnxt *cntxt);
+
+//  rfree : Libère la zone mémoire pointée par ptr et renvoie zéro.
+static int rfree(void *ptr);
 
 //  addfile : Ajoute-le du nom du fichier filename au tableau dynamique pointer
-//    par p.
-//  Renvoie NULL en cas de dépassement de capacité, filename sinon.
+//    par p. Si filename commence par LISTPREFIX, ajoute plutôt les noms lus
+//    dans le fichier de noms désigné par la suite de filename à l'aide de
+//    files_from.
+//  Renvoie NULL en cas de dépassement de capacité ou si le fichier de noms ne
+//    peut être lu, filename sinon.
 static void *addfile(cnxt *p, const char *filename);
 
-//  filter_choose : Affecte aux champs filter de cntxt la fonction lier à la
-//    chaîne de caractère s si celle-ci correspond bien.
+//  files_from : Ajoute au tableau filelist de cntxt les noms de fichiers lus,
+//    un par ligne, dans le fichier de nom s, ou sur l'entrée standard si s
+//    vaut LISTSTDIN. Les lignes vides sont ignorées. Affecte s au champ
+//    listname de cntxt et le résultat au champ listret.
+//  Renvoie LNID_OK en cas de succès, LNID_ECAP en cas de dépassement de
+//    capacité et LNID_EFILE si le fichier ne peut être ouvert ou lu.
+static lnidret files_from(cnxt *cntxt, const char *s);
+
+//  build_choose : Initialise les champs order, pos et names de cntxt de sorte
+//    que le fichier de plus petite taille parmi ceux de filelist soit traité
+//    en premier, les autres suivant dans l'ordre de la ligne de commande. Ce
+//    premier fichier est celui dont les lignes sont ajoutées à la table : en
+//    présence de plusieurs fichiers, seules les lignes présentes dans tous
+//    comptent, choisir le plus petit borne donc la taille de la table ; le
+//    résultat reste ordonné selon le premier fichier de la ligne de commande,
+//    voir lnid_order. En mode incrémental, les lignes de tous les fichiers
+//    sont ajoutées à la table et, comme lorsqu'un index tient lieu de table
+//    ou est écrit, en mode approché, en mode résumé, pour le serveur et pour
+//    une requête qui reprend la session d'une référence, l'ordre de traitement
+//    est celui de la ligne de commande.
+//  Renvoie zéro en cas de succès, une valeur négative en cas de dépassement de
+//    capacité, une valeur positive si la taille d'un des fichiers ne peut
+//    être obtenue ; dans ce dernier cas, affecte à *k l'indice du fichier.
+static int build_choose(cnxt *cntxt, size_t *k);
+
+//  filter_choose : Affecte au champ filter de cntxt la classe de caractères
+//    dont s est le nom, celui de la fonction homologue de <ctype.h>.
 //  Renvoie zéro en cas de succès, une valeur négative sinon.
 static int filter_choose(cnxt *cntxt, const char *s);
 
-//  transform_choose : Affecte aux champs transform de cntxt la fonction lier à
-//    la chaîne de caractère s si celle-ci correspond bien.
+//  transform_choose : Demande le passage en majuscules des lignes de cntxt si
+//    la chaîne de caractère s désigne l'option --uppercase.
 //  Renvoie zéro en cas de succès, une valeur négative sinon.
 static int transform_choose(cnxt *cntxt, const char *s);
 
+//  state_choose : Affecte au champ state de cntxt le nom de fichier s.
+//  Renvoie zéro en cas de succès, une valeur négative si s vaut NULL.
+static int state_choose(cnxt *cntxt, const char *s);
+
+//  follow_choose : Active le mode suivi de cntxt. Renvoie zéro.
+static int follow_choose(cnxt *cntxt, const char *s);
+
+//  index_choose, saveindex_choose : Affectent au champ index (resp.
+//    saveindex) de cntxt le nom de fichier s.
+//  Renvoient zéro en cas de succès, une valeur négative si s vaut NULL.
+static int index_choose(cnxt *cntxt, const char *s);
+static int saveindex_choose(cnxt *cntxt, const char *s);
+
+//  lowmem_choose, verify_choose : Activent le mode économe en mémoire (resp.
+//    la vérification des empreintes) de cntxt. Renvoient zéro.
+static int lowmem_choose(cnxt *cntxt, const char *s);
+static int verify_choose(cnxt *cntxt, const char *s);
+
+//  hugepages_choose, stats_choose : Activent le service par des pages énormes
+//    (resp. l'affichage des statistiques) de cntxt. Renvoient zéro.
+static int hugepages_choose(cnxt *cntxt, const char *s);
+static int stats_choose(cnxt *cntxt, const char *s);
+
+//  engine_choose : Active le moteur par tri de cntxt si s vaut ENGINESORT, le
+//    moteur par table si s vaut ENGINEHASH.
+//  Renvoie zéro en cas de succès, une valeur négative sinon.
+static int engine_choose(cnxt *cntxt, const char *s);
+
+//  format_choose : Affecte au champ format de cntxt le format de nom s.
+//  Renvoie zéro en cas de succès, une valeur négative si s ne désigne pas un
+//    format.
+static int format_choose(cnxt *cntxt, const char *s);
+
+//  top_choose, mincount_choose : Affectent au champ top (resp. mincount) de
+//    cntxt l'entier décrit par s.
+//  Renvoient zéro en cas de succès, une valeur négative si s ne décrit pas un
+//    entier strictement positif.
+static int top_choose(cnxt *cntxt, const char *s);
+static int mincount_choose(cnxt *cntxt, const char *s);
+
+//  approx_choose : Active le mode approché de cntxt avec la taille de résumé
+//    éventuellement décrite, en Mio, par la partie de s qui suit « = ».
+//  Renvoie zéro en cas de succès, une valeur négative si cette taille n'est
+//    pas un entier strictement positif.
+static int approx_choose(cnxt *cntxt, const char *s);
+
+//  summary_choose : Active le mode résumé de cntxt, exact si la partie de s
+//    qui suit « = » vaut SUMMARYEXACT.
+//  Renvoie zéro en cas de succès, une valeur négative si cette partie existe
+//    et diffère de SUMMARYEXACT.
+static int summary_choose(cnxt *cntxt, const char *s);
+
+//  filesfrom_choose : Ajoute au tableau filelist de cntxt les noms de fichiers
+//    lus à l'aide de files_from dans le fichier de nom s.
+//  Renvoie zéro en cas de succès, une valeur négative sinon.
+static int filesfrom_choose(cnxt *cntxt, const char *s);
+
+//  serve_choose : Affecte au champ serve de cntxt le chemin de prise s.
+//  Renvoie zéro en cas de succès, une valeur négative si s vaut NULL.
+static int serve_choose(cnxt *cntxt, const char *s);
+
+//  lnid_main : Exécute la commande de arguments argv, au nombre de argc.
+//    Lorsque server ne vaut pas NULL, la commande est une requête reçue par le
+//    serveur de contexte server, exécutée par un processus fils de celui-ci.
+//  Renvoie EXIT_SUCCESS en cas de succès, EXIT_FAILURE sinon.
+static int lnid_main(int argc, const char *argv[], const cnxt *server);
+
+//  serve_run : Construit une session par fichier de cntxt, de référence, à
+//    l'aide de lnid_file, après en avoir mémorisé les attributs, puis sert
+//    les requêtes reçues sur la prise cntxt->serve jusqu'à la réception de
+//    SIGINT ou de SIGTERM. Chaque requête est traitée par un processus fils,
+//    à l'aide de serve_request : la copie de ses tables que lui vaut fork lui
+//    évite de relire les références. Le statut de fin du fils est renvoyé au
+//    client une fois le fils attendu. En cas d'échec, affecte à *k l'indice
+//    dans filelist du fichier en cause.
+//  Renvoie LNID_OK en cas de succès, LNID_EFILE si les attributs d'une
+//    référence ne peuvent être obtenus, la valeur renvoyée par lnid_file en
+//    cas d'échec de celle-ci, LNID_ECAP en cas de dépassement de capacité et
+//    LNID_ESERVE en cas d'erreur sur la prise.
+static lnidret serve_run(cnxt *cntxt, const char *argv0, size_t *k);
+
+//  serve_request : Rétablit le traitement par défaut des signaux et le masque
+//    de signaux mask, reçoit sur la connexion de descripteur fd une requête,
+//    formée du répertoire de travail du client et de ses arguments, puis
+//    l'exécute à l'aide de lnid_main avec argv0 pour premier argument, dans ce
+//    répertoire et avec pour entrée, sortie et sortie erreur standard celles
+//    du client.
+//  Renvoie EXIT_SUCCESS en cas de succès, EXIT_FAILURE sinon.
+static int serve_request(const cnxt *cntxt, const char *argv0, int fd,
+    const sigset_t *mask);
+
 //--- Main ---------------------------------------------------------------------
 
 int main(int argc, const char *argv[]) {
+  return lnid_main(argc, argv, NULL);
+}
+
+int lnid_main(int argc, const char *argv[], const cnxt *server) {
   if (argc == 1) {
     fprintf(stderr, "Illegal number of parameters or unrecognized option.\n");
     printf(USAGE, argv[0], argv[0]);
     return EXIT_FAILURE;
   }
   opt *opt1 = opt_gen(SHORT SHORTUPPER, LONG LONGUPPER,
-      "Met tous les caractéres enregistrer en majuscule", false,
+      "Met les lignes en majuscules, lues comme du texte UTF-8 : les lettres "
+      "accentuées, grecques, cyrilliques et arméniennes le sont aussi", false,
       (int (*)(const void *, const void *))transform_choose);
   opt *opt2 = opt_gen(SHORT SHORTFILTER, "--filter=",
-      "Applique le filtre passer en argument", true,
+      "Ne conserve des lignes, lues comme du texte UTF-8, que les caractères "
+      "de la classe passée en argument, nom de la fonction homologue de "
+      "<ctype.h>, comme isalpha ; les octets invalides sont écartés", true,
       (int (*)(const void *, const void *))filter_choose);
+  opt *opt3 = opt_gen(SHORT SHORTSTATE, LONG LONGSTATE,
+      "Reprend le traitement là où l'a laissé l'exécution précédente et "
+      "sauvegarde l'état atteint dans le fichier passé en argument", true,
+      (int (*)(const void *, const void *))state_choose);
+  opt *opt4 = opt_gen(SHORT SHORTFOLLOW, LONG LONGFOLLOW,
+      "Surveille les fichiers et affiche à nouveau le résultat à chaque ajout",
+      false, (int (*)(const void *, const void *))follow_choose);
+  opt *opt5 = opt_gen(SHORT SHORTINDEX, LONG LONGINDEX,
+      "Utilise le fichier d'index passé en argument comme premier fichier",
+      true, (int (*)(const void *, const void *))index_choose);
+  opt *opt6 = opt_gen(SHORT SHORTSAVEINDEX, LONG LONGSAVEINDEX,
+      "Écrit la table construite à partir du premier fichier traité dans le "
+      "fichier d'index passé en argument", true,
+      (int (*)(const void *, const void *))saveindex_choose);
+  opt *opt7 = opt_gen(SHORT SHORTLOWMEM, LONG LONGLOWMEM,
+      "Ne mémorise qu'une empreinte et la position de chaque ligne", false,
+      (int (*)(const void *, const void *))lowmem_choose);
+  opt *opt8 = opt_gen(SHORT SHORTVERIFY, LONG LONGVERIFY,
+      "Vérifie par relecture l'égalité des lignes de même empreinte", false,
+      (int (*)(const void *, const void *))verify_choose);
+  opt *opt9 = opt_gen(SHORT SHORTTOP, LONG LONGTOP,
+      "N'affiche que les lignes aux plus grands nombres d'occurrences, en "
+      "nombre au plus égal à l'argument", true,
+      (int (*)(const void *, const void *))top_choose);
+  opt *opt10 = opt_gen(SHORT SHORTMINCOUNT, LONG LONGMINCOUNT,
+      "N'affiche que les lignes dont le nombre d'occurrences atteint "
+      "l'argument", true, (int (*)(const void *, const void *))mincount_choose);
+  opt *opt11 = opt_gen(SHORT SHORTAPPROX, LONG LONGAPPROX,
+      "Recherche approximativement les lignes les plus fréquentes dans un "
+      "résumé de taille fixe, de 64 Mio ou de la taille donnée par --approx=",
+      false, (int (*)(const void *, const void *))approx_choose);
+  opt *opt12 = opt_gen(SHORT SHORTSUMMARY, LONG LONGSUMMARY,
+      "Affiche seulement, pour chaque fichier, ses nombres de lignes, de "
+      "lignes distinctes et de doublons, estimés ou exacts avec "
+      "--summary=exact", false,
+      (int (*)(const void *, const void *))summary_choose);
+  opt *opt13 = opt_gen(SHORT SHORTFILESFROM, LONG LONGFILESFROM,
+      "Ajoute les noms de fichiers lus, un par ligne, dans le fichier passé en "
+      "argument, ou sur l'entrée standard s'il vaut « - »", true,
+      (int (*)(const void *, const void *))filesfrom_choose);
+  opt *opt14 = opt_gen(SHORT SHORTHUGEPAGES, LONG LONGHUGEPAGES,
+      "Sert si possible les grands tableaux des tables et les lignes "
+      "mémorisées par des pages énormes", false,
+      (int (*)(const void *, const void *))hugepages_choose);
+  opt *opt15 = opt_gen(SHORT SHORTSTATS, LONG LONGSTATS,
+      "Affiche sur la sortie erreur des statistiques d'exécution", false,
+      (int (*)(const void *, const void *))stats_choose);
+  opt *opt16 = opt_gen(SHORT SHORTENGINE, LONG LONGENGINE,
+      "Recherche les doublons dans une table de hachage (hash, par défaut) ou "
+      "par tri des empreintes des lignes (sort)", true,
+      (int (*)(const void *, const void *))engine_choose);
+  opt *opt17 = opt_gen(SHORT SHORTFORMAT, LONG LONGFORMAT,
+      "Choisit le format du résultat : text (par défaut), tsv, jsonl ou bin",
+      true, (int (*)(const void *, const void *))format_choose);
+  opt *opt18 = opt_gen(SHORT SHORTSERVE, LONG LONGSERVE,
+      "Garde en mémoire les tables des fichiers, de référence, et exécute les "
+      "commandes que lui envoie lnidc sur la prise passée en argument : une "
+      "commande dont le premier fichier est une référence ne relit pas ce "
+      "fichier", true, (int (*)(const void *, const void *))serve_choose);
   opt *suppopt[NBOPTION] = {
-    opt1, opt2
+    opt1, opt2, opt3, opt4, opt5, opt6, opt7, opt8, opt9, opt10, opt11, opt12,
+    opt13, opt14, opt15, opt16, opt17, opt18
   };
   int r = EXIT_SUCCESS;
-  da *filelist = da_empty();
-  ds *line = ds_empty();
-  da *cptt = da_empty();
-  holdall *has = holdall_empty();
-  holdall *hascpt = holdall_empty();
-  hashtable *ht = hashtable_empty((int (*)(const void *, const void *))strcmp,
-      (size_t (*)(const void *))str_hashfun);
-  if (has == NULL || ht == NULL || hascpt == NULL || filelist == NULL
-      || line == NULL || cptt == NULL) {
-    goto error_capacity;
-  }
   cnxt cntxt = {
-    .filelist = filelist, .filter = NULL, .transform = NULL
+    .filter = UTF8_ANY, .upper = false, .state = NULL, .follow = false,
+    .index = NULL, .saveindex = NULL, .lowmem = false, .verify = false,
+    .top = 0, .mincount = 0, .approx = 0, .ap = NULL, .summary = false,
+    .exact = false, .sm = NULL, .hugepages = false, .stats = false,
+    .started = 0.0, .sort = false, .format = OUT_TEXT, .out = NULL,
+    .filelist = da_empty(), .hasname = holdall_empty(), .listname = NULL,
+    .listret = LNID_OK, .order = NULL, .pos = NULL, .names = NULL,
+    .start = NULL, .rd = NULL, .session = NULL, .nskipped = 0,
+    .serve = NULL, .refs = NULL, .refstat = NULL, .warm = false,
+    .lowfd = -1, .end = NULL
   };
+  cntxt.started = stats_clock();
+  if (cntxt.filelist == NULL || cntxt.hasname == NULL) {
+    goto error_capacity;
+  }
   returnopt res;
   if ((res = opt_init(argc, argv, suppopt, NBOPTION, &cntxt,
       DESC, USAGE, (void *(*)(void *, const void *))addfile)) != SUCCESS) {
     if (res == HELP) {
       goto dispose;
     }
-    if (res == ERR_ADD) {
+    if (cntxt.listret == LNID_EFILE) {
+      fprintf(stderr, "*** Error: Cannot read the list of files %s\n",
+          cntxt.listname);
+      goto error;
+    }
+    if (res == ERR_ADD || cntxt.listret == LNID_ECAP) {
       goto error_capacity;
     }
     if (res == ERR_OPT) {
@@ -147,135 +569,311 @@ int main(int argc, const char *argv[]) {
     printf("No file as entry\n");
     goto dispose;
   }
-  for (size_t k = 0; k < len; ++k) {
-    FILE *f = fopen(da_ref(cntxt.filelist, k), "rb");
-    if (f == NULL) {
-      fprintf(stderr, "*** Error: An error on the file %s occurs\n",
-          (char *) da_ref(cntxt.filelist, k));
+  if ((cntxt.index != NULL || cntxt.saveindex != NULL)
+      && (TAIL(&cntxt) || (cntxt.index != NULL && cntxt.saveindex != NULL))) {
+    fprintf(stderr, "*** Error: Options --index and --save-index are "
+        "incompatible with each other and with --state and --follow\n");
+    goto error;
+  }
+  if (cntxt.lowmem && (TAIL(&cntxt) || cntxt.index != NULL
+      || cntxt.saveindex != NULL)) {
+    fprintf(stderr, "*** Error: Option --low-memory is incompatible with "
+        "--state, --follow, --index and --save-index\n");
+    goto error;
+  }
+  if ((cntxt.top != 0 || cntxt.mincount != 0) && cntxt.index != NULL) {
+    fprintf(stderr, "*** Error: Options --top and --min-count are "
+        "incompatible with --index\n");
+    goto error;
+  }
+  if (cntxt.approx != 0 && (TAIL(&cntxt) || cntxt.index != NULL
+      || cntxt.saveindex != NULL || cntxt.lowmem)) {
+    fprintf(stderr, "*** Error: Option --approx is incompatible with "
+        "--state, --follow, --index, --save-index and --low-memory\n");
+    goto error;
+  }
+  if (cntxt.summary && (TAIL(&cntxt) || cntxt.index != NULL
+      || cntxt.saveindex != NULL || cntxt.lowmem || cntxt.approx != 0
+      || cntxt.top != 0 || cntxt.mincount != 0)) {
+    fprintf(stderr, "*** Error: Option --summary is incompatible with "
+        "--state, --follow, --index, --save-index, --low-memory, --approx, "
+        "--top and --min-count\n");
+    goto error;
+  }
+  if (cntxt.sort && (TAIL(&cntxt) || cntxt.index != NULL
+      || cntxt.saveindex != NULL || cntxt.lowmem || cntxt.approx != 0
+      || cntxt.summary)) {
+    fprintf(stderr, "*** Error: Option --engine=sort is incompatible with "
+        "--state, --follow, --index, --save-index, --low-memory, --approx "
+        "and --summary\n");
+    goto error;
+  }
+  if (cntxt.approx != 0 && len > APPROX_FILES_MAX) {
+    fprintf(stderr, "*** Error: Too many files for option --approx\n");
+    goto error;
+  }
+  if (cntxt.sort && len > LNID_SORT_MAX) {
+    fprintf(stderr, "*** Error: Too many files for option --engine=sort\n");
+    goto error;
+  }
+  if (cntxt.format != OUT_TEXT && (cntxt.follow || cntxt.index != NULL
+      || cntxt.approx != 0 || cntxt.summary)) {
+    fprintf(stderr, "*** Error: Option --output-format is incompatible with "
+        "--follow, --index, --approx and --summary\n");
+    goto error;
+  }
+  if (cntxt.verify && !cntxt.lowmem) {
+    fprintf(stderr, "*** Error: Option --verify requires --low-memory\n");
+    goto error;
+  }
+  if (cntxt.serve != NULL && (server != NULL || TAIL(&cntxt)
+      || cntxt.index != NULL || cntxt.saveindex != NULL || cntxt.lowmem
+      || cntxt.top != 0 || cntxt.mincount != 0 || cntxt.approx != 0
+      || cntxt.summary || cntxt.stats || cntxt.sort
+      || cntxt.format != OUT_TEXT)) {
+    fprintf(stderr, "*** Error: Option --serve is only compatible with "
+        "--filter, --uppercase, --files-from and --hugepages, and not in a "
+        "request\n");
+    goto error;
+  }
+  //  Une requête, exécutée par un processus du serveur, n'écrit aucun fichier.
+  if (server != NULL && (cntxt.state != NULL || cntxt.saveindex != NULL)) {
+    fprintf(stderr, "*** Error: Options --state and --save-index are not "
+        "allowed in a request\n");
+    goto error;
+  }
+  //  Une requête dont le premier fichier est une référence du serveur reprend
+  //    la session de celle-ci si elle la traiterait de la même façon : avec
+  //    le moteur par défaut, hors mode incrémental, le même filtre et la même
+  //    transformation. Le fichier est identifié par son périphérique et son
+  //    numéro d'inœud, quel que soit le chemin qui le désigne ; s'il a changé
+  //    de taille ou de date de modification depuis sa lecture par le serveur,
+  //    la requête est traitée sans reprendre la session.
+  struct stat st;
+  if (server != NULL && len > 1 && !TAIL(&cntxt) && cntxt.index == NULL
+      && cntxt.saveindex == NULL && !cntxt.lowmem && cntxt.approx == 0
+      && !cntxt.summary && !cntxt.sort && cntxt.filter == server->filter
+      && cntxt.upper == server->upper
+      && stat(da_ref(cntxt.filelist, 0), &st) == 0) {
+    for (size_t i = 0; i < da_length(server->filelist); ++i) {
+      const struct stat *ref = &server->refstat[i];
+      if (ref->st_dev == st.st_dev && ref->st_ino == st.st_ino) {
+        if (ref->st_size == st.st_size
+            && ref->st_mtim.tv_sec == st.st_mtim.tv_sec
+            && ref->st_mtim.tv_nsec == st.st_mtim.tv_nsec) {
+          cntxt.session = server->refs[i];
+          cntxt.warm = true;
+        }
+        break;
+      }
+    }
+  }
+  //  Le service par des pages énormes est activé avant toute allocation des
+  //    tables. S'il n'est pas disponible, les zones sont allouées par malloc.
+  if (cntxt.hugepages) {
+    (void) hugemem_enable(true);
+  }
+  size_t k;
+  int rb = build_choose(&cntxt, &k);
+  if (rb < 0) {
+    goto error_capacity;
+  }
+  if (rb > 0) {
+    goto error_file;
+  }
+  lnidret e = LNID_OK;
+  if (cntxt.serve != NULL) {
+    if ((e = serve_run(&cntxt, argv[0], &k)) != LNID_OK) {
+      goto error_lnid;
+    }
+    goto dispose;
+  }
+  //  Les lignes sont traitées par la table de la session, ou par l'index qui
+  //    en tient lieu, sauf en mode approché et en mode résumé : elles sont
+  //    alors passées au résumé ap ou aux compteurs sm. Une session reprise du
+  //    serveur, dont seul le premier fichier a été traité, est étendue aux
+  //    fichiers de la requête.
+  if (cntxt.warm) {
+    if (lnid_extend(cntxt.session, len) != 0) {
+      goto error_capacity;
+    }
+  } else {
+    cntxt.session = lnid_empty(len, (TAIL(&cntxt) ? LNID_TAIL : 0)
+        | (cntxt.lowmem ? LNID_LOWMEM : 0) | (cntxt.sort ? LNID_SORT : 0)
+        | (cntxt.hugepages ? LNID_HUGEPAGES : 0), cntxt.filter, cntxt.upper);
+    if (cntxt.session == NULL) {
+      goto error_capacity;
+    }
+    if (cntxt.pos[0] != 0) {
+      lnid_order(cntxt.session, cntxt.pos[0]);
+    }
+  }
+  if (cntxt.lowmem || cntxt.sort) {
+    k = cntxt.order[0];
+    if ((cntxt.lowfd = open(cntxt.names[0], O_RDONLY)) < 0) {
+      goto error_file;
+    }
+    lnid_source(cntxt.session, cntxt.lowfd);
+  }
+  if (cntxt.verify) {
+    lnid_verify(cntxt.session);
+  }
+  if (cntxt.approx != 0) {
+    size_t m = approx_counters(cntxt.approx);
+    if (m == 0) {
+      fprintf(stderr, "*** Error: Bad argument for option\n");
       goto error;
     }
-    int nbline = 1;
-    int resline;
-    while ((resline = addline(line, f, &cntxt)) >= 0) {
-      size_t dslen = ds_length(line);
-      if (dslen != 0) {
-        char s[dslen];
-        for (size_t k = 0; k < dslen; ++k) {
-          s[k] = ds_ref(line, k);
-        }
-        da *cptr = hashtable_search(ht, s);
-        if (cptr != NULL) {
-          if (k == 0) {
-            if (len == 1) {
-              int *cpt = malloc(sizeof *cpt);
-              if (cpt == NULL) {
-                goto error_capacity;
-              }
-              *cpt = nbline;
-              if (da_add(cptr, cpt) == NULL) {
-                free(cpt);
-                goto error_capacity;
-              }
-              nbline += 1;
-            } else {
-              int *cpt = da_ref(cptr, k);
-              *cpt += 1;
-            }
-          } else {
-            if (da_length(cptr) < k + 1) {
-              int *cpt = malloc(sizeof *cpt);
-              if (cpt == NULL) {
-                goto error_capacity;
-              }
-              *cpt = 1;
-              if (da_add(cptr, cpt) == NULL) {
-                free(cpt);
-                goto error_capacity;
-              }
-            } else {
-              int *cpt = da_ref(cptr, k);
-              *cpt += 1;
-            }
-          }
-        } else {
-          if (k == 0) {
-            char *s = malloc(dslen);
-            if (s == NULL) {
-              goto error_capacity;
-            }
-            for (size_t k = 0; k < dslen; ++k) {
-              s[k] = ds_ref(line, k);
-            }
-            if (holdall_put(has, s) != 0) {
-              free(s);
-              goto error_capacity;
-            }
-            int *cpt = malloc(sizeof *cpt);
-            if (cpt == NULL) {
-              goto error_capacity;
-            }
-            if (len == 1) {
-              *cpt = nbline;
-            } else {
-              *cpt = 1;
-            }
-            if (da_add(cptt, cpt) == NULL) {
-              free(cpt);
-              goto error_capacity;
-            }
-            if (holdall_put(hascpt, cptt) != 0) {
-              free(cptt);
-              goto error_capacity;
-            }
-            if (hashtable_add(ht, s, cptt) == NULL) {
-              goto error_capacity;
-            }
-            cptt = da_empty();
-            if (cptt == NULL) {
-              goto error_capacity;
-            }
-          }
-        }
-        if (len == 1) {
-          ++nbline;
-        }
+    if ((cntxt.ap = approx_empty(m)) == NULL) {
+      goto error_capacity;
+    }
+    lnid_lines(cntxt.session, cntxt.ap, (int (*)(void *, size_t,
+        const char *, size_t, int, off_t))approx_line);
+  }
+  if (cntxt.summary) {
+    if ((cntxt.sm = summary_empty(cntxt.exact)) == NULL) {
+      goto error_capacity;
+    }
+    lnid_lines(cntxt.session, cntxt.sm, (int (*)(void *, size_t,
+        const char *, size_t, int, off_t))summary_line);
+  }
+  if (cntxt.index != NULL
+      && (e = lnid_index_open(cntxt.session, cntxt.index)) != LNID_OK) {
+    goto error_lnid;
+  }
+  if ((cntxt.out = out_empty(cntxt.format, stdout, len, cntxt.names,
+      cntxt.pos)) == NULL) {
+    goto error_capacity;
+  }
+  if (TAIL(&cntxt)) {
+    if ((cntxt.end = calloc(len, sizeof *cntxt.end)) == NULL
+        || (cntxt.start = calloc(len, sizeof *cntxt.start)) == NULL) {
+      goto error_capacity;
+    }
+    if (cntxt.state != NULL && (e = lnid_state_load(cntxt.session,
+        cntxt.state, cntxt.names)) != LNID_OK) {
+      goto error_lnid;
+    }
+  }
+  while (true) {
+    for (size_t p = 0; TAIL(&cntxt) && p < len; ++p) {
+      cntxt.start[p] = lnid_tell(cntxt.session, p, NULL);
+    }
+    //  Le premier fichier d'une session reprise du serveur n'est pas relu. Le
+    //    mode incrémental, seul à fournir des positions de départ, l'exclut.
+    size_t first = (cntxt.warm ? 1 : 0);
+    cntxt.rd = reader_start(cntxt.names + first, cntxt.start, len - first);
+    if (cntxt.rd == NULL) {
+      goto error_capacity;
+    }
+    for (size_t p = first; p < len; ++p) {
+      k = cntxt.order[p];
+      if ((e = lnid_file(&cntxt, p)) != LNID_OK) {
+        goto error_lnid;
+      }
+      if (cntxt.summary && summary_report(cntxt.sm, cntxt.names[p], stdout)
+          != 0) {
+        goto error_write;
       }
-      ds_dispose(&line);
-      line = ds_empty();
-      if (line == NULL) {
-        goto error_capacity;
+      if (p == 0 && cntxt.saveindex != NULL
+          && (e = lnid_index_save(cntxt.session, cntxt.saveindex))
+          != LNID_OK) {
+        goto error_lnid;
       }
-      if (resline > 0) {
-        goto endfile;
+      //  Si aucune ligne ne reste dans la table, les fichiers restants ne sont
+      //    pas lus.
+      if (lnid_exhausted(cntxt.session)) {
+        cntxt.nskipped = len - p - 1;
+        break;
       }
     }
-    ds_dispose(&line);
-    line = ds_empty();
-    if (line == NULL) {
-      goto error_capacity;
+    reader_dispose(&cntxt.rd);
+    if (cntxt.state != NULL && (e = lnid_state_save(cntxt.session,
+        cntxt.state, cntxt.names)) != LNID_OK) {
+      goto error_lnid;
     }
-    if (resline < 0) {
-      goto error_read;
+    if (cntxt.ap != NULL) {
+      size_t p;
+      if ((e = approx_report(cntxt.ap, cntxt.session, cntxt.names, cntxt.top,
+          cntxt.mincount, stdout, &p)) != LNID_OK) {
+        k = (e == LNID_EFILE ? cntxt.order[p] : k);
+        goto error_lnid;
+      }
+      if (approx_fprint_error(cntxt.ap, stderr) != 0) {
+        goto error_write;
+      }
+    } else if (!cntxt.summary) {
+      int ro;
+      if ((ro = out_begin(cntxt.out)) != 0
+          || (ro = lnid_results(cntxt.session, cntxt.top, cntxt.mincount,
+              cntxt.out, (int (*)(void *, const struct lnid_result *))out_line))
+          != 0
+          || (ro = out_end(cntxt.out)) != 0) {
+        e = (ro < 0 ? LNID_ECAP : (lnidret) ro);
+        goto error_lnid;
+      }
+    }
+    if (fflush(stdout) != 0) {
+      goto error_write;
+    }
+    if (cntxt.stats) {
+      stats_report(&cntxt);
     }
-endfile:
-    if (!feof(f)) {
+    if (!cntxt.follow) {
+      break;
+    }
+    if (follow_wait(&cntxt) != 0) {
       goto error_read;
     }
-    if (fclose(f) != 0) {
-      fprintf(stderr, "*** Error: An error on the file %s occurs\n",
-          (char *) da_ref(cntxt.filelist, k));
-      goto error;
+    if (printf("\n") < 0) {
+      goto error_write;
     }
   }
-  if (holdall_apply_context2(has,
-      ht, (void *(*)(void *, void *))hashtable_search,
-      &cntxt, (int (*)(void *, void *, void *))lnid_display) != 0) {
-    goto error_write;
-  }
   goto dispose;
+error_lnid:
+  switch (e) {
+    case LNID_ECAP:
+      goto error_capacity;
+    case LNID_EFILE:
+      goto error_file;
+    case LNID_ETRUNC:
+      fprintf(stderr, "*** Error: The file %s has been truncated\n",
+          (char *) da_ref(cntxt.filelist, k));
+      goto error;
+    case LNID_ESTATE:
+      fprintf(stderr, "*** Error: Invalid state file %s or state file not "
+          "matching the command line\n", cntxt.state);
+      goto error;
+    case LNID_EWRITE:
+      goto error_write;
+    case LNID_ESERVE:
+      fprintf(stderr, "*** Error: Cannot serve on the socket %s: %s\n",
+          cntxt.serve, strerror(errno));
+      goto error;
+    case LNID_ECOLL:
+      fprintf(stderr, "*** Error: Two different lines of the file %s share "
+          "the same fingerprint, run again without --low-memory\n",
+          cntxt.names[0]);
+      goto error;
+    case LNID_EINDEX:
+      if (cntxt.index != NULL) {
+        fprintf(stderr, "*** Error: Invalid index file %s or index file not "
+            "matching the command line\n", cntxt.index);
+      } else {
+        fprintf(stderr, "*** Error: Cannot write the index file %s\n",
+            cntxt.saveindex);
+      }
+      goto error;
+    default:
+      goto error_read;
+  }
 error_capacity:
   fprintf(stderr, "*** Error: Not enough memory\n");
   goto error;
+error_file:
+  fprintf(stderr, "*** Error: An error on the file %s occurs\n",
+      (char *) da_ref(cntxt.filelist, k));
+  goto error;
 error_read:
   fprintf(stderr, "*** Error: A read error occurs\n");
   goto error;
@@ -286,97 +884,368 @@ error:
   r = EXIT_FAILURE;
   goto dispose;
 dispose:
-  ds_dispose(&line);
-  rdafree(cptt);
-  if (suppopt != NULL) {
-    for (int k = 0; k < NBOPTION; ++k) {
-      opt_dispose(&suppopt[k]);
-    }
+  reader_dispose(&cntxt.rd);
+  //  Une session reprise du serveur n'est pas libérée : le processus fils se
+  //    termine sans avoir à parcourir sa copie des tables.
+  if (cntxt.warm) {
+    cntxt.session = NULL;
+  }
+  lnid_dispose(&cntxt.session);
+  for (size_t i = 0; cntxt.refs != NULL && i < da_length(cntxt.filelist);
+      ++i) {
+    lnid_dispose(&cntxt.refs[i]);
+  }
+  free(cntxt.refs);
+  free(cntxt.refstat);
+  for (int k = 0; k < NBOPTION; ++k) {
+    opt_dispose(&suppopt[k]);
   }
   da_dispose(&(cntxt.filelist));
-  hashtable_dispose(&ht);
-  if (has != NULL) {
-    holdall_apply(has, rfree);
+  free(cntxt.order);
+  free(cntxt.pos);
+  free(cntxt.names);
+  free(cntxt.start);
+  free(cntxt.end);
+  out_dispose(&cntxt.out);
+  if (cntxt.lowfd >= 0) {
+    close(cntxt.lowfd);
   }
-  if (hascpt != NULL) {
-    holdall_apply(hascpt, (int (*)(void *))rdafree);
+  approx_dispose(&cntxt.ap);
+  summary_dispose(&cntxt.sm);
+  if (cntxt.hasname != NULL) {
+    holdall_apply(cntxt.hasname, rfree);
   }
-  holdall_dispose(&has);
-  holdall_dispose(&hascpt);
+  holdall_dispose(&cntxt.hasname);
   return r;
 }
 
-size_t str_hashfun(const char *s) {
-  size_t h = 0;
-  for (const unsigned char *p = (const unsigned char *) s; *p != '\0'; ++p) {
-    h = 37 * h + *p;
+//--- Traitement ---------------------------------------------------------------
+
+lnidret lnid_file(cnxt *cntxt, size_t p) {
+  //  pos est la position dans le fichier du premier octet du morceau suivant.
+  off_t pos = (TAIL(cntxt) ? cntxt->start[p] : 0);
+  const char *buf;
+  size_t n;
+  readerret rr;
+  int r = 0;
+  while ((rr = reader_next(cntxt->rd, &buf, &n)) == READER_DATA) {
+    if ((r = lnid_feed(cntxt->session, p, buf, n)) != 0) {
+      return r < 0 ? LNID_ECAP : (lnidret) r;
+    }
+    pos += (off_t) n;
+  }
+  switch (rr) {
+    case READER_EOPEN:
+      return LNID_EFILE;
+    case READER_ESHORT:
+      return LNID_ETRUNC;
+    case READER_EREAD:
+      return LNID_EREAD;
+    default:
+      break;
+  }
+  if (TAIL(cntxt)) {
+    cntxt->end[cntxt->order[p]] = pos;
   }
-  return h;
+  r = lnid_end(cntxt->session, p);
+  return r < 0 ? LNID_ECAP : (lnidret) r;
 }
 
-static int lnid_display(cnxt *cntxt, const char *s, da *cpt) {
+int follow_wait(cnxt *cntxt) {
   size_t len = da_length(cntxt->filelist);
-  if (len == 1) {
-    if (da_length(cpt) < 2) {
-      return 0;
-    }
-    for (size_t k = 0; k < da_length(cpt); k++) {
-      int *c = (da_ref(cpt, k));
-      if (k == da_length(cpt) - 1) {
-        printf("%d", *c);
-      } else {
-        printf("%d,", *c);
+  while (true) {
+    sleep(FOLLOW_DELAY);
+    for (size_t k = 0; k < len; ++k) {
+      struct stat st;
+      if (stat(da_ref(cntxt->filelist, k), &st) != 0) {
+        return -1;
+      }
+      if (st.st_size != cntxt->end[k]) {
+        return 0;
       }
     }
-    return printf("\t%s\n", s) < 0;
-  } else {
-    if (da_length(cpt) < len) {
-      return 0;
-    }
-    for (size_t k = 0; k < da_length(cpt); k++) {
-      int *c = (da_ref(cpt, k));
-      printf("%d\t", *c);
-    }
-    return printf("%s\n", s) < 0;
   }
 }
 
-//--- Fonctions ----------------------------------------------------------------
+//--- Mode serveur -------------------------------------------------------------
 
-int rfree(void *ptr) {
-  free(ptr);
-  return 0;
+//  Le serveur construit la table de chaque fichier de référence dans une
+//    session de deux fichiers, dont les compteurs sont des nombres
+//    d'occurrences, puis crée un processus fils par requête. Le fils reprend
+//    la session de la référence qui est le premier fichier de sa requête, voir
+//    lnid_main : sa copie des tables, partagée avec le serveur tant qu'elle
+//    n'est pas modifiée, ne coûte que la création du processus. Le serveur
+//    garde la connexion du client jusqu'à la fin du fils, attendu par
+//    waitpid, puis lui renvoie son statut de fin.
+
+//  Les signaux SIGINT, SIGTERM et SIGCHLD sont bloqués sauf pendant l'attente
+//    d'une connexion par pselect : la fin d'un fils survenue avant l'attente
+//    ne peut donc être manquée.
+
+//  serve_stop : indicateur de réception de SIGINT ou de SIGTERM par le
+//    serveur.
+static volatile sig_atomic_t serve_stop = 0;
+
+//  serve_signal : Gestionnaire de SIGINT et de SIGTERM du serveur.
+static void serve_signal(int sig) {
+  (void) sig;
+  serve_stop = 1;
 }
 
-int rdafree(da *p) {
-  da_dispose_element(p);
-  da_dispose(&p);
-  return 0;
+//  serve_child : Gestionnaire de SIGCHLD du serveur, dont la réception
+//    interrompt l'attente par pselect.
+static void serve_child(int sig) {
+  (void) sig;
 }
 
-int addline(ds *p, FILE *filename, cnxt *cntxt) {
-  int c;
-  while ((c = fgetc(filename)) != EOF && c != '\n') {
-    if (cntxt->filter == NULL || cntxt->filter(c) != 0) {
-      if (cntxt->transform == NULL || (c = cntxt->transform(c))) {
-        if (ds_add(p, (char) c) < 0) {
-          return -1;
-        }
+//  struct waiting : processus fils pid qui traite la requête reçue sur la
+//    connexion de descripteur fd, composante libre si pid est nul.
+struct waiting {
+  pid_t pid;
+  int fd;
+};
+
+//  waitings : tableau dynamique des processus fils en cours.
+DAGEN(waitings, struct waiting, 16)
+
+//  serve_track : Range dans ws, dans une composante libre ou en bout de
+//    tableau, le processus fils pid de connexion fd.
+//  Renvoie zéro en cas de succès, une valeur non nulle en cas de dépassement
+//    de capacité.
+static int serve_track(waitings *ws, pid_t pid, int fd) {
+  struct waiting w = {
+    .pid = pid, .fd = fd
+  };
+  for (size_t i = 0; i < waitings_length(ws); ++i) {
+    if (waitings_get(ws, i).pid == 0) {
+      *waitings_ref(ws, i) = w;
+      return 0;
+    }
+  }
+  return waitings_add(ws, w);
+}
+
+//  serve_reap : Attend, sans bloquer, les processus fils de ws qui ont pris
+//    fin, renvoie à chacun de leurs clients le statut de fin, 128 plus le
+//    numéro du signal pour un fils tué par un signal, puis ferme leurs
+//    connexions. Un client qui a fermé sa connexion est ignoré.
+static void serve_reap(waitings *ws) {
+  pid_t pid;
+  int st;
+  while ((pid = waitpid(-1, &st, WNOHANG)) > 0) {
+    for (size_t i = 0; i < waitings_length(ws); ++i) {
+      struct waiting *w = waitings_ref(ws, i);
+      if (w->pid == pid) {
+        (void) serve_reply(w->fd, WIFEXITED(st) ? WEXITSTATUS(st)
+            : WIFSIGNALED(st) ? 128 + WTERMSIG(st) : EXIT_FAILURE);
+        close(w->fd);
+        w->pid = 0;
+        break;
       }
     }
   }
-  if (ds_length(p) != 0) {
-    char s = '\0';
-    if (ds_add(p, s) < 0) {
-      return -1;
+}
+
+lnidret serve_run(cnxt *cntxt, const char *argv0, size_t *k) {
+  size_t len = da_length(cntxt->filelist);
+  if ((cntxt->refs = calloc(len, sizeof *cntxt->refs)) == NULL
+      || (cntxt->refstat = calloc(len, sizeof *cntxt->refstat)) == NULL
+      || (cntxt->rd = reader_start(cntxt->names, NULL, len)) == NULL) {
+    return LNID_ECAP;
+  }
+  lnidret e = LNID_OK;
+  for (*k = 0; *k < len; ++*k) {
+    cntxt->refs[*k] = lnid_empty(2,
+        cntxt->hugepages ? LNID_HUGEPAGES : 0, cntxt->filter, cntxt->upper);
+    if (cntxt->refs[*k] == NULL) {
+      e = LNID_ECAP;
+      break;
+    }
+    if (stat(cntxt->names[*k], &cntxt->refstat[*k]) != 0) {
+      e = LNID_EFILE;
+      break;
+    }
+    cntxt->session = cntxt->refs[*k];
+    if ((e = lnid_file(cntxt, 0)) != LNID_OK) {
+      break;
     }
   }
-  if (ferror(filename) != 0) {
-    return -1;
+  cntxt->session = NULL;
+  reader_dispose(&cntxt->rd);
+  if (e != LNID_OK) {
+    return e;
+  }
+  struct sigaction sa;
+  memset(&sa, 0, sizeof sa);
+  sigemptyset(&sa.sa_mask);
+  sa.sa_handler = serve_signal;
+  struct sigaction sc;
+  memset(&sc, 0, sizeof sc);
+  sigemptyset(&sc.sa_mask);
+  sc.sa_handler = serve_child;
+  sigset_t block;
+  sigset_t mask;
+  sigemptyset(&block);
+  sigaddset(&block, SIGINT);
+  sigaddset(&block, SIGTERM);
+  sigaddset(&block, SIGCHLD);
+  int fd;
+  if (sigaction(SIGINT, &sa, NULL) != 0 || sigaction(SIGTERM, &sa, NULL) != 0
+      || sigaction(SIGCHLD, &sc, NULL) != 0
+      || sigprocmask(SIG_BLOCK, &block, &mask) != 0
+      || (fd = serve_listen(cntxt->serve)) < 0) {
+    return LNID_ESERVE;
+  }
+  waitings ws;
+  waitings_init(&ws);
+  while (!serve_stop) {
+    serve_reap(&ws);
+    fd_set rfds;
+    FD_ZERO(&rfds);
+    FD_SET(fd, &rfds);
+    if (pselect(fd + 1, &rfds, NULL, NULL, NULL, &mask) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      e = LNID_ESERVE;
+      break;
+    }
+    int c = serve_accept(fd);
+    if (c < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      e = LNID_ESERVE;
+      break;
+    }
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(fd);
+      exit(serve_request(cntxt, argv0, c, &mask));
+    }
+    if (pid < 0 || serve_track(&ws, pid, c) != 0) {
+      e = (pid < 0 ? LNID_ESERVE : LNID_ECAP);
+      close(c);
+      break;
+    }
   }
-  if (feof(filename)) {
-    return 1;
+  int errnum = errno;
+  //  Les clients des fils encore en cours ne reçoivent pas de statut.
+  for (size_t i = 0; i < waitings_length(&ws); ++i) {
+    if (waitings_get(&ws, i).pid != 0) {
+      close(waitings_get(&ws, i).fd);
+    }
+  }
+  waitings_dispose(&ws);
+  close(fd);
+  unlink(cntxt->serve);
+  errno = errnum;
+  return e;
+}
+
+int serve_request(const cnxt *cntxt, const char *argv0, int fd,
+    const sigset_t *mask) {
+  struct sigaction sa;
+  memset(&sa, 0, sizeof sa);
+  sigemptyset(&sa.sa_mask);
+  sa.sa_handler = SIG_DFL;
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+  sigaction(SIGCHLD, &sa, NULL);
+  sigprocmask(SIG_SETMASK, mask, NULL);
+  size_t n;
+  char **args;
+  int fds[SERVE_NFDS];
+  if (serve_receive(fd, &n, &args, fds) != 0) {
+    return EXIT_FAILURE;
   }
+  close(fd);
+  for (int k = 0; k < SERVE_NFDS; ++k) {
+    if (dup2(fds[k], k) < 0) {
+      return EXIT_FAILURE;
+    }
+  }
+  for (int k = 0; k < SERVE_NFDS; ++k) {
+    if (fds[k] >= SERVE_NFDS) {
+      close(fds[k]);
+    }
+  }
+  //  La première chaîne de la requête est le répertoire de travail du client,
+  //    qui remplace argv0 dans le tableau des arguments passé à lnid_main.
+  if (chdir(args[0]) != 0) {
+    fprintf(stderr, "*** Error: Cannot change to the directory %s: %s\n",
+        args[0], strerror(errno));
+    return EXIT_FAILURE;
+  }
+  if (n > (size_t) INT_MAX) {
+    return EXIT_FAILURE;
+  }
+  args[0] = (char *) argv0;
+  return lnid_main((int) n, (const char **) args, cntxt);
+}
+
+//--- Statistiques -------------------------------------------------------------
+
+#define P_TITLE(textstream, name) \
+  fprintf(textstream, "--- Info: %s\n", name)
+#define P_VALUE(textstream, name, format, value) \
+  fprintf(textstream, "%12s\t" format "\n", name, value)
+
+double stats_clock(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+void stats_report(cnxt *cntxt) {
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) != 0) {
+    memset(&ru, 0, sizeof ru);
+  }
+  struct hugemem_stats hms;
+  int rh = hugemem_get_stats(&hms);
+  struct lnid_stats st;
+  lnid_stats(cntxt->session, &st);
+  P_TITLE(stderr, "lnid");
+  P_VALUE(stderr, "lines", "%zu", st.lines);
+  if (cntxt->sort) {
+    P_VALUE(stderr, "records", "%zu", st.records);
+  } else {
+    P_VALUE(stderr, "pruned", "%zu", st.pruned);
+    P_VALUE(stderr, "skipped", "%zu", cntxt->nskipped);
+  }
+  P_VALUE(stderr, "elapsed", "%.3f s", stats_clock() - cntxt->started);
+  P_VALUE(stderr, "user", "%.3f s",
+      (double) ru.ru_utime.tv_sec + (double) ru.ru_utime.tv_usec * 1e-6);
+  P_VALUE(stderr, "system", "%.3f s",
+      (double) ru.ru_stime.tv_sec + (double) ru.ru_stime.tv_usec * 1e-6);
+  P_VALUE(stderr, "minflt", "%ld", ru.ru_minflt);
+  P_VALUE(stderr, "majflt", "%ld", ru.ru_majflt);
+  P_VALUE(stderr, "maxrss", "%ld kB", ru.ru_maxrss);
+  uint64_t n = st.hotprev + st.hotlookups;
+  P_TITLE(stderr, "hot lines");
+  P_VALUE(stderr, "previous", "%" PRIu64, st.hotprev);
+  P_VALUE(stderr, "hits", "%" PRIu64, st.hothits);
+  P_VALUE(stderr, "lookups", "%" PRIu64, st.hotlookups);
+  P_VALUE(stderr, "hit rate", "%.2f %%", n == 0 ? 0.0
+      : 100.0 * (double) (st.hotprev + st.hothits) / (double) n);
+  P_TITLE(stderr, "hugemem");
+  P_VALUE(stderr, "requested", "%s", cntxt->hugepages ? "yes" : "no");
+  P_VALUE(stderr, "regions", "%zu", hms.nregions);
+  P_VALUE(stderr, "mapped", "%zu kB", hms.mapped >> 10);
+  if (rh != 0) {
+    P_VALUE(stderr, "huge", "%s", "unknown");
+  } else {
+    P_VALUE(stderr, "huge", "%zu kB", hms.huge >> 10);
+  }
+  P_VALUE(stderr, "fallback", "%zu", hms.nfallback);
+}
+
+//--- Fonctions ----------------------------------------------------------------
+
+int rfree(void *ptr) {
+  free(ptr);
   return 0;
 }
 
@@ -384,70 +1253,255 @@ void *addfile(cnxt *p, const char *filename) {
   if (p->filelist == NULL) {
     return NULL;
   }
+  if (*filename == LISTPREFIX) {
+    return files_from(p, filename + 1) == LNID_OK ? (char *) filename : NULL;
+  }
   if (da_add(p->filelist, filename) == NULL) {
     return NULL;
   }
   return (char *) filename;
 }
 
+lnidret files_from(cnxt *cntxt, const char *s) {
+  cntxt->listname = s;
+  bool in = (strcmp(s, LISTSTDIN) == 0);
+  FILE *f = (in ? stdin : fopen(s, "r"));
+  if (f == NULL) {
+    return cntxt->listret = LNID_EFILE;
+  }
+  lnidret e = LNID_OK;
+  char *buf = NULL;
+  size_t size = 0;
+  ssize_t n;
+  while ((n = getline(&buf, &size, f)) >= 0) {
+    size_t len = (size_t) n;
+    if (len > 0 && buf[len - 1] == '\n') {
+      --len;
+    }
+    if (len == 0) {
+      continue;
+    }
+    char *name = malloc(len + 1);
+    if (name == NULL) {
+      e = LNID_ECAP;
+      break;
+    }
+    memcpy(name, buf, len);
+    name[len] = '\0';
+    if (holdall_put(cntxt->hasname, name) != 0) {
+      free(name);
+      e = LNID_ECAP;
+      break;
+    }
+    if (da_add(cntxt->filelist, name) == NULL) {
+      e = LNID_ECAP;
+      break;
+    }
+  }
+  if (e == LNID_OK && ferror(f)) {
+    e = (errno == ENOMEM ? LNID_ECAP : LNID_EFILE);
+  }
+  free(buf);
+  if (!in) {
+    fclose(f);
+  }
+  return cntxt->listret = e;
+}
+
+int build_choose(cnxt *cntxt, size_t *k) {
+  size_t len = da_length(cntxt->filelist);
+  if (len > SIZE_MAX / sizeof *cntxt->order
+      || (cntxt->order = malloc(len * sizeof *cntxt->order)) == NULL
+      || (cntxt->pos = malloc(len * sizeof *cntxt->pos)) == NULL
+      || (cntxt->names = malloc(len * sizeof *cntxt->names)) == NULL) {
+    return -1;
+  }
+  size_t b = 0;
+  off_t bsize = 0;
+  for (*k = 0; *k < len && len > 1 && !TAIL(cntxt) && cntxt->index == NULL
+      && cntxt->saveindex == NULL && cntxt->approx == 0 && !cntxt->summary
+      && cntxt->serve == NULL && !cntxt->warm; ++*k) {
+    struct stat st;
+    if (stat(da_ref(cntxt->filelist, *k), &st) != 0) {
+      return 1;
+    }
+    if (*k == 0 || st.st_size < bsize) {
+      b = *k;
+      bsize = st.st_size;
+    }
+  }
+  cntxt->order[0] = b;
+  for (size_t i = 0, p = 1; i < len; ++i) {
+    if (i != b) {
+      cntxt->order[p] = i;
+      ++p;
+    }
+  }
+  for (size_t p = 0; p < len; ++p) {
+    cntxt->pos[cntxt->order[p]] = p;
+    cntxt->names[p] = da_ref(cntxt->filelist, cntxt->order[p]);
+  }
+  return 0;
+}
+
 //--- Fonction pour les option -------------------------------------------------
 
-int transform_choose(cnxt *cntxt, const char *s) {
-  if (strcmp("-u", s) == 0 || strcmp("--uppercase", s) == 0) {
-    cntxt->transform = toupper;
-    return 0;
+int state_choose(cnxt *cntxt, const char *s) {
+  if (s == NULL) {
+    return -1;
   }
-  return -1;
+  cntxt->state = s;
+  return 0;
 }
 
-int filter_choose(cnxt *cntxt, const char *s) {
-  if (strcmp("isalnum", s) == 0) {
-    cntxt->filter = isalnum;
-    return 0;
+int follow_choose(cnxt *cntxt, const char *s) {
+  (void) s;
+  cntxt->follow = true;
+  return 0;
+}
+
+int index_choose(cnxt *cntxt, const char *s) {
+  if (s == NULL) {
+    return -1;
   }
-  if (strcmp("isalpha", s) == 0) {
-    cntxt->filter = isalpha;
-    return 0;
+  cntxt->index = s;
+  return 0;
+}
+
+int saveindex_choose(cnxt *cntxt, const char *s) {
+  if (s == NULL) {
+    return -1;
   }
-  if (strcmp("isblank", s) == 0) {
-    cntxt->filter = isblank;
-    return 0;
+  cntxt->saveindex = s;
+  return 0;
+}
+
+int lowmem_choose(cnxt *cntxt, const char *s) {
+  (void) s;
+  cntxt->lowmem = true;
+  return 0;
+}
+
+int verify_choose(cnxt *cntxt, const char *s) {
+  (void) s;
+  cntxt->verify = true;
+  return 0;
+}
+
+int hugepages_choose(cnxt *cntxt, const char *s) {
+  (void) s;
+  cntxt->hugepages = true;
+  return 0;
+}
+
+int stats_choose(cnxt *cntxt, const char *s) {
+  (void) s;
+  cntxt->stats = true;
+  return 0;
+}
+
+int format_choose(cnxt *cntxt, const char *s) {
+  if (s == NULL) {
+    return -1;
   }
-  if (strcmp("iscntrl", s) == 0) {
-    cntxt->filter = iscntrl;
-    return 0;
+  return out_format(s, &cntxt->format) ? 0 : -1;
+}
+
+int engine_choose(cnxt *cntxt, const char *s) {
+  if (s == NULL) {
+    return -1;
   }
-  if (strcmp("isdigit", s) == 0) {
-    cntxt->filter = isdigit;
+  if (strcmp(s, ENGINESORT) == 0) {
+    cntxt->sort = true;
     return 0;
   }
-  if (strcmp("isgraph", s) == 0) {
-    cntxt->filter = isgraph;
+  if (strcmp(s, ENGINEHASH) == 0) {
+    cntxt->sort = false;
     return 0;
   }
-  if (strcmp("islower", s) == 0) {
-    cntxt->filter = islower;
+  return -1;
+}
+
+//  count_parse : Renvoie l'entier strictement positif décrit par s, zéro si s
+//    ne décrit pas un tel entier.
+static size_t count_parse(const char *s) {
+  if (s == NULL || !isdigit((unsigned char) *s)) {
     return 0;
   }
-  if (strcmp("isprint", s) == 0) {
-    cntxt->filter = isprint;
+  char *end;
+  errno = 0;
+  unsigned long long n = strtoull(s, &end, 10);
+  if (*end != '\0' || errno != 0 || n > SIZE_MAX) {
     return 0;
   }
-  if (strcmp("ispunct", s) == 0) {
-    cntxt->filter = ispunct;
+  return (size_t) n;
+}
+
+int top_choose(cnxt *cntxt, const char *s) {
+  cntxt->top = count_parse(s);
+  return cntxt->top == 0 ? -1 : 0;
+}
+
+int mincount_choose(cnxt *cntxt, const char *s) {
+  cntxt->mincount = count_parse(s);
+  return cntxt->mincount == 0 ? -1 : 0;
+}
+
+int approx_choose(cnxt *cntxt, const char *s) {
+  const char *eq = strchr(s, '=');
+  if (eq == NULL) {
+    if (strcmp(s, SHORT SHORTAPPROX) != 0 && strcmp(s, LONG LONGAPPROX) != 0) {
+      return -1;
+    }
+    cntxt->approx = APPROX_DEFAULT_MB;
     return 0;
   }
-  if (strcmp("isspace", s) == 0) {
-    cntxt->filter = isspace;
-    return 0;
+  if ((size_t) (eq - s) != strlen(LONG LONGAPPROX)) {
+    return -1;
   }
-  if (strcmp("isupper", s) == 0) {
-    cntxt->filter = isupper;
-    return 0;
+  cntxt->approx = count_parse(eq + 1);
+  return cntxt->approx == 0 ? -1 : 0;
+}
+
+int summary_choose(cnxt *cntxt, const char *s) {
+  const char *eq = strchr(s, '=');
+  if (eq == NULL) {
+    if (strcmp(s, SHORT SHORTSUMMARY) != 0
+        && strcmp(s, LONG LONGSUMMARY) != 0) {
+      return -1;
+    }
+  } else if ((size_t) (eq - s) != strlen(LONG LONGSUMMARY)
+      || strcmp(eq + 1, SUMMARYEXACT) != 0) {
+    return -1;
+  }
+  cntxt->summary = true;
+  cntxt->exact = (eq != NULL);
+  return 0;
+}
+
+int filesfrom_choose(cnxt *cntxt, const char *s) {
+  if (s == NULL) {
+    return -1;
   }
-  if (strcmp("isxdigit", s) == 0) {
-    cntxt->filter = isxdigit;
+  return files_from(cntxt, s) == LNID_OK ? 0 : -1;
+}
+
+int serve_choose(cnxt *cntxt, const char *s) {
+  if (s == NULL) {
+    return -1;
+  }
+  cntxt->serve = s;
+  return 0;
+}
+
+int transform_choose(cnxt *cntxt, const char *s) {
+  if (strcmp("-u", s) == 0 || strcmp("--uppercase", s) == 0) {
+    cntxt->upper = true;
     return 0;
   }
   return -1;
 }
+
+int filter_choose(cnxt *cntxt, const char *s) {
+  return utf8_classbyname(s, &cntxt->filter) ? 0 : -1;
+}
@@ -1,6 +1,7 @@
 // Partie implémentation d'un module pour la gestion d'otion (opt)
 
 #include "opt.h"
+#include "hashtable.h"
 
 //--- Définition opt -----------------------------------------------------------
 struct opt {
@@ -13,32 +14,66 @@ struct opt {
 
 //--- Fonction interne ---------------------------------------------------------
 
-//  suffixe : Renvoie NULL si s1 n'est pas un préfixe de s2, sinon renvoie
-//    le reste de s2 qui n'est pas dans s1.
-static const char *suffixe(const char *s1, const char *s2) {
-  if (*s1 == '\0') {
-    return s2;
+//  struct optable, optable : table de recherche des options, construite une
+//    fois pour toutes au début de opt_init. La table ht associe à la version
+//    courte et à la version longue de chaque option l'option elle-même. Le
+//    champ key, de longueur keylen, reçoit la partie d'un argument recherchée
+//    dans la table ; keylen est la longueur de la plus longue version d'une
+//    option, fin de chaîne comprise.
+typedef struct {
+  hashtable *ht;
+  char *key;
+  size_t keylen;
+} optable;
+
+//  optable_dispose : Libère les ressources allouées à la table t.
+static void optable_dispose(optable *t) {
+  hashtable_dispose(&t->ht);
+  free(t->key);
+  t->key = NULL;
+}
+
+//  optable_build : Construit la table t des nbopt options de optsupp.
+//  Renvoie zéro en cas de succès, une valeur non nulle en cas de dépassement de
+//    capacité.
+static int optable_build(optable *t, opt **optsupp, size_t nbopt) {
+  t->ht = hashtable_empty((int (*)(const void *, const void *))strcmp,
+      hashtable_str_hashfun);
+  t->key = NULL;
+  t->keylen = 1;
+  if (t->ht == NULL) {
+    return -1;
   }
-  if (*s2 == '\0' || *s1 != *s2) {
-    return NULL;
+  for (size_t i = 0; i < nbopt; ++i) {
+    const char *names[] = { optsupp[i]->shortopt, optsupp[i]->longopt };
+    for (size_t j = 0; j < sizeof names / sizeof *names; ++j) {
+      size_t n = strlen(names[j]) + 1;
+      t->keylen = (n > t->keylen ? n : t->keylen);
+      //  Comme lors d'un parcours des options dans l'ordre, la première
+      //    option d'un nom donné l'emporte.
+      if (hashtable_search(t->ht, names[j]) == NULL
+          && hashtable_add(t->ht, names[j], optsupp[i]) == NULL) {
+        optable_dispose(t);
+        return -1;
+      }
+    }
+  }
+  if ((t->key = malloc(t->keylen)) == NULL) {
+    optable_dispose(t);
+    return -1;
   }
-  return suffixe(s1 + 1, s2 + 1);
+  return 0;
 }
 
-//  prefix : Affecte à s la partie commune entre les chaînes de caractére s1 et
-//    s2.
-//  Renvoie NULL si les deux chaînes n'ont rien en commun, s sinon.
-void *prefix(const char *s1, const char *s2, char *s) {
-  int i = 0;
-  while (s1[i] == s2[i] && s1[i] != '\0') {
-    s[i] = s2[i];
-    i++;
-  }
-  s[i] = '\0';
-  if (i == 0) {
+//  optable_search : Recherche dans la table t les len premiers caractères de
+//    s. Renvoie l'option trouvée, NULL si aucune ne correspond.
+static opt *optable_search(optable *t, const char *s, size_t len) {
+  if (len >= t->keylen) {
     return NULL;
   }
-  return s;
+  memcpy(t->key, s, len);
+  t->key[len] = '\0';
+  return hashtable_search(t->ht, t->key);
 }
 
 //  returntest : Énumération des différentes valeurs de retour de la fonction
@@ -53,48 +88,54 @@ typedef enum {
 } returntest;
 
 //  opt_test : Test si l'argument d'indice k contenu dans argv est une option
-//    contenu dans le tableau optsupp. Si oui alors appelle sa fonction
-//    d'initialisation.
+//    de la table t. Si oui alors appelle sa fonction d'initialisation. Un
+//    argument est une option s'il est égal à la version courte ou à la version
+//    longue d'une option, ou si sa partie qui précède le premier « = » est
+//    égale à la version longue d'une option, ce signe compris pour une option
+//    qui prend un argument, non compris sinon : la fonction d'initialisation
+//    reçoit alors respectivement la suite de l'argument ou l'argument entier.
+//    Le coût du test est proportionnel à la longueur de l'argument.
 //  Renvoie NOT_OPT si l'argument n'est pas une option, ERR_ADDTEST si une
 //    erreur est survenue lors de l'exécution de la fonction d'initialisation
 //    d'une option, CAP_ERR en cas de dépassement de capacité. SHORTOPT si
 //    l'argument est la courte version de l'option, SHORTOPTARG si l'argument
 //    est la courte version de l'option et que l'option prend un argument ou
 //    LONGOPT si l'argument est la version longue de l'option.
-static returntest opt_test(void *cntxt, opt **optsupp, const char **argv, int k,
-    size_t nbopt) {
-  for (size_t i = 0; i < nbopt; ++i) {
-    if (strcmp((optsupp[i])->shortopt, argv[k]) == 0) {
-      if (optsupp[i]->arg) {
-        if ((optsupp[i]->fun(cntxt, argv[k + 1])) != 0) {
-          return ERR_ADDTEST;
-        }
-        return SHORTOPTARG;
-      } else {
-        if ((optsupp[i]->fun(cntxt, argv[k])) != 0) {
-          return ERR_ADDTEST;
-        }
-        return SHORTOPT;
+static returntest opt_test(void *cntxt, optable *t, const char **argv,
+    int k) {
+  size_t len = strlen(argv[k]);
+  opt *op = optable_search(t, argv[k], len);
+  if (op != NULL && strcmp(op->shortopt, argv[k]) == 0) {
+    if (op->arg) {
+      if ((op->fun(cntxt, argv[k + 1])) != 0) {
+        return ERR_ADDTEST;
       }
+      return SHORTOPTARG;
     }
-    char s[strlen((optsupp[i])->longopt)];
-    if (prefix(optsupp[i]->longopt, argv[k], s) != NULL) {
-      if (strcmp((optsupp[i])->longopt, s) == 0) {
-        if (optsupp[i]->arg) {
-          if ((optsupp[i]->fun(cntxt,
-              (suffixe(optsupp[i]->longopt, argv[k])))) != 0) {
-            return ERR_ADDTEST;
-          }
-        } else {
-          if ((optsupp[i]->fun(cntxt, argv[k])) != 0) {
-            return ERR_ADDTEST;
-          }
-        }
-        return LONGOPT;
+    if ((op->fun(cntxt, argv[k])) != 0) {
+      return ERR_ADDTEST;
+    }
+    return SHORTOPT;
+  }
+  if (op == NULL) {
+    const char *eq = strchr(argv[k], '=');
+    if (eq == NULL) {
+      return NOT_OPT;
+    }
+    size_t n = (size_t) (eq - argv[k]);
+    if ((op = optable_search(t, argv[k], n + 1)) == NULL || !op->arg
+        || strcmp(op->longopt, t->key) != 0) {
+      if ((op = optable_search(t, argv[k], n)) == NULL || op->arg
+          || strcmp(op->longopt, t->key) != 0) {
+        return NOT_OPT;
       }
     }
   }
-  return NOT_OPT;
+  if ((op->fun(cntxt, op->arg ? argv[k] + strlen(op->longopt) : argv[k]))
+      != 0) {
+    return ERR_ADDTEST;
+  }
+  return LONGOPT;
 }
 
 //--- Fonctions opt ------------------------------------------------------------
@@ -133,7 +174,12 @@ returnopt opt_init(int argc, const char **argv, opt **optsupp, size_t nbopt,
   if (argc < 2) {
     return NO_OPT;
   }
-  for (int k = 1; k < argc; ++k) {
+  optable t;
+  if (optable_build(&t, optsupp, nbopt) != 0) {
+    return ERROR;
+  }
+  returnopt r = SUCCESS;
+  for (int k = 1; r == SUCCESS && k < argc; ++k) {
     if (strcmp(SHORTHELP, argv[k]) == 0 || strcmp(LONGHELP, argv[k]) == 0) {
       if (desc != NULL) {
         printf("%s\n", desc);
@@ -144,24 +190,26 @@ returnopt opt_init(int argc, const char **argv, opt **optsupp, size_t nbopt,
       for (size_t i = 0; i < nbopt; ++i) {
         PRINTF_OPT(optsupp[i]);
       }
-      return HELP;
+      r = HELP;
+      break;
     }
     int res;
-    if ((res = opt_test(cntxt, optsupp, argv, k, nbopt)) != SHORTOPT
+    if ((res = opt_test(cntxt, &t, argv, k)) != SHORTOPT
         || res != LONGOPT) {
       if (res == NOT_OPT) {
         if (fun(cntxt, argv[k]) == NULL) {
-          return ERR_ADD;
+          r = ERR_ADD;
         }
       } else if (res == ERR_ADDTEST) {
-        return ERR_OPT;
+        r = ERR_OPT;
       } else if (res == CAP_ERR) {
-        return ERROR;
+        r = ERROR;
       }
     }
     if (res == SHORTOPTARG) {
       k++;
     }
   }
-  return SUCCESS;
+  optable_dispose(&t);
+  return r;
 }
@@ -0,0 +1,405 @@
+//  out.c : partie implantation d'un module d'écriture du résultat d'une
+//    session du module lnid aux formats text, tsv, jsonl et bin.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include "out.h"
+#include "utf8.h"
+#include "hugemem.h"
+#include "dagen.h"
+
+//  Un résultat au format bin est une suite d'entiers non signés dans l'ordre
+//    des octets de la machine et d'octets, dont chaque partie commence à une
+//    position multiple de 8 et peut donc être lue en place dans une projection
+//    du fichier. Il contient, dans l'ordre :
+//  - un en-tête, de type struct binheader : la signature OUT__BIN_MAGIC, fin
+//      de chaîne comprise, la version OUT__BIN_VERSION et le nombre f de
+//      compteurs par ligne sur 32 bits, puis le nombre n de lignes, le nombre
+//      m de numéros de lignes et le nombre t d'octets des textes sur 64 bits ;
+//  - les compteurs : n × f entiers de 32 bits, ligne par ligne. Pour un seul
+//      fichier, f vaut 1 et le compteur d'une ligne est son nombre
+//      d'occurrences ; sinon, f est le nombre de fichiers et les compteurs
+//      suivent l'ordre des noms des fichiers ;
+//  - les numéros de lignes : m entiers de 32 bits, m valant zéro pour
+//      plusieurs fichiers. Les numéros des occurrences d'une ligne, croissants,
+//      suivent ceux des lignes qui la précèdent : leur position se déduit des
+//      compteurs ;
+//  - les positions des textes : n + 1 entiers de 64 bits, la position du
+//      texte de chaque ligne dans la partie des textes puis t ;
+//  - les textes : t octets, sans fin de chaîne ni fin de ligne.
+
+//  Signature et version du format bin, nombre maximal de morceaux passés à un
+//    même appel de writev.
+#define OUT__BIN_MAGIC "LNIDBIN"
+#define OUT__BIN_VERSION 1
+#define OUT__BIN_IOV_MAX 1024
+
+//  OUT__BIN_PAD : nombre d'octets de remplissage qui suivent une partie de n
+//    octets.
+#define OUT__BIN_PAD(n) ((sizeof(uint64_t) - (n) % sizeof(uint64_t)) \
+  % sizeof(uint64_t))
+
+struct binheader {
+  char magic[8];
+  uint32_t version;
+  uint32_t ncols;
+  uint64_t nlines;
+  uint64_t nnumbers;
+  uint64_t nbytes;
+};
+
+//  u32s, u64s, iovs : tableaux dynamiques des colonnes et des morceaux du
+//    résultat au format bin.
+DAGEN(u32s, uint32_t, 1)
+DAGEN(u64s, uint64_t, 1)
+DAGEN(iovs, struct iovec, 1)
+
+//  Les champs format, stream, nfiles, names et pos sont les paramètres de
+//    out_empty.
+
+//  Au format bin, les champs counts, numbers et offsets sont les colonnes des
+//    compteurs, des numéros de lignes et des positions des textes du résultat
+//    en cours de construction et le champ nbytes la longueur totale des
+//    textes. Le champ texts décrit les textes, dans l'ordre, par des morceaux
+//    qui pointent sur les contenus des lignes ou, lorsque ceux-ci ont été
+//    relus, sur leurs copies dans l'entrepôt arena.
+struct out {
+  outformat format;
+  FILE *stream;
+  size_t nfiles;
+  const char * const *names;
+  const size_t *pos;
+  u32s counts;
+  u32s numbers;
+  u64s offsets;
+  uint64_t nbytes;
+  iovs texts;
+  hugemem_arena *arena;
+};
+
+bool out_format(const char *name, outformat *format) {
+  static const char *names[] = {
+    [OUT_TEXT] = "text", [OUT_TSV] = "tsv", [OUT_JSONL] = "jsonl",
+    [OUT_BIN] = "bin",
+  };
+  for (size_t k = 0; k < sizeof names / sizeof *names; ++k) {
+    if (strcmp(name, names[k]) == 0) {
+      *format = (outformat) k;
+      return true;
+    }
+  }
+  return false;
+}
+
+out *out_empty(outformat format, FILE *stream, size_t nfiles,
+    const char * const *names, const size_t *pos) {
+  out *o = malloc(sizeof *o);
+  if (o == NULL) {
+    return NULL;
+  }
+  *o = (struct out) {
+    .format = format, .stream = stream, .nfiles = nfiles, .names = names,
+    .pos = pos, .nbytes = 0, .arena = NULL
+  };
+  u32s_init(&o->counts);
+  u32s_init(&o->numbers);
+  u64s_init(&o->offsets);
+  iovs_init(&o->texts);
+  if (format == OUT_BIN && (o->arena = hugemem_arena_empty()) == NULL) {
+    out_dispose(&o);
+  }
+  return o;
+}
+
+void out_dispose(out **optr) {
+  if (*optr == NULL) {
+    return;
+  }
+  out *o = *optr;
+  u32s_dispose(&o->counts);
+  u32s_dispose(&o->numbers);
+  u64s_dispose(&o->offsets);
+  iovs_dispose(&o->texts);
+  hugemem_arena_dispose(&o->arena);
+  free(o);
+  *optr = NULL;
+}
+
+//--- Formats text, tsv et jsonl -----------------------------------------------
+
+//  out__tsv_escape, out__jsonl_escape : Affectent à buf le remplacement du
+//    premier caractère de la chaîne s de longueur n, non nulle, au format tsv
+//    (resp. jsonl) et renvoient sa longueur, ou renvoient zéro s'il n'est pas
+//    remplacé. Affectent à *len la longueur du caractère dans s.
+static size_t out__tsv_escape(const char *s, size_t n, size_t *len,
+    char *buf) {
+  (void) n;
+  *len = 1;
+  switch (*s) {
+    case '\t':
+      memcpy(buf, "\\t", 2);
+      return 2;
+    case '\r':
+      memcpy(buf, "\\r", 2);
+      return 2;
+    case '\\':
+      memcpy(buf, "\\\\", 2);
+      return 2;
+    default:
+      return 0;
+  }
+}
+
+static size_t out__jsonl_escape(const char *s, size_t n, size_t *len,
+    char *buf) {
+  static const char hex[] = "0123456789abcdef";
+  unsigned char c = (unsigned char) *s;
+  *len = 1;
+  if (c == '"' || c == '\\') {
+    buf[0] = '\\';
+    buf[1] = (char) c;
+    return 2;
+  }
+  //  Une chaîne JSON est en UTF-8 : un octet qui ne commence pas un caractère
+  //    valide est remplacé par le caractère de remplacement U+FFFD.
+  if (c >= 0x80) {
+    uint32_t cp;
+    *len = utf8_decode(s, n, &cp);
+    if (cp != UTF8_INVALID) {
+      return 0;
+    }
+    memcpy(buf, "\\ufffd", 6);
+    return 6;
+  }
+  if (c >= 0x20) {
+    return 0;
+  }
+  memcpy(buf, "\\u00", 4);
+  buf[4] = hex[c >> 4];
+  buf[5] = hex[c & 0xF];
+  return 6;
+}
+
+//  out__escaped : Écrit sur le flot de o la chaîne s, dont chaque caractère
+//    remplacé par esc l'est par son remplacement. Les suites de caractères non
+//    remplacés sont écrites d'un seul tenant.
+static int out__escaped(out *o, const char *s,
+    size_t (*esc)(const char *, size_t, size_t *, char *)) {
+  const char *run = s;
+  const char *end = s + strlen(s);
+  char buf[8];
+  while (s < end) {
+    size_t len;
+    size_t n = esc(s, (size_t) (end - s), &len, buf);
+    if (n == 0) {
+      s += len;
+      continue;
+    }
+    size_t r = (size_t) (s - run);
+    if (fwrite(run, 1, r, o->stream) != r
+        || fwrite(buf, 1, n, o->stream) != n) {
+      return LNID_EWRITE;
+    }
+    s += len;
+    run = s;
+  }
+  size_t r = (size_t) (s - run);
+  return fwrite(run, 1, r, o->stream) != r ? LNID_EWRITE : 0;
+}
+
+//  out__text, out__tsv, out__jsonl : Écrivent sur le flot de o la ligne r du
+//    résultat au format text (resp. tsv, jsonl).
+static int out__text(out *o, const struct lnid_result *r) {
+  if (o->nfiles == 1 && r->indexed == 0) {
+    for (size_t k = 0; k < r->ncounts; k++) {
+      if (k == r->ncounts - 1) {
+        fprintf(o->stream, "%d", r->counts[k]);
+      } else {
+        fprintf(o->stream, "%d,", r->counts[k]);
+      }
+    }
+    return fprintf(o->stream, "\t%s\n", r->text) < 0 ? LNID_EWRITE : 0;
+  }
+  if (r->indexed != 0) {
+    fprintf(o->stream, "%" PRIu64 "\t", r->indexed);
+  }
+  for (size_t k = 0; k < o->nfiles; k++) {
+    fprintf(o->stream, "%d\t", r->counts[o->pos[k]]);
+  }
+  return fprintf(o->stream, "%s\n", r->text) < 0 ? LNID_EWRITE : 0;
+}
+
+static int out__tsv(out *o, const struct lnid_result *r) {
+  if (o->nfiles == 1) {
+    for (size_t k = 0; k < r->ncounts; ++k) {
+      fprintf(o->stream, k == 0 ? "%d" : ",%d", r->counts[k]);
+    }
+    putc('\t', o->stream);
+  } else {
+    for (size_t k = 0; k < o->nfiles; ++k) {
+      fprintf(o->stream, "%d\t", r->counts[o->pos[k]]);
+    }
+  }
+  return out__escaped(o, r->text, out__tsv_escape) != 0
+    || putc('\n', o->stream) == EOF ? LNID_EWRITE : 0;
+}
+
+static int out__jsonl(out *o, const struct lnid_result *r) {
+  size_t n = (o->nfiles == 1 ? r->ncounts : o->nfiles);
+  fputs(o->nfiles == 1 ? "{\"lines\":[" : "{\"counts\":[", o->stream);
+  for (size_t k = 0; k < n; ++k) {
+    fprintf(o->stream, k == 0 ? "%d" : ",%d",
+        r->counts[o->nfiles == 1 ? k : o->pos[k]]);
+  }
+  fputs("],\"text\":\"", o->stream);
+  return out__escaped(o, r->text, out__jsonl_escape) != 0
+    || fputs("\"}\n", o->stream) == EOF ? LNID_EWRITE : 0;
+}
+
+//--- Format bin ---------------------------------------------------------------
+
+//  out__bin_add : Ajoute au résultat au format bin de o la ligne r du résultat,
+//    de contenu s. La chaîne s doit rester valide jusqu'à l'appel de out_end :
+//    elle n'est pas copiée.
+static int out__bin_add(out *o, const char *s, const struct lnid_result *r) {
+  if (o->nfiles == 1) {
+    size_t n = r->ncounts;
+    if (u32s_add(&o->counts, (uint32_t) n) != 0
+        || u32s_reserve(&o->numbers, u32s_length(&o->numbers) + n) != 0) {
+      return -1;
+    }
+    for (size_t k = 0; k < n; ++k) {
+      if (u32s_add(&o->numbers, (uint32_t) r->counts[k]) != 0) {
+        return -1;
+      }
+    }
+  } else {
+    for (size_t k = 0; k < o->nfiles; ++k) {
+      if (u32s_add(&o->counts, (uint32_t) r->counts[o->pos[k]]) != 0) {
+        return -1;
+      }
+    }
+  }
+  size_t n = strlen(s);
+  if (u64s_add(&o->offsets, o->nbytes) != 0) {
+    return -1;
+  }
+  o->nbytes += n;
+  return iovs_add(&o->texts, (struct iovec) {
+    .iov_base = (void *) s, .iov_len = n
+  }) != 0 ? -1 : 0;
+}
+
+//  out__bin_writev : Écrit sur le descripteur fd les n morceaux décrits par
+//    iov, par appels successifs de writev d'au plus OUT__BIN_IOV_MAX morceaux.
+//    Les morceaux sont modifiés au fil des écritures partielles.
+static int out__bin_writev(int fd, struct iovec *iov, size_t n) {
+  while (n > 0) {
+    ssize_t w = writev(fd, iov,
+        (int) (n < OUT__BIN_IOV_MAX ? n : OUT__BIN_IOV_MAX));
+    if (w < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return LNID_EWRITE;
+    }
+    size_t r = (size_t) w;
+    while (n > 0 && r >= iov->iov_len) {
+      r -= iov->iov_len;
+      ++iov;
+      --n;
+    }
+    if (n > 0) {
+      iov->iov_base = (char *) iov->iov_base + r;
+      iov->iov_len -= r;
+    }
+  }
+  return 0;
+}
+
+//  out__bin_write : Écrit sur le flot de o, à l'aide de writev, l'en-tête et
+//    les colonnes du résultat au format bin de o puis les textes de ses
+//    lignes là où ils se trouvent.
+static int out__bin_write(out *o) {
+  static const char zero[sizeof(uint64_t)] = { 0 };
+  size_t n = u64s_length(&o->offsets);
+  if (u64s_add(&o->offsets, o->nbytes) != 0) {
+    return -1;
+  }
+  struct binheader hd = {
+    .magic = OUT__BIN_MAGIC, .version = OUT__BIN_VERSION,
+    .ncols = (uint32_t) o->nfiles, .nlines = n,
+    .nnumbers = u32s_length(&o->numbers), .nbytes = o->nbytes
+  };
+  size_t nc = u32s_length(&o->counts) * sizeof(uint32_t);
+  size_t nn = u32s_length(&o->numbers) * sizeof(uint32_t);
+  struct iovec head[] = {
+    { .iov_base = &hd, .iov_len = sizeof hd },
+    { .iov_base = u32s_ref(&o->counts, 0), .iov_len = nc },
+    { .iov_base = (void *) zero, .iov_len = OUT__BIN_PAD(nc) },
+    { .iov_base = u32s_ref(&o->numbers, 0), .iov_len = nn },
+    { .iov_base = (void *) zero, .iov_len = OUT__BIN_PAD(nn) },
+    { .iov_base = u64s_ref(&o->offsets, 0),
+      .iov_len = (n + 1) * sizeof(uint64_t) },
+  };
+  //  Les textes sont écrits là où ils se trouvent, sans copie.
+  int fd = fileno(o->stream);
+  if (fflush(o->stream) != 0
+      || out__bin_writev(fd, head, sizeof head / sizeof *head) != 0) {
+    return LNID_EWRITE;
+  }
+  return out__bin_writev(fd, iovs_ref(&o->texts, 0), iovs_length(&o->texts));
+}
+
+//--- Écriture du résultat -----------------------------------------------------
+
+int out_begin(out *o) {
+  if (o->format != OUT_TSV) {
+    return 0;
+  }
+  if (o->nfiles == 1) {
+    return fprintf(o->stream, "lines\ttext\n") < 0 ? LNID_EWRITE : 0;
+  }
+  for (size_t k = 0; k < o->nfiles; ++k) {
+    if (out__escaped(o, o->names[o->pos[k]], out__tsv_escape) != 0
+        || putc('\t', o->stream) == EOF) {
+      return LNID_EWRITE;
+    }
+  }
+  return fprintf(o->stream, "text\n") < 0 ? LNID_EWRITE : 0;
+}
+
+int out_line(out *o, const struct lnid_result *r) {
+  switch (o->format) {
+    case OUT_TSV:
+      return out__tsv(o, r);
+    case OUT_JSONL:
+      return out__jsonl(o, r);
+    case OUT_BIN:
+      break;
+    default:
+      return out__text(o, r);
+  }
+  //  Les textes ne sont écrits qu'à la fin du résultat : une ligne relue est
+  //    copiée dans l'entrepôt du résultat.
+  if (!r->reread) {
+    return out__bin_add(o, r->text, r);
+  }
+  size_t n = strlen(r->text) + 1;
+  char *t = hugemem_arena_alloc(o->arena, n);
+  if (t == NULL) {
+    return -1;
+  }
+  memcpy(t, r->text, n);
+  return out__bin_add(o, t, r);
+}
+
+int out_end(out *o) {
+  return o->format == OUT_BIN ? out__bin_write(o) : 0;
+}
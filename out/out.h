@@ -0,0 +1,93 @@
+//  out.h : partie interface d'un module d'écriture du résultat d'une session
+//    du module lnid aux formats text, tsv, jsonl et bin.
+
+#ifndef OUT__H
+#define OUT__H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "lnid.h"
+
+//  Fonctionnement général :
+//  - le résultat d'une session de nfiles fichiers est écrit sur un flot
+//      ouvert en écriture : out_begin écrit ce qui précède ses lignes, chaque
+//      ligne est écrite par out_line, à laquelle elles sont passées dans leur
+//      ordre, par exemple par lnid_results, puis out_end écrit ce qui les
+//      suit ;
+//  - les compteurs d'une ligne, dans l'ordre de traitement des fichiers de la
+//      session, sont écrits dans l'ordre de leurs noms : le fichier de nom
+//      d'indice k a pour position pos[k] dans l'ordre de traitement. Pour un
+//      seul fichier, les compteurs sont des numéros de lignes sauf, au format
+//      text, si un index tient lieu de table ;
+//  - au format text, chaque ligne est écrite comme ses compteurs, séparés par
+//      une virgule pour un seul fichier, suivis chacun d'une tabulation pour
+//      plusieurs, puis son contenu. Lorsqu'un index tient lieu de table, le
+//      nombre d'occurrences mémorisé par l'index précède ses compteurs ;
+//  - au format tsv, une ligne d'en-tête donne le nom de chaque colonne :
+//      « lines » pour un seul fichier, le nom de chaque fichier sinon, puis
+//      « text ». Les caractères tabulation, retour chariot et barre oblique
+//      inverse des lignes et des noms de fichiers sont remplacés par « \t »,
+//      « \r » et « \\ » ;
+//  - au format jsonl, chaque ligne est décrite par un objet
+//      {"lines":[...],"text":"..."} pour un seul fichier ou
+//      {"counts":[...],"text":"..."} pour plusieurs. Les guillemets, barres
+//      obliques inverses et caractères de contrôle du texte sont protégés,
+//      ses autres octets recopiés tels quels ;
+//  - au format bin, le résultat est construit au fil des lignes puis écrit
+//      d'un seul tenant par out_end, voir out.c : les contenus des lignes ne
+//      sont pas copiés, sauf ceux qui ont été relus, voir struct lnid_result,
+//      et doivent rester valides jusqu'à l'appel de out_end ;
+//  - les fonctions qui renvoient une valeur de type int renvoient zéro en cas
+//      de succès, une valeur négative en cas de dépassement de capacité et
+//      LNID_EWRITE en cas d'erreur d'écriture ;
+//  - les fonctions qui possèdent un paramètre de type « out * » ont un
+//      comportement indéterminé lorsque ce paramètre n'est pas l'adresse d'un
+//      contrôleur préalablement renvoyé par out_empty et non encore libéré.
+
+//  outformat : énumération des formats du résultat.
+typedef enum {
+  OUT_TEXT,
+  OUT_TSV,
+  OUT_JSONL,
+  OUT_BIN,
+} outformat;
+
+//  struct out, out : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour écrire un résultat.
+typedef struct out out;
+
+//  out_format : affecte à *format le format de nom name, « text », « tsv »,
+//    « jsonl » ou « bin ». Renvoie true en cas de succès, false si name n'est
+//    le nom d'aucun format.
+extern bool out_format(const char *name, outformat *format);
+
+//  out_empty : tente d'allouer les ressources nécessaires pour écrire sur le
+//    flot stream, au format format, le résultat d'une session de nfiles
+//    fichiers, de noms dans l'ordre de traitement ceux de names et dont le
+//    k-ième dans l'ordre de la ligne de commande a pour position dans l'ordre
+//    de traitement pos[k] : compteurs et noms sont écrits dans l'ordre de la
+//    ligne de commande. Les tableaux names et pos doivent rester valides
+//    jusqu'à la libération du contrôleur. Renvoie NULL en cas de dépassement
+//    de capacité. Renvoie sinon un pointeur vers le contrôleur associé.
+extern out *out_empty(outformat format, FILE *stream, size_t nfiles,
+    const char * const *names, const size_t *pos);
+
+//  out_dispose : sans effet si *optr vaut NULL. Libère sinon les ressources
+//    allouées à la gestion du contrôleur associé à *optr puis affecte NULL à
+//    *optr.
+extern void out_dispose(out **optr);
+
+//  out_begin : écrit ce qui précède les lignes du résultat : la ligne d'en-tête
+//    au format tsv, rien sinon.
+extern int out_begin(out *o);
+
+//  out_line : écrit, ou ajoute au résultat au format bin, la ligne r du
+//    résultat, dont le contenu ne doit pas valoir NULL.
+extern int out_line(out *o, const struct lnid_result *r);
+
+//  out_end : écrit ce qui suit les lignes du résultat : au format bin, le
+//    résultat en entier, rien sinon.
+extern int out_end(out *o);
+
+#endif
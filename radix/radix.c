@@ -0,0 +1,129 @@
+//  radix.c : partie implantation d'un module de tri par base d'enregistrements
+//    à clé entière de 64 bits.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "radix.h"
+
+//  Chaque passe répartit les enregistrements selon un octet de leur clé. Le
+//    tableau est découpé en tranches contiguës, une par fil d'exécution : les
+//    fils comptent chacun les octets de leur tranche, puis la position de
+//    destination du premier enregistrement de chaque tranche pour chaque
+//    valeur d'octet s'en déduit par cumul, dans l'ordre des valeurs puis des
+//    tranches ; les fils déplacent enfin chacun les enregistrements de leur
+//    tranche. Les destinations étant disjointes, aucun verrou n'est requis, et
+//    le parcours de chaque tranche dans l'ordre garantit la stabilité.
+
+#define RADIX__BITS 8
+#define RADIX__NBUCKETS (1 << RADIX__BITS)
+#define RADIX__NPASSES (64 / RADIX__BITS)
+#define RADIX__THREADS_MAX 16
+
+//  struct task : part d'une passe confiée à un fil d'exécution. Les
+//    enregistrements de rangs lo à hi - 1 du tableau src, de words mots de 64
+//    bits, sont répartis selon l'octet de clé de décalage shift. Le tableau
+//    count reçoit le nombre d'enregistrements de la tranche pour chaque valeur
+//    d'octet, puis le rang de destination dans dst du suivant d'entre eux.
+struct task {
+  const uint64_t *src;
+  uint64_t *dst;
+  size_t lo;
+  size_t hi;
+  size_t words;
+  unsigned shift;
+  size_t count[RADIX__NBUCKETS];
+};
+
+static void *radix__count(void *arg) {
+  struct task *t = arg;
+  memset(t->count, 0, sizeof t->count);
+  const uint64_t *p = t->src + t->lo * t->words;
+  for (size_t i = t->lo; i < t->hi; ++i, p += t->words) {
+    t->count[(*p >> t->shift) & (RADIX__NBUCKETS - 1)] += 1;
+  }
+  return NULL;
+}
+
+static void *radix__scatter(void *arg) {
+  struct task *t = arg;
+  const uint64_t *p = t->src + t->lo * t->words;
+  for (size_t i = t->lo; i < t->hi; ++i, p += t->words) {
+    size_t d = (*p >> t->shift) & (RADIX__NBUCKETS - 1);
+    uint64_t *q = t->dst + t->count[d] * t->words;
+    t->count[d] += 1;
+    for (size_t w = 0; w < t->words; ++w) {
+      q[w] = p[w];
+    }
+  }
+  return NULL;
+}
+
+//  radix__run : applique fun aux nt parts de tasks, la première par le fil
+//    appelant et chacune des autres par un nouveau fil, ou par le fil appelant
+//    si sa création échoue. Attend la fin de tous les fils créés.
+static void radix__run(struct task *tasks, size_t nt, void *(*fun)(void *)) {
+  pthread_t th[RADIX__THREADS_MAX];
+  bool started[RADIX__THREADS_MAX];
+  for (size_t k = 1; k < nt; ++k) {
+    started[k] = (pthread_create(&th[k], NULL, fun, &tasks[k]) == 0);
+  }
+  fun(&tasks[0]);
+  for (size_t k = 1; k < nt; ++k) {
+    if (started[k]) {
+      pthread_join(th[k], NULL);
+    } else {
+      fun(&tasks[k]);
+    }
+  }
+}
+
+void radix_sort(void *base, void *tmp, size_t n, size_t size,
+    size_t nthreads) {
+  if (n < 2) {
+    return;
+  }
+  size_t nt = n / RADIX_MIN_SPLIT;
+  nt = (nt < nthreads ? nt : nthreads);
+  nt = (nt < RADIX__THREADS_MAX ? nt : RADIX__THREADS_MAX);
+  nt = (nt == 0 ? 1 : nt);
+  struct task tasks[RADIX__THREADS_MAX];
+  uint64_t *src = base;
+  uint64_t *dst = tmp;
+  for (unsigned pass = 0; pass < RADIX__NPASSES; ++pass) {
+    for (size_t k = 0; k < nt; ++k) {
+      tasks[k].src = src;
+      tasks[k].dst = dst;
+      tasks[k].lo = n / nt * k;
+      tasks[k].hi = (k == nt - 1 ? n : n / nt * (k + 1));
+      tasks[k].words = size / sizeof(uint64_t);
+      tasks[k].shift = pass * RADIX__BITS;
+    }
+    radix__run(tasks, nt, radix__count);
+    size_t off = 0;
+    bool constant = false;
+    for (size_t d = 0; d < RADIX__NBUCKETS; ++d) {
+      size_t total = 0;
+      for (size_t k = 0; k < nt; ++k) {
+        size_t c = tasks[k].count[d];
+        tasks[k].count[d] = off + total;
+        total += c;
+      }
+      constant = constant || total == n;
+      off += total;
+    }
+    if (constant) {
+      continue;
+    }
+    radix__run(tasks, nt, radix__scatter);
+    uint64_t *t = src;
+    src = dst;
+    dst = t;
+  }
+  if (src != base) {
+    memcpy(base, src, n * size);
+  }
+}
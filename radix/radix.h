@@ -0,0 +1,34 @@
+//  radix.h : partie interface d'un module de tri par base d'enregistrements
+//    à clé entière de 64 bits.
+
+#ifndef RADIX__H
+#define RADIX__H
+
+#include <stdlib.h>
+
+//  Fonctionnement général :
+//  - les enregistrements à trier sont rangés de manière contiguë dans un
+//      tableau ; chacun mesure un multiple de 8 octets et commence par sa clé,
+//      de type uint64_t. Le tableau doit être aligné comme uint64_t ;
+//  - le tri est stable : les enregistrements de même clé conservent leur ordre
+//      relatif ;
+//  - le tri est mené octet de clé par octet de clé, du poids faible au poids
+//      fort. Chaque passe compte les octets puis déplace les enregistrements
+//      vers un tableau auxiliaire de même taille fourni par l'utilisateur ;
+//      les passes dont l'octet est le même pour tous les enregistrements sont
+//      omises. Le comptage et le déplacement sont répartis entre plusieurs
+//      fils d'exécution, chacun chargé d'une tranche contiguë du tableau.
+
+//  RADIX_MIN_SPLIT : nombre minimal d'enregistrements confiés à chaque fil
+//    d'exécution.
+#define RADIX_MIN_SPLIT ((size_t) 1 << 16)
+
+//  radix_sort : trie par clés croissantes les n enregistrements de size octets
+//    du tableau base, à l'aide du tableau auxiliaire tmp de même taille, en
+//    répartissant le travail entre au plus nthreads fils d'exécution, dont le
+//    fil appelant. Le contenu de tmp est ensuite indéterminé. Si un fil ne
+//    peut être créé, sa part est traitée par le fil appelant.
+extern void radix_sort(void *base, void *tmp, size_t n, size_t size,
+    size_t nthreads);
+
+#endif
@@ -0,0 +1,264 @@
+//  reader.c : partie implantation d'un module pour la lecture de fichiers par
+//    un fil d'exécution dédié.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "reader.h"
+
+//  READER__NBUFS, READER__BUFSIZE : nombre et taille des tampons de l'anneau.
+#define READER__NBUFS 4
+#define READER__BUFSIZE (1 << 20)
+
+//  READER__PREFETCH : nombre d'octets du fichier suivant dont le préchargement
+//    est demandé à l'ouverture du fichier courant.
+#define READER__PREFETCH (16 << 20)
+
+//  struct slot : un tampon de l'anneau, la longueur du morceau qu'il contient
+//    et la valeur que doit renvoyer reader_next lorsqu'il est consommé.
+struct slot {
+  char *buf;
+  size_t len;
+  readerret ret;
+};
+
+//  struct reader : les champs names, offsets et n sont ceux passés à
+//    reader_start. Les tampons occupés de l'anneau sont les count tampons qui
+//    suivent, circulairement, celui d'indice head ; celui-ci est détenu par
+//    l'utilisateur si held est vrai. Le fil de lecture remplit les tampons
+//    libres, qui suivent les tampons occupés, sans verrou : seuls les champs
+//    head, count, held, stop et done sont protégés par mutex. Le fil de
+//    lecture signale filled à chaque tampon rempli, l'utilisateur signale
+//    freed à chaque tampon libéré. Le champ stop demande l'interruption de la
+//    lecture, le champ done indique la fin du fil de lecture.
+struct reader {
+  const char * const *names;
+  const off_t *offsets;
+  size_t n;
+  struct slot slots[READER__NBUFS];
+  size_t head;
+  size_t count;
+  bool held;
+  bool stop;
+  bool done;
+  pthread_mutex_t mutex;
+  pthread_cond_t filled;
+  pthread_cond_t freed;
+  pthread_t thread;
+};
+
+//--- Fil de lecture -----------------------------------------------------------
+
+//  reader__acquire : attend qu'un tampon soit libre et renvoie son indice, ou
+//    renvoie READER__NBUFS si l'interruption de la lecture est demandée.
+static size_t reader__acquire(reader *r) {
+  pthread_mutex_lock(&r->mutex);
+  while (r->count == READER__NBUFS && !r->stop) {
+    pthread_cond_wait(&r->freed, &r->mutex);
+  }
+  size_t k = (r->stop ? READER__NBUFS : (r->head + r->count) % READER__NBUFS);
+  pthread_mutex_unlock(&r->mutex);
+  return k;
+}
+
+//  reader__publish : rend disponible à l'utilisateur le tampon d'indice k, de
+//    longueur len et de valeur de retour ret.
+static void reader__publish(reader *r, size_t k, size_t len, readerret ret) {
+  r->slots[k].len = len;
+  r->slots[k].ret = ret;
+  pthread_mutex_lock(&r->mutex);
+  r->count += 1;
+  pthread_cond_signal(&r->filled);
+  pthread_mutex_unlock(&r->mutex);
+}
+
+//  reader__open : ouvre le fichier de nom name, informe le noyau qu'il sera lu
+//    séquentiellement à partir de la position off et demande le préchargement
+//    de ses premiers octets. Renvoie le descripteur obtenu ou une valeur
+//    négative en cas d'échec.
+static int reader__open(const char *name, off_t off) {
+  int fd = open(name, O_RDONLY);
+  if (fd >= 0) {
+    posix_fadvise(fd, off, 0, POSIX_FADV_SEQUENTIAL);
+    posix_fadvise(fd, off, READER__PREFETCH, POSIX_FADV_WILLNEED);
+  }
+  return fd;
+}
+
+//  reader__file : lit le fichier de descripteur fd à partir de la position off
+//    et dépose son contenu dans l'anneau. Renvoie READER_END en cas de succès
+//    ou si l'interruption de la lecture est demandée, la valeur d'erreur
+//    correspondante sinon.
+static readerret reader__file(reader *r, int fd, off_t off) {
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return READER_EREAD;
+  }
+  if (st.st_size < off) {
+    return READER_ESHORT;
+  }
+  if (off != 0 && lseek(fd, off, SEEK_SET) != off) {
+    return READER_EREAD;
+  }
+  while (true) {
+    size_t k = reader__acquire(r);
+    if (k == READER__NBUFS) {
+      return READER_END;
+    }
+    char *buf = r->slots[k].buf;
+    size_t len = 0;
+    ssize_t n = 0;
+    while (len < READER__BUFSIZE
+        && ((n = read(fd, buf + len, READER__BUFSIZE - len)) > 0
+        || (n < 0 && errno == EINTR))) {
+      len += (n > 0 ? (size_t) n : 0);
+    }
+    if (n < 0) {
+      return READER_EREAD;
+    }
+    if (len > 0) {
+      reader__publish(r, k, len, READER_DATA);
+    }
+    if (n == 0) {
+      return READER_END;
+    }
+  }
+}
+
+//  reader__run : fonction du fil de lecture.
+static void *reader__run(void *arg) {
+  reader *r = arg;
+  int fd = -1;
+  for (size_t i = 0; i < r->n; ++i) {
+    off_t off = (r->offsets == NULL ? 0 : r->offsets[i]);
+    readerret ret = READER_EOPEN;
+    if (fd >= 0 || (fd = reader__open(r->names[i], off)) >= 0) {
+      //  Le fichier suivant est ouvert dès maintenant : son préchargement a
+      //    lieu pendant la lecture du fichier courant.
+      int next = -1;
+      if (i + 1 < r->n) {
+        next = reader__open(r->names[i + 1],
+            r->offsets == NULL ? 0 : r->offsets[i + 1]);
+      }
+      ret = reader__file(r, fd, off);
+      close(fd);
+      fd = next;
+    }
+    size_t k = reader__acquire(r);
+    if (k == READER__NBUFS) {
+      break;
+    }
+    reader__publish(r, k, 0, ret);
+    if (ret != READER_END) {
+      break;
+    }
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+  pthread_mutex_lock(&r->mutex);
+  r->done = true;
+  pthread_cond_signal(&r->filled);
+  pthread_mutex_unlock(&r->mutex);
+  return NULL;
+}
+
+//--- Lecteur ------------------------------------------------------------------
+
+reader *reader_start(const char * const *names, const off_t *offsets,
+    size_t n) {
+  reader *r = malloc(sizeof *r);
+  if (r == NULL) {
+    return NULL;
+  }
+  r->names = names;
+  r->offsets = offsets;
+  r->n = n;
+  r->head = 0;
+  r->count = 0;
+  r->held = false;
+  r->stop = false;
+  r->done = false;
+  size_t k = 0;
+  while (k < READER__NBUFS
+      && (r->slots[k].buf = malloc(READER__BUFSIZE)) != NULL) {
+    ++k;
+  }
+  if (k < READER__NBUFS) {
+    goto error_buf;
+  }
+  if (pthread_mutex_init(&r->mutex, NULL) != 0) {
+    goto error_buf;
+  }
+  if (pthread_cond_init(&r->filled, NULL) != 0) {
+    goto error_mutex;
+  }
+  if (pthread_cond_init(&r->freed, NULL) != 0) {
+    goto error_filled;
+  }
+  if (pthread_create(&r->thread, NULL, reader__run, r) != 0) {
+    goto error_freed;
+  }
+  return r;
+error_freed:
+  pthread_cond_destroy(&r->freed);
+error_filled:
+  pthread_cond_destroy(&r->filled);
+error_mutex:
+  pthread_mutex_destroy(&r->mutex);
+error_buf:
+  while (k > 0) {
+    --k;
+    free(r->slots[k].buf);
+  }
+  free(r);
+  return NULL;
+}
+
+void reader_dispose(reader **rptr) {
+  reader *r = *rptr;
+  if (r == NULL) {
+    return;
+  }
+  pthread_mutex_lock(&r->mutex);
+  r->stop = true;
+  pthread_cond_signal(&r->freed);
+  pthread_mutex_unlock(&r->mutex);
+  pthread_join(r->thread, NULL);
+  pthread_cond_destroy(&r->freed);
+  pthread_cond_destroy(&r->filled);
+  pthread_mutex_destroy(&r->mutex);
+  for (size_t k = 0; k < READER__NBUFS; ++k) {
+    free(r->slots[k].buf);
+  }
+  free(r);
+  *rptr = NULL;
+}
+
+readerret reader_next(reader *r, const char **buf, size_t *len) {
+  pthread_mutex_lock(&r->mutex);
+  if (r->held) {
+    r->head = (r->head + 1) % READER__NBUFS;
+    r->count -= 1;
+    r->held = false;
+    pthread_cond_signal(&r->freed);
+  }
+  while (r->count == 0 && !r->done) {
+    pthread_cond_wait(&r->filled, &r->mutex);
+  }
+  if (r->count == 0) {
+    pthread_mutex_unlock(&r->mutex);
+    return READER_END;
+  }
+  const struct slot *s = &r->slots[r->head];
+  r->held = true;
+  pthread_mutex_unlock(&r->mutex);
+  *buf = s->buf;
+  *len = s->len;
+  return s->ret;
+}
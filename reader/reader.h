@@ -0,0 +1,72 @@
+//  reader.h : partie interface d'un module pour la lecture de fichiers par un
+//    fil d'exécution dédié.
+
+#ifndef READER__H
+#define READER__H
+
+#include <stdlib.h>
+#include <sys/types.h>
+
+//  Fonctionnement général :
+//  - un lecteur lit successivement, dans un fil d'exécution qui lui est propre,
+//      une suite de fichiers donnés par leurs noms, chacun à partir d'une
+//      position de départ. Le contenu lu est déposé dans un anneau de tampons
+//      de grande taille que l'utilisateur consomme dans l'ordre, morceau par
+//      morceau, depuis le fil appelant. La lecture se poursuit tant qu'un
+//      tampon est libre : elle a lieu pendant que l'utilisateur traite les
+//      morceaux précédents ;
+//  - le noyau est informé de la lecture séquentielle de chaque fichier, et le
+//      fichier suivant de la suite est ouvert dès l'ouverture du fichier
+//      courant afin que son préchargement commence sans attendre ;
+//  - un morceau reste valide jusqu'à l'appel suivant à reader_next ou à
+//      reader_dispose ;
+//  - les fonctions qui possèdent un paramètre de type « reader * » ou
+//      « reader ** » ont un comportement indéterminé lorsque ce paramètre ou
+//      sa déréférence n'est pas l'adresse d'un contrôleur préalablement
+//      renvoyée avec succès par la fonction reader_start et non révoquée depuis
+//      par la fonction reader_dispose.
+
+//  struct reader, reader : type et nom de type d'un contrôleur regroupant les
+//    informations nécessaires pour gérer un lecteur.
+typedef struct reader reader;
+
+//  readerret : énumération des valeurs renvoyées par reader_next.
+//  - READER_DATA : un morceau du fichier courant est disponible ;
+//  - READER_END : la fin du fichier courant est atteinte, l'appel suivant
+//      concerne le fichier suivant de la suite ;
+//  - READER_EOPEN : le fichier courant ne peut être ouvert ;
+//  - READER_ESHORT : le fichier courant est plus court que sa position de
+//      départ ;
+//  - READER_EREAD : une erreur de lecture est survenue sur le fichier courant.
+//  Après une erreur, le lecteur ne lit plus aucun fichier.
+typedef enum {
+  READER_DATA,
+  READER_END,
+  READER_EOPEN,
+  READER_ESHORT,
+  READER_EREAD,
+} readerret;
+
+//  reader_start : tente d'allouer les ressources nécessaires pour lire les n
+//    fichiers dont les noms figurent dans le tableau names, dans cet ordre, à
+//    partir des positions figurant dans le tableau offsets, ou du début si
+//    offsets vaut NULL, puis démarre la lecture. Les tableaux names et offsets
+//    ainsi que les noms doivent rester valides jusqu'à l'appel à
+//    reader_dispose. Renvoie NULL en cas de dépassement de capacité ou si le
+//    fil d'exécution ne peut être créé. Renvoie sinon un pointeur vers le
+//    contrôleur associé au lecteur.
+extern reader *reader_start(const char * const *names, const off_t *offsets,
+    size_t n);
+
+//  reader_dispose : sans effet si *rptr vaut NULL. Interrompt sinon la lecture,
+//    attend la fin du fil d'exécution, libère les ressources allouées à la
+//    gestion du lecteur associé à *rptr puis affecte NULL à *rptr.
+extern void reader_dispose(reader **rptr);
+
+//  reader_next : libère le morceau précédemment renvoyé par le lecteur associé
+//    à r et attend le suivant. Si la valeur renvoyée est READER_DATA, affecte à
+//    *buf l'adresse du morceau et à *len sa longueur, non nulle. Une fois la
+//    suite de fichiers épuisée ou après une erreur, renvoie READER_END.
+extern readerret reader_next(reader *r, const char **buf, size_t *len);
+
+#endif
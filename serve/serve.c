@@ -0,0 +1,295 @@
+//  serve.c : partie implantation d'un module d'échange de requêtes sur une
+//    prise locale du domaine Unix.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include "serve.h"
+
+//  SERVE__BUFSIZE : taille des lectures effectuées sur une connexion.
+#define SERVE__BUFSIZE 65536
+
+//  SERVE__REQUEST_MAX : longueur maximale, en octets, d'une requête.
+#define SERVE__REQUEST_MAX ((size_t) 1 << 24)
+
+//  serve__control : tampon des données de contrôle d'un message, de taille
+//    suffisante pour SERVE_NFDS descripteurs et correctement aligné.
+union serve__control {
+  struct cmsghdr h;
+  unsigned char buf[CMSG_SPACE(SERVE_NFDS * sizeof(int))];
+};
+
+//  serve__address : affecte à *addr l'adresse de la prise de chemin path.
+//    Renvoie une valeur négative, errno valant ENAMETOOLONG, si le chemin est
+//    trop long, zéro sinon.
+static int serve__address(const char *path, struct sockaddr_un *addr) {
+  size_t len = strlen(path);
+  if (len >= sizeof addr->sun_path) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  memset(addr, 0, sizeof *addr);
+  addr->sun_family = AF_UNIX;
+  memcpy(addr->sun_path, path, len + 1);
+  return 0;
+}
+
+//  serve__write : écrit les n octets de buf sur le descripteur fd. Renvoie zéro
+//    en cas de succès.
+static int serve__write(int fd, const char *buf, size_t n) {
+  while (n > 0) {
+    ssize_t w = write(fd, buf, n);
+    if (w < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    buf += w;
+    n -= (size_t) w;
+  }
+  return 0;
+}
+
+//  serve__stale : renvoie true si et seulement si path désigne une prise à
+//    laquelle aucun serveur n'écoute.
+static bool serve__stale(const char *path, const struct sockaddr_un *addr) {
+  struct stat st;
+  if (lstat(path, &st) != 0 || !S_ISSOCK(st.st_mode)) {
+    return false;
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return false;
+  }
+  bool stale = (connect(fd, (const struct sockaddr *) addr, sizeof *addr) != 0
+      && errno == ECONNREFUSED);
+  close(fd);
+  return stale;
+}
+
+int serve_listen(const char *path) {
+  struct sockaddr_un addr;
+  if (serve__address(path, &addr) != 0) {
+    return -1;
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  if (bind(fd, (const struct sockaddr *) &addr, sizeof addr) != 0) {
+    if (errno != EADDRINUSE || !serve__stale(path, &addr)
+        || unlink(path) != 0
+        || bind(fd, (const struct sockaddr *) &addr, sizeof addr) != 0) {
+      goto error;
+    }
+  }
+  if (listen(fd, SOMAXCONN) != 0) {
+    goto error;
+  }
+  return fd;
+error:;
+  int e = errno;
+  close(fd);
+  errno = e;
+  return -1;
+}
+
+int serve_accept(int fd) {
+  return accept(fd, NULL, NULL);
+}
+
+int serve_connect(const char *path) {
+  struct sockaddr_un addr;
+  if (serve__address(path, &addr) != 0) {
+    return -1;
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  if (connect(fd, (const struct sockaddr *) &addr, sizeof addr) != 0) {
+    int e = errno;
+    close(fd);
+    errno = e;
+    return -1;
+  }
+  return fd;
+}
+
+int serve_send(int fd, size_t n, const char * const *args,
+    const int *fds) {
+  if (n == 0) {
+    errno = EINVAL;
+    return -1;
+  }
+  //  Les descripteurs accompagnent le premier octet de la requête.
+  union serve__control ctl;
+  memset(&ctl, 0, sizeof ctl);
+  struct iovec iov = {
+    .iov_base = (void *) args[0], .iov_len = 1
+  };
+  struct msghdr msg = {
+    .msg_iov = &iov, .msg_iovlen = 1, .msg_control = ctl.buf,
+    .msg_controllen = sizeof ctl.buf
+  };
+  struct cmsghdr *c = CMSG_FIRSTHDR(&msg);
+  c->cmsg_level = SOL_SOCKET;
+  c->cmsg_type = SCM_RIGHTS;
+  c->cmsg_len = CMSG_LEN(SERVE_NFDS * sizeof(int));
+  memcpy(CMSG_DATA(c), fds, SERVE_NFDS * sizeof(int));
+  ssize_t w;
+  do {
+    w = sendmsg(fd, &msg, MSG_NOSIGNAL);
+  } while (w < 0 && errno == EINTR);
+  if (w < 0 || serve__write(fd, args[0] + 1, strlen(args[0])) != 0) {
+    return -1;
+  }
+  for (size_t k = 1; k < n; ++k) {
+    if (serve__write(fd, args[k], strlen(args[k]) + 1) != 0) {
+      return -1;
+    }
+  }
+  return shutdown(fd, SHUT_WR);
+}
+
+//  serve__recv : lit au plus n octets sur la connexion de descripteur fd et
+//    les range dans buf. Si des descripteurs les accompagnent et que *got est
+//    faux, les affecte aux SERVE_NFDS composantes de fds et affecte true à
+//    *got ; les descripteurs en surnombre sont fermés. Renvoie le nombre
+//    d'octets lus, zéro à la fin de ceux-ci, une valeur négative en cas
+//    d'échec.
+static ssize_t serve__recv(int fd, char *buf, size_t n, int *fds, bool *got) {
+  union serve__control ctl;
+  struct iovec iov = {
+    .iov_base = buf, .iov_len = n
+  };
+  struct msghdr msg = {
+    .msg_iov = &iov, .msg_iovlen = 1, .msg_control = ctl.buf,
+    .msg_controllen = sizeof ctl.buf
+  };
+  ssize_t r = recvmsg(fd, &msg, 0);
+  if (r < 0) {
+    return -1;
+  }
+  for (struct cmsghdr *c = CMSG_FIRSTHDR(&msg); c != NULL;
+      c = CMSG_NXTHDR(&msg, c)) {
+    if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS) {
+      continue;
+    }
+    size_t m = (c->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    bool keep = (!*got && m == SERVE_NFDS);
+    for (size_t i = 0; i < m; ++i) {
+      int d;
+      memcpy(&d, CMSG_DATA(c) + i * sizeof d, sizeof d);
+      if (keep) {
+        fds[i] = d;
+      } else {
+        close(d);
+      }
+    }
+    *got = *got || keep;
+  }
+  if ((msg.msg_flags & MSG_CTRUNC) != 0) {
+    errno = EPROTO;
+    return -1;
+  }
+  return r;
+}
+
+int serve_receive(int fd, size_t *n, char ***args, int *fds) {
+  char *buf = NULL;
+  size_t len = 0;
+  size_t cap = 0;
+  bool got = false;
+  while (true) {
+    if (cap - len < SERVE__BUFSIZE) {
+      if (cap >= SERVE__REQUEST_MAX) {
+        errno = EMSGSIZE;
+        goto error;
+      }
+      cap += SERVE__BUFSIZE;
+      char *a = realloc(buf, cap);
+      if (a == NULL) {
+        goto error;
+      }
+      buf = a;
+    }
+    ssize_t r = serve__recv(fd, buf + len, cap - len, fds, &got);
+    if (r < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      goto error;
+    }
+    if (r == 0) {
+      break;
+    }
+    len += (size_t) r;
+  }
+  if (len == 0 || buf[len - 1] != '\0' || !got) {
+    errno = EPROTO;
+    goto error;
+  }
+  size_t count = 0;
+  for (size_t i = 0; i < len; ++i) {
+    count += (buf[i] == '\0');
+  }
+  //  Le tableau est suivi dans le même bloc d'une copie des chaînes reçues.
+  char **a = malloc((count + 1) * sizeof *a + len);
+  if (a == NULL) {
+    goto error;
+  }
+  char *t = (char *) (a + count + 1);
+  memcpy(t, buf, len);
+  for (size_t k = 0; k < count; ++k) {
+    a[k] = t;
+    t += strlen(t) + 1;
+  }
+  a[count] = NULL;
+  free(buf);
+  *n = count;
+  *args = a;
+  return 0;
+error:;
+  int e = errno;
+  free(buf);
+  for (size_t k = 0; got && k < SERVE_NFDS; ++k) {
+    close(fds[k]);
+  }
+  errno = e;
+  return -1;
+}
+
+int serve_reply(int fd, int status) {
+  unsigned char b = (unsigned char) status;
+  ssize_t w;
+  do {
+    w = send(fd, &b, 1, MSG_NOSIGNAL);
+  } while (w < 0 && errno == EINTR);
+  return w == 1 ? 0 : -1;
+}
+
+int serve_status(int fd, int *status) {
+  unsigned char b;
+  ssize_t r;
+  do {
+    r = read(fd, &b, 1);
+  } while (r < 0 && errno == EINTR);
+  if (r < 0) {
+    return -1;
+  }
+  if (r == 0) {
+    errno = EPROTO;
+    return -1;
+  }
+  *status = b;
+  return 0;
+}
@@ -0,0 +1,70 @@
+//  serve.h : partie interface d'un module d'échange de requêtes sur une prise
+//    locale du domaine Unix.
+
+#ifndef SERVE__H
+#define SERVE__H
+
+#include <stdlib.h>
+
+//  SERVE_NFDS : nombre de descripteurs transmis avec une requête.
+#define SERVE_NFDS 3
+
+//  Fonctionnement général :
+//  - un serveur écoute sur une prise désignée par un chemin du système de
+//      fichiers. Un client s'y connecte, envoie sa requête puis ferme sa
+//      connexion en écriture ; la réponse du serveur est le statut de fin du
+//      traitement de la requête, transmis en un octet ;
+//  - une requête est une suite non vide de chaînes de caractères, chacune
+//      transmise suivie de son caractère nul, accompagnée de SERVE_NFDS
+//      descripteurs du client, transmis avec le premier octet : ceux de ses
+//      entrée, sortie et sortie erreur standard, sur lesquels le serveur lit
+//      et écrit directement ;
+//  - les fonctions reprennent les lectures et écritures interrompues par un
+//      signal et renvoient une valeur négative en cas d'échec, errno étant
+//      alors celle de l'appel système en cause.
+
+//  serve_listen : crée une prise d'écoute de chemin path, qui ne doit pas
+//    désigner un fichier existant autre qu'une prise à laquelle aucun serveur
+//    n'écoute plus, laquelle est alors remplacée. Renvoie son descripteur.
+extern int serve_listen(const char *path);
+
+//  serve_accept : attend une connexion d'un client sur la prise d'écoute de
+//    descripteur fd et renvoie le descripteur de la connexion. Renvoie une
+//    valeur négative, errno valant EINTR, si l'attente est interrompue par un
+//    signal.
+extern int serve_accept(int fd);
+
+//  serve_connect : connecte un client au serveur qui écoute sur la prise de
+//    chemin path et renvoie le descripteur de la connexion.
+extern int serve_connect(const char *path);
+
+//  serve_send : envoie sur la connexion de descripteur fd la requête formée
+//    des n chaînes du tableau args, n étant non nul, et des SERVE_NFDS
+//    descripteurs du tableau fds puis ferme la connexion en écriture. Renvoie
+//    zéro en cas de succès.
+extern int serve_send(int fd, size_t n, const char * const *args,
+    const int *fds);
+
+//  serve_receive : lit sur la connexion de descripteur fd une requête complète,
+//    affecte à *args l'adresse d'un tableau de *n + 1 composantes, dont les
+//    *n premières pointent sur ses chaînes et la dernière vaut NULL, et aux
+//    SERVE_NFDS composantes de fds les descripteurs reçus, à fermer par
+//    l'appelant. Le tableau et ses chaînes forment un seul bloc, à libérer
+//    par free. Renvoie zéro en cas de succès, une valeur négative, errno
+//    valant EPROTO si la requête est vide, si la dernière chaîne reçue n'est
+//    pas terminée ou si les descripteurs n'ont pas été reçus.
+extern int serve_receive(int fd, size_t *n, char ***args, int *fds);
+
+//  serve_reply : envoie sur la connexion de descripteur fd le statut status,
+//    compris entre 0 et 255, de fin du traitement de la requête. Une
+//    connexion fermée par le client ne provoque pas l'envoi de SIGPIPE.
+//    Renvoie zéro en cas de succès.
+extern int serve_reply(int fd, int status);
+
+//  serve_status : attend sur la connexion de descripteur fd la réponse à la
+//    requête envoyée et affecte à *status le statut reçu. Renvoie zéro en cas
+//    de succès, une valeur négative, errno valant EPROTO si la connexion est
+//    fermée sans réponse.
+extern int serve_status(int fd, int *status);
+
+#endif
@@ -0,0 +1,88 @@
+#!/bin/sh
+#  check.sh : vérifications du mode serveur de lnid.
+#
+#  Lance un serveur sur des fichiers de référence générés puis, pour chaque
+#    requête, compare la sortie standard, la sortie erreur et le statut de fin
+#    obtenus par lnidc, qui reprend la session d'une référence, à ceux de la
+#    même commande exécutée directement par lnid, qui construit sa table à
+#    partir du plus petit fichier. Vérifie enfin qu'une référence modifiée
+#    depuis son chargement n'est plus reprise.
+
+set -u
+
+LNID=${LNID:-../nbline/lnid}
+LNIDC=${LNIDC:-../nbline/lnidc}
+
+lnid=$(cd "$(dirname "$LNID")" && pwd)/$(basename "$LNID")
+lnidc=$(cd "$(dirname "$LNIDC")" && pwd)/$(basename "$LNIDC")
+tmp=$(mktemp -d)
+pid=
+trap '[ -n "$pid" ] && kill "$pid" 2> /dev/null; rm -rf "$tmp"' EXIT
+cd "$tmp" || exit 1
+
+#  gen fichier lignes modulo graine : écrit dans fichier le nombre de lignes
+#    demandé, chacune tirée parmi modulo lignes distinctes.
+gen() {
+  awk -v n="$2" -v m="$3" -v s="$4" 'BEGIN {
+    srand(s)
+    for (i = 0; i < n; ++i) {
+      printf "line %d\n", int(rand() * rand() * m)
+    }
+  }' > "$1"
+}
+
+gen big 20000 3000 1
+gen small 2000 3000 2
+gen mid 8000 3000 3
+
+"$lnid" --serve="$tmp/sock" big small > /dev/null 2>&1 &
+pid=$!
+n=0
+while [ ! -S "$tmp/sock" ]; do
+  n=$((n + 1))
+  if [ "$n" -gt 100 ] || ! kill -0 "$pid" 2> /dev/null; then
+    echo "*** Check failed: the server did not start" >&2
+    exit 1
+  fi
+  sleep 0.1
+done
+
+fails=0
+
+#  same arguments... : compare la requête lnidc de ces arguments à la
+#    commande lnid correspondante.
+same() {
+  "$lnidc" "$tmp/sock" "$@" > warm.out 2> warm.err
+  ws=$?
+  "$lnid" "$@" > cold.out 2> cold.err
+  cs=$?
+  if [ "$ws" != "$cs" ] || ! cmp -s warm.out cold.out \
+      || ! cmp -s warm.err cold.err; then
+    echo "*** Check failed: $*" >&2
+    fails=$((fails + 1))
+  fi
+}
+
+for opts in "" "-t 5" "-m 3" "-t 10 -m 2" "-O tsv" "-O jsonl" "-O bin" "-u"; do
+  # shellcheck disable=SC2086
+  {
+    same $opts big small
+    same $opts big mid small
+    same $opts small big
+    same $opts small mid
+    same $opts big missing
+  }
+done
+
+#  Une référence modifiée depuis son chargement n'est plus reprise : le
+#    résultat est celui des fichiers modifiés.
+head -n 500 mid >> small
+same small big
+same -O bin small mid
+
+kill "$pid"
+wait "$pid"
+pid=
+if [ "$fails" -ne 0 ]; then
+  exit 1
+fi
@@ -0,0 +1,257 @@
+//  spacesaving.c : partie implantation d'un module pour la recherche approchée
+//    des éléments les plus fréquents d'un flot par l'algorithme Space-Saving.
+
+#include <stdbool.h>
+#include "spacesaving.h"
+
+//  struct counter : un élément surveillé, son empreinte, son compteur, son
+//    erreur, son étiquette et sa position dans le tas.
+struct counter {
+  uint64_t h[2];
+  uint64_t count;
+  uint64_t error;
+  uint64_t tag;
+  uint32_t pos;
+};
+
+//  struct spacesaving : les n éléments surveillés, parmi m au plus, occupent
+//    les n premières cases du tableau counters. Le tableau heap contient leurs
+//    indices et forme un tas minimum selon les compteurs. Le tableau slots est
+//    une table de hachage à adressage ouvert et sondage linéaire, de mask + 1
+//    cases, qui associe à l'empreinte de chaque élément surveillé son indice
+//    plus 1 ; une case libre contient zéro. Le champ total est la longueur du
+//    flot.
+struct spacesaving {
+  size_t m;
+  size_t n;
+  uint64_t total;
+  struct counter *counters;
+  uint32_t *heap;
+  uint32_t *slots;
+  size_t mask;
+};
+
+//  spacesaving__nslots : renvoie le nombre de cases de la table de hachage
+//    d'un résumé surveillant m éléments, la plus petite puissance de 2 au moins
+//    égale à 2m, ou zéro en cas de dépassement de capacité.
+static size_t spacesaving__nslots(size_t m) {
+  size_t k = 1;
+  while (k < 2 * m) {
+    if (k > SIZE_MAX / 2 / sizeof(uint32_t)) {
+      return 0;
+    }
+    k *= 2;
+  }
+  return k;
+}
+
+//  spacesaving__size : renvoie la taille d'un résumé surveillant m éléments,
+//    SIZE_MAX en cas de dépassement de capacité.
+static size_t spacesaving__size(size_t m) {
+  size_t k = spacesaving__nslots(m);
+  if (k == 0
+      || m > (SIZE_MAX - k * sizeof(uint32_t) - sizeof(struct spacesaving))
+      / (sizeof(struct counter) + sizeof(uint32_t))) {
+    return SIZE_MAX;
+  }
+  return sizeof(struct spacesaving) + k * sizeof(uint32_t)
+    + m * (sizeof(struct counter) + sizeof(uint32_t));
+}
+
+size_t spacesaving_counters(size_t bytes) {
+  size_t lo = 0;
+  size_t hi = bytes / (sizeof(struct counter) + sizeof(uint32_t));
+  if (hi > UINT32_MAX) {
+    hi = UINT32_MAX;
+  }
+  while (lo < hi) {
+    size_t mid = hi - (hi - lo) / 2;
+    if (spacesaving__size(mid) <= bytes) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return lo;
+}
+
+spacesaving *spacesaving_empty(size_t m) {
+  size_t k = spacesaving__nslots(m);
+  if (m == 0 || m > UINT32_MAX || k == 0) {
+    return NULL;
+  }
+  spacesaving *s = malloc(sizeof *s);
+  if (s == NULL) {
+    return NULL;
+  }
+  s->counters = malloc(m * sizeof *s->counters);
+  s->heap = malloc(m * sizeof *s->heap);
+  s->slots = calloc(k, sizeof *s->slots);
+  if (s->counters == NULL || s->heap == NULL || s->slots == NULL) {
+    free(s->counters);
+    free(s->heap);
+    free(s->slots);
+    free(s);
+    return NULL;
+  }
+  s->m = m;
+  s->n = 0;
+  s->total = 0;
+  s->mask = k - 1;
+  return s;
+}
+
+void spacesaving_dispose(spacesaving **sptr) {
+  if (*sptr == NULL) {
+    return;
+  }
+  free((*sptr)->counters);
+  free((*sptr)->heap);
+  free((*sptr)->slots);
+  free(*sptr);
+  *sptr = NULL;
+}
+
+//--- Table de hachage ---------------------------------------------------------
+
+#define HOME(s, h) ((size_t) (h)[0] & (s)->mask)
+
+//  spacesaving__find : renvoie l'indice de la case de la table de s qui
+//    contient l'élément d'empreinte h ou, à défaut, de la case libre où il
+//    serait ajouté.
+static size_t spacesaving__find(const spacesaving *s, const uint64_t h[2]) {
+  size_t i = HOME(s, h);
+  while (s->slots[i] != 0) {
+    const struct counter *c = &s->counters[s->slots[i] - 1];
+    if (c->h[0] == h[0] && c->h[1] == h[1]) {
+      break;
+    }
+    i = (i + 1) & s->mask;
+  }
+  return i;
+}
+
+//  spacesaving__erase : libère la case d'indice i de la table de s en
+//    décalant vers elle les éléments suivants qui le peuvent, de sorte que la
+//    table ne contienne aucune case marquée comme supprimée.
+static void spacesaving__erase(spacesaving *s, size_t i) {
+  size_t j = i;
+  while (true) {
+    j = (j + 1) & s->mask;
+    if (s->slots[j] == 0) {
+      break;
+    }
+    size_t k = HOME(s, s->counters[s->slots[j] - 1].h);
+    //  L'élément de la case j peut être décalé en i si sa case de départ k
+    //    n'est pas comprise, circulairement, dans l'intervalle ]i, j].
+    if ((i <= j) ? (k <= i || k > j) : (k <= i && k > j)) {
+      s->slots[i] = s->slots[j];
+      i = j;
+    }
+  }
+  s->slots[i] = 0;
+}
+
+//--- Tas ----------------------------------------------------------------------
+
+#define COUNT(s, k) ((s)->counters[(s)->heap[k]].count)
+
+static void spacesaving__swap(spacesaving *s, size_t a, size_t b) {
+  uint32_t t = s->heap[a];
+  s->heap[a] = s->heap[b];
+  s->heap[b] = t;
+  s->counters[s->heap[a]].pos = (uint32_t) a;
+  s->counters[s->heap[b]].pos = (uint32_t) b;
+}
+
+static void spacesaving__up(spacesaving *s, size_t k) {
+  while (k > 0 && COUNT(s, k) < COUNT(s, (k - 1) / 2)) {
+    spacesaving__swap(s, k, (k - 1) / 2);
+    k = (k - 1) / 2;
+  }
+}
+
+//  spacesaving__down : rétablit la propriété de tas des n premières cases du
+//    tas de s à partir de la case k.
+static void spacesaving__down(spacesaving *s, size_t k, size_t n) {
+  while (2 * k + 1 < n) {
+    size_t c = 2 * k + 1;
+    if (c + 1 < n && COUNT(s, c + 1) < COUNT(s, c)) {
+      ++c;
+    }
+    if (COUNT(s, c) >= COUNT(s, k)) {
+      break;
+    }
+    spacesaving__swap(s, k, c);
+    k = c;
+  }
+}
+
+//--- Résumé -------------------------------------------------------------------
+
+void spacesaving_add(spacesaving *s, const uint64_t h[2], uint64_t tag) {
+  s->total += 1;
+  size_t i = spacesaving__find(s, h);
+  if (s->slots[i] != 0) {
+    struct counter *c = &s->counters[s->slots[i] - 1];
+    c->count += 1;
+    spacesaving__down(s, c->pos, s->n);
+    return;
+  }
+  if (s->n < s->m) {
+    struct counter *c = &s->counters[s->n];
+    *c = (struct counter) {
+      .h = { h[0], h[1] }, .count = 1, .error = 0, .tag = tag,
+      .pos = (uint32_t) s->n
+    };
+    s->heap[s->n] = (uint32_t) s->n;
+    s->slots[i] = (uint32_t) s->n + 1;
+    s->n += 1;
+    spacesaving__up(s, s->n - 1);
+    return;
+  }
+  uint32_t k = s->heap[0];
+  struct counter *c = &s->counters[k];
+  spacesaving__erase(s, spacesaving__find(s, c->h));
+  c->h[0] = h[0];
+  c->h[1] = h[1];
+  c->error = c->count;
+  c->count += 1;
+  c->tag = tag;
+  s->slots[spacesaving__find(s, h)] = k + 1;
+  spacesaving__down(s, 0, s->n);
+}
+
+size_t spacesaving_capacity(const spacesaving *s) {
+  return s->m;
+}
+
+uint64_t spacesaving_total(const spacesaving *s) {
+  return s->total;
+}
+
+size_t spacesaving_length(const spacesaving *s) {
+  return s->n;
+}
+
+void spacesaving_sort(spacesaving *s) {
+  //  Tri par tas : le plus petit compteur est placé à la fin, puis le suivant,
+  //    etc. Le tableau obtenu, par compteurs décroissants, est ensuite
+  //    retourné : par compteurs croissants, il forme encore un tas minimum et
+  //    le rang i correspond à la case n - 1 - i.
+  for (size_t n = s->n; n > 1; --n) {
+    spacesaving__swap(s, 0, n - 1);
+    spacesaving__down(s, 0, n - 1);
+  }
+  for (size_t a = 0, b = s->n; a + 1 < b; ++a, --b) {
+    spacesaving__swap(s, a, b - 1);
+  }
+}
+
+uint64_t spacesaving_get(const spacesaving *s, size_t i,
+    uint64_t *count, uint64_t *error) {
+  const struct counter *c = &s->counters[s->heap[s->n - 1 - i]];
+  *count = c->count;
+  *error = c->error;
+  return c->tag;
+}
@@ -0,0 +1,80 @@
+//  spacesaving.h : partie interface d'un module pour la recherche approchée
+//    des éléments les plus fréquents d'un flot par l'algorithme Space-Saving.
+
+#ifndef SPACESAVING__H
+#define SPACESAVING__H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+//  Fonctionnement général :
+//  - la structure de données ne stocke pas d'objets mais, pour chacun des
+//      éléments du flot qu'elle surveille, une empreinte de 128 bits fournie
+//      par l'utilisateur, une étiquette de 64 bits, elle aussi fournie par
+//      l'utilisateur, et deux compteurs. Les empreintes sont supposées
+//      distinguer les éléments : deux éléments de même empreinte sont
+//      confondus ;
+//  - le nombre m d'éléments surveillés est fixé à la création : la taille de
+//      la structure ne dépend que de m, et non de la longueur du flot ni du
+//      nombre d'éléments distincts qu'il contient ;
+//  - un élément du flot qui n'est pas surveillé prend la place de l'élément
+//      surveillé de plus petit compteur, dont il hérite du compteur, plus 1,
+//      et prend l'étiquette. Le compteur d'un élément surveillé majore donc
+//      son nombre d'occurrences, d'au plus son erreur, elle-même majorée par
+//      la longueur du flot divisée par m. Tout élément dont le nombre
+//      d'occurrences dépasse cette borne est surveillé ;
+//  - l'ajout d'un élément se fait en temps logarithmique en m ;
+//  - les fonctions qui possèdent un paramètre de type « spacesaving * » ou
+//      « spacesaving ** » ont un comportement indéterminé lorsque ce paramètre
+//      ou sa déréférence n'est pas l'adresse d'un contrôleur préalablement
+//      renvoyée avec succès par la fonction spacesaving_empty et non révoquée
+//      depuis par la fonction spacesaving_dispose.
+
+//  struct spacesaving, spacesaving : type et nom de type d'un contrôleur
+//    regroupant les informations nécessaires pour gérer un résumé de flot.
+typedef struct spacesaving spacesaving;
+
+//  spacesaving_counters : renvoie le plus grand nombre d'éléments surveillés
+//    d'un résumé dont la taille ne dépasse pas bytes octets, zéro si aucun.
+extern size_t spacesaving_counters(size_t bytes);
+
+//  spacesaving_empty : tente d'allouer les ressources nécessaires pour gérer
+//    un nouveau résumé initialement vide surveillant au plus m éléments, m
+//    étant non nul et au plus égal à UINT32_MAX. Renvoie NULL en cas de
+//    dépassement de capacité. Renvoie sinon un pointeur vers le contrôleur
+//    associé au résumé.
+extern spacesaving *spacesaving_empty(size_t m);
+
+//  spacesaving_dispose : sans effet si *sptr vaut NULL. Libère sinon les
+//    ressources allouées à la gestion du résumé associé à *sptr puis affecte
+//    NULL à *sptr.
+extern void spacesaving_dispose(spacesaving **sptr);
+
+//  spacesaving_add : ajoute au flot résumé par s l'élément d'empreinte h et
+//    d'étiquette tag. L'étiquette n'est mémorisée que si l'élément n'était pas
+//    surveillé.
+extern void spacesaving_add(spacesaving *s, const uint64_t h[2], uint64_t tag);
+
+//  spacesaving_capacity : renvoie le nombre maximal d'éléments surveillés par
+//    s.
+extern size_t spacesaving_capacity(const spacesaving *s);
+
+//  spacesaving_total : renvoie la longueur du flot résumé par s.
+extern uint64_t spacesaving_total(const spacesaving *s);
+
+//  spacesaving_length : renvoie le nombre d'éléments surveillés par s.
+extern size_t spacesaving_length(const spacesaving *s);
+
+//  spacesaving_sort : range les éléments surveillés par s par compteurs
+//    décroissants, sans allocation. Le rangement est défait par l'ajout
+//    suivant.
+extern void spacesaving_sort(spacesaving *s);
+
+//  spacesaving_get : renvoie l'étiquette de l'élément de rang i, inférieur à
+//    spacesaving_length(s), dans le rangement effectué par le dernier appel à
+//    spacesaving_sort, et affecte à *count son compteur et à *error son
+//    erreur.
+extern uint64_t spacesaving_get(const spacesaving *s, size_t i,
+    uint64_t *count, uint64_t *error);
+
+#endif
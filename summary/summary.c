@@ -0,0 +1,80 @@
+//  summary.c : partie implantation d'un module de dénombrement des lignes, des
+//    lignes distinctes et des doublons des fichiers d'une session du module
+//    lnid.
+
+#include <stdint.h>
+#include <inttypes.h>
+#include "summary.h"
+#include "lnid.h"
+#include "hll.h"
+#include "fpset.h"
+
+//  Précision de l'estimateur : 2^12 registres d'un octet, pour une erreur
+//    relative type de 1,6 %.
+#define SUMMARY__PRECISION 12
+
+//  Le champ nlines compte les lignes du fichier en cours de traitement, dont
+//    les lignes distinctes sont comptées par l'estimateur hl ou, pour un
+//    dénombrement exact, par l'ensemble d'empreintes fs, l'autre valant NULL.
+struct summary {
+  uint64_t nlines;
+  hll *hl;
+  fpset *fs;
+};
+
+summary *summary_empty(bool exact) {
+  summary *sm = malloc(sizeof *sm);
+  if (sm == NULL) {
+    return NULL;
+  }
+  *sm = (struct summary) {
+    .nlines = 0, .hl = NULL, .fs = NULL
+  };
+  if (exact ? (sm->fs = fpset_empty()) == NULL
+      : (sm->hl = hll_empty(SUMMARY__PRECISION)) == NULL) {
+    free(sm);
+    return NULL;
+  }
+  return sm;
+}
+
+void summary_dispose(summary **sptr) {
+  if (*sptr == NULL) {
+    return;
+  }
+  hll_dispose(&(*sptr)->hl);
+  fpset_dispose(&(*sptr)->fs);
+  free(*sptr);
+  *sptr = NULL;
+}
+
+int summary_line(summary *sm, size_t p, const char *t, size_t len,
+    int nbline, off_t off) {
+  (void) p;
+  (void) nbline;
+  (void) off;
+  uint64_t h = lnid_hash64(t, len, 0);
+  ++sm->nlines;
+  if (sm->fs != NULL) {
+    return fpset_add(sm->fs, h) < 0 ? -1 : 0;
+  }
+  hll_add(sm->hl, h);
+  return 0;
+}
+
+int summary_report(summary *sm, const char *name, FILE *stream) {
+  uint64_t n = sm->nlines;
+  uint64_t d;
+  if (sm->fs != NULL) {
+    d = fpset_count(sm->fs);
+    fpset_clear(sm->fs);
+  } else {
+    //  L'estimation peut dépasser d'autant le nombre de lignes.
+    d = hll_estimate(sm->hl);
+    d = (d > n ? n : d);
+    hll_clear(sm->hl);
+  }
+  sm->nlines = 0;
+  return fprintf(stream, "%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%.4f\t%s\n",
+      n, d, n - d, n == 0 ? 0.0 : (double) (n - d) / (double) n, name) < 0;
+}
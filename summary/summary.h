@@ -0,0 +1,54 @@
+//  summary.h : partie interface d'un module de dénombrement des lignes, des
+//    lignes distinctes et des doublons des fichiers d'une session du module
+//    lnid.
+
+#ifndef SUMMARY__H
+#define SUMMARY__H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+//  Fonctionnement général :
+//  - aucune table n'est construite : les lignes d'un fichier sont passées par
+//      summary_line, confiée à la session à l'aide de lnid_lines, qui compte
+//      les lignes et ajoute leurs valeurs de hachage sur 64 bits à un
+//      estimateur du module hll ou, pour un dénombrement exact, aux
+//      collisions près, à un ensemble d'empreintes du module fpset ;
+//  - summary_report écrit le bilan du fichier qui vient d'être traité puis
+//      vide les compteurs en vue du fichier suivant ;
+//  - les fonctions qui possèdent un paramètre de type « summary * » ont un
+//      comportement indéterminé lorsque ce paramètre n'est pas l'adresse d'un
+//      contrôleur préalablement renvoyé par summary_empty et non encore
+//      libéré.
+
+//  struct summary, summary : type et nom de type d'un contrôleur regroupant
+//    les informations nécessaires pour dénombrer les lignes d'un fichier.
+typedef struct summary summary;
+
+//  summary_empty : tente d'allouer les ressources nécessaires pour dénombrer
+//    les lignes d'un fichier, de manière exacte si exact vaut true, estimée
+//    sinon. Renvoie NULL en cas de dépassement de capacité. Renvoie sinon un
+//    pointeur vers le contrôleur associé.
+extern summary *summary_empty(bool exact);
+
+//  summary_dispose : sans effet si *sptr vaut NULL. Libère sinon les
+//    ressources allouées à la gestion du contrôleur associé à *sptr puis
+//    affecte NULL à *sptr.
+extern void summary_dispose(summary **sptr);
+
+//  summary_line : compte la ligne t de longueur len. Fonction à passer à
+//    lnid_lines. Renvoie zéro en cas de succès, une valeur négative en cas de
+//    dépassement de capacité.
+extern int summary_line(summary *sm, size_t p, const char *t, size_t len,
+    int nbline, off_t off);
+
+//  summary_report : écrit sur le flot stream le nombre de lignes, le nombre de
+//    lignes distinctes, le nombre de doublons, le taux de doublons et le nom
+//    name du fichier dont les lignes viennent d'être comptées, séparés par une
+//    tabulation, puis vide les compteurs du contrôleur associé à sm. Renvoie
+//    zéro en cas de succès, une valeur non nulle en cas d'erreur d'écriture.
+extern int summary_report(summary *sm, const char *name, FILE *stream);
+
+#endif
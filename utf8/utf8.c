@@ -0,0 +1,516 @@
+//  utf8.c : partie implantation d'un module de traitement des chaînes codées
+//    en UTF-8 : repérage des suites de caractères ASCII, décodage et codage
+//    des caractères, passage en majuscules et classes de caractères.
+
+#include <string.h>
+#include "utf8.h"
+
+#if defined __SSE2__
+#include <emmintrin.h>
+#endif
+
+//  Les classes des caractères ASCII sont lues dans la table ascii, dont
+//    chaque composante a pour bit de rang cls celui de l'appartenance à la
+//    classe cls. Les correspondances de casse des autres caractères sont
+//    décrites par les intervalles de la table upper, triée : les codes de lo
+//    à hi espacés de step ont pour majuscules les codes décalés de delta. Les
+//    autres tables, triées, sont des intervalles de codes.
+
+//  Dans une suite ASCII, une minuscule est un octet de 0x61 à 0x7A. Par mots
+//    de 8 octets, tous inférieurs à 0x80, l'ajout de 0x1F puis de 0x05 à
+//    chaque octet ne propage aucune retenue et positionne son bit de poids
+//    fort si et seulement s'il est au moins égal à 0x61 puis à 0x7B.
+
+#define UTF8__BLOCK 16
+#define UTF8__ONES 0x0101010101010101ULL
+#define UTF8__HIGHS 0x8080808080808080ULL
+
+static const uint16_t ascii[0x80] = {
+  0x0011, 0x0011, 0x0011, 0x0011, 0x0011, 0x0011, 0x0011, 0x0011,
+  0x0011, 0x0419, 0x0411, 0x0411, 0x0411, 0x0411, 0x0011, 0x0011,
+  0x0011, 0x0011, 0x0011, 0x0011, 0x0011, 0x0011, 0x0011, 0x0011,
+  0x0011, 0x0011, 0x0011, 0x0011, 0x0011, 0x0011, 0x0011, 0x0011,
+  0x0509, 0x0341, 0x0341, 0x0341, 0x0341, 0x0341, 0x0341, 0x0341,
+  0x0341, 0x0341, 0x0341, 0x0341, 0x0341, 0x0341, 0x0341, 0x0341,
+  0x1163, 0x1163, 0x1163, 0x1163, 0x1163, 0x1163, 0x1163, 0x1163,
+  0x1163, 0x1163, 0x0341, 0x0341, 0x0341, 0x0341, 0x0341, 0x0341,
+  0x0341, 0x1947, 0x1947, 0x1947, 0x1947, 0x1947, 0x1947, 0x0947,
+  0x0947, 0x0947, 0x0947, 0x0947, 0x0947, 0x0947, 0x0947, 0x0947,
+  0x0947, 0x0947, 0x0947, 0x0947, 0x0947, 0x0947, 0x0947, 0x0947,
+  0x0947, 0x0947, 0x0947, 0x0341, 0x0341, 0x0341, 0x0341, 0x0341,
+  0x0341, 0x11C7, 0x11C7, 0x11C7, 0x11C7, 0x11C7, 0x11C7, 0x01C7,
+  0x01C7, 0x01C7, 0x01C7, 0x01C7, 0x01C7, 0x01C7, 0x01C7, 0x01C7,
+  0x01C7, 0x01C7, 0x01C7, 0x01C7, 0x01C7, 0x01C7, 0x01C7, 0x01C7,
+  0x01C7, 0x01C7, 0x01C7, 0x0341, 0x0341, 0x0341, 0x0341, 0x0011,
+};
+
+struct casemap {
+  uint32_t lo;
+  uint32_t hi;
+  int32_t delta;
+  uint32_t step;
+};
+
+static const struct casemap upper[] = {
+  { 0x0061, 0x007A, -32, 1 },
+  { 0x00B5, 0x00B5, 743, 1 },
+  { 0x00E0, 0x00F6, -32, 1 },
+  { 0x00F8, 0x00FE, -32, 1 },
+  { 0x00FF, 0x00FF, 121, 1 },
+  { 0x0101, 0x012F, -1, 2 },
+  { 0x0131, 0x0131, -232, 1 },
+  { 0x0133, 0x0137, -1, 2 },
+  { 0x013A, 0x0148, -1, 2 },
+  { 0x014B, 0x0177, -1, 2 },
+  { 0x017A, 0x017E, -1, 2 },
+  { 0x017F, 0x017F, -300, 1 },
+  { 0x0180, 0x0180, 195, 1 },
+  { 0x0183, 0x0185, -1, 2 },
+  { 0x0188, 0x0188, -1, 1 },
+  { 0x018C, 0x018C, -1, 1 },
+  { 0x0192, 0x0192, -1, 1 },
+  { 0x0195, 0x0195, 97, 1 },
+  { 0x0199, 0x0199, -1, 1 },
+  { 0x019A, 0x019A, 163, 1 },
+  { 0x019E, 0x019E, 130, 1 },
+  { 0x01A1, 0x01A5, -1, 2 },
+  { 0x01A8, 0x01A8, -1, 1 },
+  { 0x01AD, 0x01AD, -1, 1 },
+  { 0x01B0, 0x01B0, -1, 1 },
+  { 0x01B4, 0x01B6, -1, 2 },
+  { 0x01B9, 0x01B9, -1, 1 },
+  { 0x01BD, 0x01BD, -1, 1 },
+  { 0x01BF, 0x01BF, 56, 1 },
+  { 0x01C5, 0x01C5, -1, 1 },
+  { 0x01C6, 0x01C6, -2, 1 },
+  { 0x01C8, 0x01C8, -1, 1 },
+  { 0x01C9, 0x01C9, -2, 1 },
+  { 0x01CB, 0x01CB, -1, 1 },
+  { 0x01CC, 0x01CC, -2, 1 },
+  { 0x01CE, 0x01DC, -1, 2 },
+  { 0x01DD, 0x01DD, -79, 1 },
+  { 0x01DF, 0x01EF, -1, 2 },
+  { 0x01F2, 0x01F2, -1, 1 },
+  { 0x01F3, 0x01F3, -2, 1 },
+  { 0x01F5, 0x01F5, -1, 1 },
+  { 0x01F9, 0x021F, -1, 2 },
+  { 0x0223, 0x0233, -1, 2 },
+  { 0x023C, 0x023C, -1, 1 },
+  { 0x0242, 0x0242, -1, 1 },
+  { 0x0247, 0x024F, -1, 2 },
+  { 0x0253, 0x0253, -210, 1 },
+  { 0x0254, 0x0254, -206, 1 },
+  { 0x0256, 0x0257, -205, 1 },
+  { 0x0259, 0x0259, -202, 1 },
+  { 0x025B, 0x025B, -203, 1 },
+  { 0x0260, 0x0260, -205, 1 },
+  { 0x0263, 0x0263, -207, 1 },
+  { 0x0268, 0x0268, -209, 1 },
+  { 0x0269, 0x0269, -211, 1 },
+  { 0x026F, 0x026F, -211, 1 },
+  { 0x0272, 0x0272, -213, 1 },
+  { 0x0275, 0x0275, -214, 1 },
+  { 0x0280, 0x0280, -218, 1 },
+  { 0x0283, 0x0283, -218, 1 },
+  { 0x0288, 0x0288, -218, 1 },
+  { 0x0289, 0x0289, -69, 1 },
+  { 0x028A, 0x028B, -217, 1 },
+  { 0x028C, 0x028C, -71, 1 },
+  { 0x0292, 0x0292, -219, 1 },
+  { 0x0371, 0x0373, -1, 2 },
+  { 0x0377, 0x0377, -1, 1 },
+  { 0x037B, 0x037D, 130, 1 },
+  { 0x03AC, 0x03AC, -38, 1 },
+  { 0x03AD, 0x03AF, -37, 1 },
+  { 0x03B1, 0x03C1, -32, 1 },
+  { 0x03C2, 0x03C2, -31, 1 },
+  { 0x03C3, 0x03CB, -32, 1 },
+  { 0x03CC, 0x03CC, -64, 1 },
+  { 0x03CD, 0x03CE, -63, 1 },
+  { 0x03D0, 0x03D0, -62, 1 },
+  { 0x03D1, 0x03D1, -57, 1 },
+  { 0x03D5, 0x03D5, -47, 1 },
+  { 0x03D6, 0x03D6, -54, 1 },
+  { 0x03D7, 0x03D7, -8, 1 },
+  { 0x03D9, 0x03EF, -1, 2 },
+  { 0x03F0, 0x03F0, -86, 1 },
+  { 0x03F1, 0x03F1, -80, 1 },
+  { 0x03F2, 0x03F2, 7, 1 },
+  { 0x03F3, 0x03F3, -116, 1 },
+  { 0x03F5, 0x03F5, -96, 1 },
+  { 0x03F8, 0x03F8, -1, 1 },
+  { 0x03FB, 0x03FB, -1, 1 },
+  { 0x0430, 0x044F, -32, 1 },
+  { 0x0450, 0x045F, -80, 1 },
+  { 0x0461, 0x0481, -1, 2 },
+  { 0x048B, 0x04BF, -1, 2 },
+  { 0x04C2, 0x04CE, -1, 2 },
+  { 0x04CF, 0x04CF, -15, 1 },
+  { 0x04D1, 0x052F, -1, 2 },
+  { 0x0561, 0x0586, -48, 1 },
+  { 0x1E01, 0x1E95, -1, 2 },
+  { 0x1E9B, 0x1E9B, -59, 1 },
+  { 0x1EA1, 0x1EFF, -1, 2 },
+  { 0x1F00, 0x1F07, 8, 1 },
+  { 0x1F10, 0x1F15, 8, 1 },
+  { 0x1F20, 0x1F27, 8, 1 },
+  { 0x1F30, 0x1F37, 8, 1 },
+  { 0x1F40, 0x1F45, 8, 1 },
+  { 0x1F51, 0x1F57, 8, 2 },
+  { 0x1F60, 0x1F67, 8, 1 },
+  { 0x1F70, 0x1F71, 74, 1 },
+  { 0x1F72, 0x1F75, 86, 1 },
+  { 0x1F76, 0x1F77, 100, 1 },
+  { 0x1F78, 0x1F79, 128, 1 },
+  { 0x1F7A, 0x1F7B, 112, 1 },
+  { 0x1F7C, 0x1F7D, 126, 1 },
+  { 0x1FB0, 0x1FB1, 8, 1 },
+  { 0x1FBE, 0x1FBE, -7205, 1 },
+  { 0x1FD0, 0x1FD1, 8, 1 },
+  { 0x1FE0, 0x1FE1, 8, 1 },
+  { 0x1FE5, 0x1FE5, 7, 1 },
+  { 0x2170, 0x217F, -16, 1 },
+  { 0x24D0, 0x24E9, -26, 1 },
+  { 0xFF41, 0xFF5A, -32, 1 },
+};
+
+struct range {
+  uint32_t lo;
+  uint32_t hi;
+};
+
+//  letters : lettres, avec ou sans casse, des principaux blocs.
+static const struct range letters[] = {
+  { 0x00AA, 0x00AA }, { 0x00B5, 0x00B5 }, { 0x00BA, 0x00BA },
+  { 0x00C0, 0x00D6 }, { 0x00D8, 0x00F6 }, { 0x00F8, 0x02AF },
+  { 0x0370, 0x0373 }, { 0x0376, 0x0377 }, { 0x037B, 0x037D },
+  { 0x037F, 0x037F }, { 0x0386, 0x0386 }, { 0x0388, 0x038A },
+  { 0x038C, 0x038C }, { 0x038E, 0x03A1 }, { 0x03A3, 0x03F5 },
+  { 0x03F7, 0x0481 }, { 0x048A, 0x052F }, { 0x0531, 0x0556 },
+  { 0x0560, 0x0588 }, { 0x05D0, 0x05EA }, { 0x0620, 0x064A },
+  { 0x0671, 0x06D3 }, { 0x0904, 0x0939 }, { 0x0E01, 0x0E30 },
+  { 0x10A0, 0x10C5 }, { 0x10D0, 0x10FA }, { 0x10FC, 0x11FF },
+  { 0x1E00, 0x1EFF }, { 0x3041, 0x3096 }, { 0x30A1, 0x30FA },
+  { 0x3400, 0x4DBF }, { 0x4E00, 0x9FFF }, { 0xAC00, 0xD7A3 },
+  { 0xFF21, 0xFF3A }, { 0xFF41, 0xFF5A }, { 0x20000, 0x2A6DF },
+};
+
+//  lowers : minuscules sans majuscule associée.
+static const struct range lowers[] = {
+  { 0x00DF, 0x00DF }, { 0x0138, 0x0138 }, { 0x0149, 0x0149 },
+  { 0x0250, 0x02AF },
+};
+
+//  digits : premiers chiffres, zéros, des suites de chiffres décimaux.
+static const uint32_t digits[] = {
+  0x0660, 0x06F0, 0x07C0, 0x0966, 0x09E6, 0x0A66, 0x0AE6, 0x0B66, 0x0BE6,
+  0x0C66, 0x0CE6, 0x0D66, 0x0E50, 0x0ED0, 0x0F20, 0x1040, 0x17E0, 0x1810,
+  0xFF10,
+};
+
+//  blanks, lines : espaces au sein d'une ligne et séparateurs de lignes.
+static const struct range blanks[] = {
+  { 0x00A0, 0x00A0 }, { 0x1680, 0x1680 }, { 0x2000, 0x200A },
+  { 0x202F, 0x202F }, { 0x205F, 0x205F }, { 0x3000, 0x3000 },
+};
+
+static const struct range lines[] = {
+  { 0x0085, 0x0085 }, { 0x2028, 0x2029 },
+};
+
+#define UTF8__LENGTH(a) (sizeof (a) / sizeof *(a))
+
+//  classnames : noms des classes, voir utf8_classname.
+static const char *classnames[] = {
+  [UTF8_ANY] = NULL, [UTF8_ALNUM] = "isalnum", [UTF8_ALPHA] = "isalpha",
+  [UTF8_BLANK] = "isblank", [UTF8_CNTRL] = "iscntrl",
+  [UTF8_DIGIT] = "isdigit", [UTF8_GRAPH] = "isgraph",
+  [UTF8_LOWER] = "islower", [UTF8_PRINT] = "isprint",
+  [UTF8_PUNCT] = "ispunct", [UTF8_SPACE] = "isspace",
+  [UTF8_UPPER] = "isupper", [UTF8_XDIGIT] = "isxdigit",
+};
+
+const char *utf8_classname(utf8class cls) {
+  return classnames[cls];
+}
+
+bool utf8_classbyname(const char *name, utf8class *cls) {
+  for (size_t k = 0; k < UTF8__LENGTH(classnames); ++k) {
+    if (classnames[k] != NULL && strcmp(classnames[k], name) == 0) {
+      *cls = (utf8class) k;
+      return true;
+    }
+  }
+  return false;
+}
+
+//  utf8__in : renvoie true si et seulement si cp appartient à l'un des n
+//    intervalles triés de r.
+static bool utf8__in(const struct range *r, size_t n, uint32_t cp) {
+  size_t lo = 0;
+  size_t hi = n;
+  while (lo < hi) {
+    size_t m = lo + (hi - lo) / 2;
+    if (cp < r[m].lo) {
+      hi = m;
+    } else if (cp > r[m].hi) {
+      lo = m + 1;
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t utf8_ascii(const char *s, size_t n) {
+  size_t i = 0;
+#if defined __SSE2__
+  for (; n - i >= UTF8__BLOCK; i += UTF8__BLOCK) {
+    int m = _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) (s + i)));
+    if (m != 0) {
+      return i + (size_t) __builtin_ctz((unsigned) m);
+    }
+  }
+#else
+  for (; n - i >= sizeof(uint64_t); i += sizeof(uint64_t)) {
+    uint64_t w;
+    memcpy(&w, s + i, sizeof w);
+    if ((w & UTF8__HIGHS) != 0) {
+      break;
+    }
+  }
+#endif
+  while (i < n && (unsigned char) s[i] < 0x80) {
+    ++i;
+  }
+  return i;
+}
+
+size_t utf8_decode(const char *s, size_t n, uint32_t *cp) {
+  const unsigned char *u = (const unsigned char *) s;
+  uint32_t c = u[0];
+  size_t len;
+  uint32_t min;
+  if (c < 0x80) {
+    *cp = c;
+    return 1;
+  }
+  if (c >= 0xC2 && c <= 0xDF) {
+    len = 2;
+    c &= 0x1F;
+    min = 0x80;
+  } else if (c >= 0xE0 && c <= 0xEF) {
+    len = 3;
+    c &= 0x0F;
+    min = 0x800;
+  } else if (c >= 0xF0 && c <= 0xF4) {
+    len = 4;
+    c &= 0x07;
+    min = 0x10000;
+  } else {
+    goto invalid;
+  }
+  if (n < len) {
+    goto invalid;
+  }
+  for (size_t k = 1; k < len; ++k) {
+    if ((u[k] & 0xC0) != 0x80) {
+      goto invalid;
+    }
+    c = (c << 6) | (u[k] & 0x3F);
+  }
+  if (c < min || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+    goto invalid;
+  }
+  *cp = c;
+  return len;
+invalid:
+  *cp = UTF8_INVALID;
+  return 1;
+}
+
+size_t utf8_encode(uint32_t cp, char *s) {
+  unsigned char *u = (unsigned char *) s;
+  if (cp < 0x80) {
+    u[0] = (unsigned char) cp;
+    return 1;
+  }
+  if (cp < 0x800) {
+    u[0] = (unsigned char) (0xC0 | (cp >> 6));
+    u[1] = (unsigned char) (0x80 | (cp & 0x3F));
+    return 2;
+  }
+  if (cp < 0x10000) {
+    u[0] = (unsigned char) (0xE0 | (cp >> 12));
+    u[1] = (unsigned char) (0x80 | ((cp >> 6) & 0x3F));
+    u[2] = (unsigned char) (0x80 | (cp & 0x3F));
+    return 3;
+  }
+  u[0] = (unsigned char) (0xF0 | (cp >> 18));
+  u[1] = (unsigned char) (0x80 | ((cp >> 12) & 0x3F));
+  u[2] = (unsigned char) (0x80 | ((cp >> 6) & 0x3F));
+  u[3] = (unsigned char) (0x80 | (cp & 0x3F));
+  return 4;
+}
+
+uint32_t utf8_toupper(uint32_t cp) {
+  size_t lo = 0;
+  size_t hi = UTF8__LENGTH(upper);
+  while (lo < hi) {
+    size_t m = lo + (hi - lo) / 2;
+    if (cp < upper[m].lo) {
+      hi = m;
+    } else if (cp > upper[m].hi) {
+      lo = m + 1;
+    } else {
+      return (cp - upper[m].lo) % upper[m].step == 0
+        ? (uint32_t) ((int32_t) cp + upper[m].delta) : cp;
+    }
+  }
+  return cp;
+}
+
+//  utf8__isupper : renvoie true si et seulement si le caractère de code cp est
+//    la majuscule associée à un autre caractère.
+static bool utf8__isupper(uint32_t cp) {
+  for (size_t k = 0; k < UTF8__LENGTH(upper); ++k) {
+    const struct casemap *c = &upper[k];
+    uint32_t l = (uint32_t) ((int32_t) cp - c->delta);
+    if (l >= c->lo && l <= c->hi && (l - c->lo) % c->step == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool utf8_is(uint32_t cp, utf8class cls) {
+  if (cp < 0x80) {
+    return (ascii[cp] >> cls) & 1;
+  }
+  if (cp > 0x10FFFF) {
+    return false;
+  }
+  if (cls == UTF8_ANY) {
+    return true;
+  }
+  bool cntrl = (cp <= 0x9F || utf8__in(lines, UTF8__LENGTH(lines), cp));
+  bool print = (!cntrl && (cp & 0xFFFE) != 0xFFFE
+      && !(cp >= 0xFDD0 && cp <= 0xFDEF));
+  bool space = (utf8__in(blanks, UTF8__LENGTH(blanks), cp)
+      || utf8__in(lines, UTF8__LENGTH(lines), cp));
+  bool digit = false;
+  for (size_t k = 0; !digit && k < UTF8__LENGTH(digits); ++k) {
+    digit = (cp >= digits[k] && cp - digits[k] <= 9);
+  }
+  switch (cls) {
+    case UTF8_ALNUM:
+      return digit || utf8_is(cp, UTF8_ALPHA);
+    case UTF8_ALPHA:
+      return utf8__in(letters, UTF8__LENGTH(letters), cp)
+        || utf8_is(cp, UTF8_LOWER) || utf8__isupper(cp);
+    case UTF8_BLANK:
+      return utf8__in(blanks, UTF8__LENGTH(blanks), cp);
+    case UTF8_CNTRL:
+      return cntrl;
+    case UTF8_DIGIT:
+      return digit;
+    case UTF8_GRAPH:
+      return print && !space;
+    case UTF8_LOWER:
+      return utf8_toupper(cp) != cp
+        || utf8__in(lowers, UTF8__LENGTH(lowers), cp);
+    case UTF8_PRINT:
+      return print;
+    case UTF8_PUNCT:
+      return print && !space && !utf8_is(cp, UTF8_ALNUM);
+    case UTF8_SPACE:
+      return space;
+    case UTF8_UPPER:
+      return utf8__isupper(cp);
+    default:
+      return false;
+  }
+}
+
+//  utf8__upper_ascii : écrit à partir de l'adresse d les majuscules des n
+//    caractères ASCII de la chaîne s, privés des caractères nuls, d ne
+//    dépassant pas s. Renvoie le nombre de caractères écrits.
+static size_t utf8__upper_ascii(char *d, const char *s, size_t n) {
+  size_t i = 0;
+  size_t j = 0;
+#if defined __SSE2__
+  const __m128i a = _mm_set1_epi8('a' - 1);
+  const __m128i z = _mm_set1_epi8('z' + 1);
+  const __m128i gap = _mm_set1_epi8('a' - 'A');
+  const __m128i zero = _mm_setzero_si128();
+  for (; n - i >= UTF8__BLOCK; i += UTF8__BLOCK, j += UTF8__BLOCK) {
+    __m128i v = _mm_loadu_si128((const __m128i *) (s + i));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) != 0) {
+      break;
+    }
+    __m128i m = _mm_and_si128(_mm_cmpgt_epi8(v, a), _mm_cmplt_epi8(v, z));
+    _mm_storeu_si128((__m128i *) (d + j),
+        _mm_sub_epi8(v, _mm_and_si128(m, gap)));
+  }
+#else
+  for (; n - i >= sizeof(uint64_t);
+      i += sizeof(uint64_t), j += sizeof(uint64_t)) {
+    uint64_t w;
+    memcpy(&w, s + i, sizeof w);
+    if (((w - UTF8__ONES) & ~w & UTF8__HIGHS) != 0) {
+      break;
+    }
+    uint64_t ge = (w + UTF8__ONES * (0x80 - 'a')) & UTF8__HIGHS;
+    uint64_t gt = (w + UTF8__ONES * (0x80 - 'z' - 1)) & UTF8__HIGHS;
+    w -= (ge & ~gt) >> 2;
+    memcpy(d + j, &w, sizeof w);
+  }
+#endif
+  for (; i < n; ++i) {
+    char c = s[i];
+    if (c != '\0') {
+      d[j] = (c >= 'a' && c <= 'z' ? (char) (c - ('a' - 'A')) : c);
+      ++j;
+    }
+  }
+  return j;
+}
+
+size_t utf8_map(char *s, size_t n, utf8class cls, bool upper) {
+  size_t i = 0;
+  size_t j = 0;
+  while (i < n) {
+    size_t k = utf8_ascii(s + i, n - i);
+    if (cls == UTF8_ANY && upper) {
+      j += utf8__upper_ascii(s + j, s + i, k);
+    } else if (cls == UTF8_ANY) {
+      memmove(s + j, s + i, k);
+      j += k;
+    } else {
+      for (size_t m = i; m < i + k; ++m) {
+        unsigned char c = (unsigned char) s[m];
+        if (((ascii[c] >> cls) & 1) && !(upper && c == '\0')) {
+          s[j] = (upper && c >= 'a' && c <= 'z'
+              ? (char) (c - ('a' - 'A')) : (char) c);
+          ++j;
+        }
+      }
+    }
+    i += k;
+    if (i == n) {
+      break;
+    }
+    uint32_t cp;
+    size_t len = utf8_decode(s + i, n - i, &cp);
+    if (cp == UTF8_INVALID ? cls == UTF8_ANY : utf8_is(cp, cls)) {
+      if (upper && cp != UTF8_INVALID) {
+        j += utf8_encode(utf8_toupper(cp), s + j);
+      } else {
+        memmove(s + j, s + i, len);
+        j += len;
+      }
+    }
+    i += len;
+  }
+  return j;
+}
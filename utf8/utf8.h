@@ -0,0 +1,94 @@
+//  utf8.h : partie interface d'un module de traitement des chaînes codées en
+//    UTF-8 : repérage des suites de caractères ASCII, décodage et codage des
+//    caractères, passage en majuscules et classes de caractères.
+
+#ifndef UTF8__H
+#define UTF8__H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+//  Fonctionnement général :
+//  - les caractères ASCII, de code inférieur à 0x80, sont codés sur un seul
+//      octet, qui n'apparaît dans le codage d'aucun autre caractère. Les
+//      suites de tels octets, qui forment l'essentiel de la plupart des
+//      textes, sont repérées par blocs de 16 octets à l'aide des instructions
+//      SSE2 lorsque la cible les offre, par mots de 8 octets sinon, puis
+//      traitées sans décodage ;
+//  - les autres caractères sont décodés un à un. Un octet qui n'entame pas le
+//      codage le plus court d'un code de 0x80 à 0x10FFFF hors de la zone
+//      d'indirection, de 0xD800 à 0xDFFF, forme à lui seul un caractère
+//      invalide ;
+//  - les correspondances de casse et les classes ne dépendent pas de la
+//      locale. Hors ASCII, les correspondances de casse couvrent, dans le sens
+//      de la minuscule vers la majuscule, les alphabets latin, phonétique,
+//      grec, cyrillique et arménien, les chiffres romains, les lettres
+//      cerclées et les formes pleine chasse, à l'exception des minuscules dont
+//      la majuscule compte plusieurs caractères ou a un codage plus long :
+//      le codage de la majuscule n'est jamais plus long que celui de la
+//      minuscule. Les classes des autres caractères sont déduites de tables
+//      des principaux blocs de lettres, de chiffres décimaux et d'espaces.
+
+//  UTF8_INVALID : valeur affectée par utf8_decode au code d'un caractère
+//    invalide.
+#define UTF8_INVALID ((uint32_t) -1)
+
+//  utf8class : énumération des classes de caractères, homologues de celles
+//    des fonctions de l'en-tête standard <ctype.h> de même nom. UTF8_ANY
+//    comprend tous les caractères valides. Les caractères invalides
+//    n'appartiennent à aucune classe.
+typedef enum {
+  UTF8_ANY,
+  UTF8_ALNUM,
+  UTF8_ALPHA,
+  UTF8_BLANK,
+  UTF8_CNTRL,
+  UTF8_DIGIT,
+  UTF8_GRAPH,
+  UTF8_LOWER,
+  UTF8_PRINT,
+  UTF8_PUNCT,
+  UTF8_SPACE,
+  UTF8_UPPER,
+  UTF8_XDIGIT,
+} utf8class;
+
+//  utf8_classname : renvoie le nom de la fonction de l'en-tête <ctype.h>
+//    homologue de la classe cls, comme « isalpha », NULL si cls vaut UTF8_ANY.
+extern const char *utf8_classname(utf8class cls);
+
+//  utf8_classbyname : affecte à *cls la classe de nom name au sens de
+//    utf8_classname. Renvoie true en cas de succès, false si name n'est le nom
+//    d'aucune classe.
+extern bool utf8_classbyname(const char *name, utf8class *cls);
+
+//  utf8_ascii : renvoie la longueur du plus long préfixe de la chaîne s de
+//    longueur n formé d'octets inférieurs à 0x80.
+extern size_t utf8_ascii(const char *s, size_t n);
+
+//  utf8_decode : décode le premier caractère de la chaîne s de longueur n,
+//    non nulle. Affecte son code à *cp, UTF8_INVALID s'il est invalide, et
+//    renvoie la longueur de son codage, 1 s'il est invalide.
+extern size_t utf8_decode(const char *s, size_t n, uint32_t *cp);
+
+//  utf8_encode : code le caractère de code cp, au plus 0x10FFFF, à partir de
+//    l'adresse s et renvoie la longueur de son codage, de 1 à 4.
+extern size_t utf8_encode(uint32_t cp, char *s);
+
+//  utf8_toupper : renvoie le code de la majuscule associée au caractère de
+//    code cp s'il en a une, cp sinon.
+extern uint32_t utf8_toupper(uint32_t cp);
+
+//  utf8_is : renvoie true si et seulement si le caractère de code cp
+//    appartient à la classe cls.
+extern bool utf8_is(uint32_t cp, utf8class cls);
+
+//  utf8_map : retire de la chaîne s de longueur n les caractères qui
+//    n'appartiennent pas à la classe cls, puis, si upper vaut true, remplace
+//    les autres par leurs majuscules et retire les caractères nuls. Avec la
+//    classe UTF8_ANY, les caractères invalides sont conservés tels quels. Le
+//    résultat est écrit en place ; renvoie sa longueur, au plus n.
+extern size_t utf8_map(char *s, size_t n, utf8class cls, bool upper);
+
+#endif
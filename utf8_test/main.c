@@ -0,0 +1,182 @@
+//  Vérifications du module utf8 : utf8_map, appliquée à des chaînes aléatoires
+//    mêlant suites ASCII, caractères valides et octets invalides, est comparée
+//    à un traitement caractère par caractère.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "utf8.h"
+
+//  CHECK : signale sur la sortie erreur l'échec de la condition cond et
+//    abandonne la fonction en cours en renvoyant -1.
+#define CHECK(cond)                                                            \
+  if (!(cond)) {                                                               \
+    fprintf(stderr, "*** Check failed: %s:%d: %s\n", __func__, __LINE__,      \
+        #cond);                                                                \
+    return -1;                                                                 \
+  }
+
+//  NSTRINGS : nombre de chaînes aléatoires. LEN_MAX : longueur maximale d'une
+//    chaîne. SHIFT_MAX : décalage maximal d'une chaîne dans son tampon, qui
+//    déplace les frontières des blocs de 8 et de 16 octets.
+#define NSTRINGS 3000
+#define LEN_MAX 256
+#define SHIFT_MAX 16
+
+//  rnd : renvoie le terme suivant d'une suite pseudo-aléatoire, xorshift64,
+//    reproductible d'une exécution à l'autre.
+static uint64_t rnd(void) {
+  static uint64_t x = 0x9E3779B97F4A7C15ULL;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  return x;
+}
+
+//  codes : caractères valides hors ASCII, dont des minuscules et majuscules de
+//    chacun des alphabets couverts, des chiffres, des espaces et les bornes
+//    des codages de 2, 3 et 4 octets.
+static const uint32_t codes[] = {
+  0x80, 0xA0, 0xB5, 0xDF, 0xE9, 0xC9, 0xFF, 0x101, 0x131, 0x17F, 0x1C5,
+  0x250, 0x3B1, 0x391, 0x3C2, 0x430, 0x410, 0x450, 0x561, 0x587, 0x7FF,
+  0x800, 0x660, 0x966, 0x1680, 0x2003, 0x2028, 0x2170, 0x2160, 0x24D0,
+  0x24B6, 0x3000, 0xD7FF, 0xE000, 0xFF41, 0xFF21, 0xFF10, 0xFFFD, 0xFFFF,
+  0x10000, 0x10428, 0x1D7CE, 0x10FFFF,
+};
+
+//  invalids : suites d'octets dont aucun n'entame un caractère valide :
+//    octets de suite, codages trop longs, zone d'indirection, codes au-delà de
+//    0x10FFFF, octets exclus et codages tronqués.
+static const char *invalids[] = {
+  "\x80", "\xBF", "\xC0\x80", "\xC1\xBF", "\xE0\x80\x80", "\xE0\x9F\xBF",
+  "\xF0\x80\x80\x80", "\xF0\x8F\xBF\xBF", "\xED\xA0\x80", "\xED\xBF\xBF",
+  "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xFE", "\xFF", "\xC3", "\xE2\x82",
+  "\xF0\x9F\x98",
+};
+
+//  gen : écrit dans s une chaîne aléatoire de longueur au plus LEN_MAX et
+//    renvoie sa longueur. Elle se compose de suites ASCII, qui comprennent des
+//    lettres des deux casses et parfois des caractères nuls, de caractères
+//    valides et de suites invalides.
+static size_t gen(char *s) {
+  size_t n = 0;
+  for (;;) {
+    char t[LEN_MAX];
+    size_t k = 0;
+    switch (rnd() % 4) {
+      case 0:
+      case 1:
+        k = rnd() % 40;
+        for (size_t i = 0; i < k; ++i) {
+          uint64_t r = rnd();
+          t[i] = (r % 8 == 0 ? (char) (r % 0x80) : "aZ0 z.\t\n\0"[r % 9]);
+        }
+        break;
+      case 2: {
+        uint32_t cp = (uint32_t) (0x80 + rnd() % (0x110000 - 0x80 - 0x800));
+        k = utf8_encode(rnd() % 2 == 0
+            ? codes[rnd() % (sizeof codes / sizeof *codes)]
+            : cp < 0xD800 ? cp : cp + 0x800, t);
+        break;
+      }
+      default: {
+        const char *v = invalids[rnd() % (sizeof invalids / sizeof *invalids)];
+        k = strlen(v);
+        memcpy(t, v, k);
+        break;
+      }
+    }
+    if (n + k > LEN_MAX) {
+      return n;
+    }
+    memcpy(s + n, t, k);
+    n += k;
+  }
+}
+
+//  map : écrit dans d le résultat de utf8_map sur la chaîne s de longueur n,
+//    de classe cls et de passage en majuscules upper, obtenu en décodant ses
+//    caractères un à un. Renvoie sa longueur.
+static size_t map(char *d, const char *s, size_t n, utf8class cls,
+    bool upper) {
+  size_t j = 0;
+  for (size_t i = 0; i < n;) {
+    uint32_t cp;
+    size_t len = utf8_decode(s + i, n - i, &cp);
+    bool keep = (cp == UTF8_INVALID ? cls == UTF8_ANY : utf8_is(cp, cls))
+        && !(upper && cp == 0);
+    if (keep && upper && cp != UTF8_INVALID) {
+      j += utf8_encode(utf8_toupper(cp), d + j);
+    } else if (keep) {
+      memcpy(d + j, s + i, len);
+      j += len;
+    }
+    i += len;
+  }
+  return j;
+}
+
+//  check_map : vérifie que utf8_map donne le résultat de map sur la chaîne s de
+//    longueur n, pour toutes les classes, avec ou sans passage en majuscules,
+//    et pour tous les décalages de la chaîne dans son tampon jusqu'à
+//    SHIFT_MAX.
+static int check_map(const char *s, size_t n) {
+  char buf[LEN_MAX + SHIFT_MAX];
+  char expected[LEN_MAX];
+  for (int c = UTF8_ANY; c <= UTF8_XDIGIT; ++c) {
+    for (int u = 0; u <= 1; ++u) {
+      size_t m = map(expected, s, n, (utf8class) c, u != 0);
+      for (size_t shift = 0; shift < SHIFT_MAX; ++shift) {
+        memcpy(buf + shift, s, n);
+        CHECK(utf8_map(buf + shift, n, (utf8class) c, u != 0) == m);
+        CHECK(memcmp(buf + shift, expected, m) == 0);
+      }
+    }
+  }
+  return 0;
+}
+
+//  check_boundaries : vérifie utf8_map sur des chaînes formées d'une suite
+//    ASCII de toute longueur jusqu'à 40, d'un caractère valide ou d'une suite
+//    invalide puis d'une seconde suite ASCII, de sorte que le premier octet
+//    non ASCII tombe sur chaque position des blocs de 8 et de 16 octets.
+static int check_boundaries(void) {
+  static const char *middles[] = {
+    "\xC3\xA9", "\xE2\x85\xB0", "\xF0\x90\x90\xA8", "\xFF", "\xED\xA0\x80",
+    "\xE2\x82",
+  };
+  for (size_t k = 0; k <= 40; ++k) {
+    for (size_t i = 0; i < sizeof middles / sizeof *middles; ++i) {
+      char s[LEN_MAX];
+      size_t n = 0;
+      for (size_t j = 0; j < k; ++j) {
+        s[n++] = "abcXYZ019 "[j % 10];
+      }
+      size_t len = strlen(middles[i]);
+      memcpy(s + n, middles[i], len);
+      n += len;
+      for (size_t j = 0; j < k; ++j) {
+        s[n++] = (j == k / 2 ? '\0' : "zyx."[j % 4]);
+      }
+      CHECK(check_map(s, n) == 0);
+    }
+  }
+  return 0;
+}
+
+//  check_random : vérifie utf8_map sur NSTRINGS chaînes aléatoires.
+static int check_random(void) {
+  for (size_t k = 0; k < NSTRINGS; ++k) {
+    char s[LEN_MAX];
+    size_t n = gen(s);
+    CHECK(check_map(s, n) == 0);
+  }
+  return 0;
+}
+
+int main(void) {
+  if (check_boundaries() != 0 || check_random() != 0) {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}